@@ -0,0 +1,174 @@
+#include "instrumentation.h"
+#include "model_session.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Benchmarks the same model and images on every available inference backend
+// and thread count, reporting latency p50/p99 and throughput.
+
+struct BenchmarkResult {
+    std::string backend;
+    int threads;
+    size_t samples;
+    double p50_ms;
+    double p99_ms;
+    double mean_ms;
+    double images_per_sec;
+};
+
+std::vector<cv::Mat> loadImages(const std::string& dir, size_t max_images) {
+    std::vector<std::string> paths;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string ext = entry.path().extension().string();
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png") {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<cv::Mat> images;
+    for (const auto& path : paths) {
+        if (images.size() >= max_images) break;
+        cv::Mat img = cv::imread(path);
+        if (!img.empty()) {
+            images.push_back(img);
+        }
+    }
+    return images;
+}
+
+std::vector<int> parseThreadList(const std::string& text) {
+    std::vector<int> threads;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        threads.push_back(std::stoi(item));
+    }
+    return threads;
+}
+
+BenchmarkResult runBenchmark(ModelSession& session, const std::vector<cv::Mat>& images,
+                             int runs, int threads) {
+    std::vector<double> latencies;
+    latencies.reserve(images.size() * runs);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < runs; ++r) {
+        for (const auto& img : images) {
+            auto t0 = std::chrono::steady_clock::now();
+            session.run(img);
+            auto t1 = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+    }
+    double total_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (double l : latencies) sum += l;
+
+    BenchmarkResult result;
+    result.backend = session.getBackendName();
+    result.threads = threads;
+    result.samples = latencies.size();
+    result.p50_ms = percentile(latencies, 0.50);
+    result.p99_ms = percentile(latencies, 0.99);
+    result.mean_ms = latencies.empty() ? 0.0 : sum / latencies.size();
+    result.images_per_sec = total_sec > 0 ? latencies.size() / total_sec : 0.0;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <model.cfg|-> <model.weights|model.onnx> <image_dir>"
+                  << " [--onnx model.onnx] [--threads 1,2,4] [--runs N] [--max-images N] [--size 416]\n";
+        std::cerr << "Example: " << argv[0] << " yolov3.cfg yolov3.weights darknet_dataset_Capture/images/train --onnx yolov3.onnx\n";
+        return -1;
+    }
+
+    try {
+        std::string config_path = std::string(argv[1]) == "-" ? "" : argv[1];
+        std::string weights_path = argv[2];
+        std::string image_dir = argv[3];
+        std::string onnx_path;
+        std::vector<int> thread_counts = {0};
+        int runs = 3;
+        size_t max_images = 50;
+        int input_size = 416;
+
+        for (int i = 4; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            if (arg == "--onnx") onnx_path = argv[i + 1];
+            else if (arg == "--threads") thread_counts = parseThreadList(argv[i + 1]);
+            else if (arg == "--runs") runs = std::stoi(argv[i + 1]);
+            else if (arg == "--max-images") max_images = std::stoul(argv[i + 1]);
+            else if (arg == "--size") input_size = std::stoi(argv[i + 1]);
+        }
+
+        std::vector<cv::Mat> images = loadImages(image_dir, max_images);
+        if (images.empty()) {
+            throw std::runtime_error("No images found in " + image_dir);
+        }
+        std::cout << "Loaded " << images.size() << " images, " << runs << " runs each\n";
+
+        std::vector<BenchmarkResult> results;
+        for (BackendKind kind : availableBackends()) {
+            // ONNX Runtime can only run the ONNX export of the model
+            bool onnx_only = kind == BackendKind::OnnxRuntimeCpu;
+            if (onnx_only && onnx_path.empty()) {
+                std::cout << "Skipping " << backendName(kind) << ": no --onnx model given\n";
+                continue;
+            }
+
+            for (int threads : thread_counts) {
+                BackendConfig config;
+                config.kind = kind;
+                config.numThreads = threads;
+                cv::setNumThreads(threads > 0 ? threads : -1);   // -1 restores the default
+
+                try {
+                    ModelSession session(onnx_only ? "" : config_path,
+                                         onnx_only ? onnx_path : weights_path,
+                                         cv::Size(input_size, input_size), config);
+                    results.push_back(runBenchmark(session, images, runs, threads));
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Backend " << backendName(kind) << " failed: " << e.what() << std::endl;
+                }
+            }
+        }
+
+        // Report
+        std::cout << "\n" << std::left << std::setw(14) << "backend" << std::right
+                  << std::setw(9) << "threads" << std::setw(10) << "samples"
+                  << std::setw(11) << "p50 ms" << std::setw(11) << "p99 ms"
+                  << std::setw(11) << "mean ms" << std::setw(12) << "img/s" << "\n";
+        std::ofstream csv("backend_benchmark.csv");
+        csv << "backend,threads,samples,p50_ms,p99_ms,mean_ms,images_per_sec\n";
+        for (const auto& r : results) {
+            std::cout << std::left << std::setw(14) << r.backend << std::right
+                      << std::setw(9) << (r.threads > 0 ? std::to_string(r.threads) : "auto")
+                      << std::setw(10) << r.samples << std::fixed << std::setprecision(2)
+                      << std::setw(11) << r.p50_ms << std::setw(11) << r.p99_ms
+                      << std::setw(11) << r.mean_ms << std::setw(12) << r.images_per_sec << "\n";
+            csv << r.backend << "," << r.threads << "," << r.samples << "," << r.p50_ms << ","
+                << r.p99_ms << "," << r.mean_ms << "," << r.images_per_sec << "\n";
+        }
+        std::cout << "\nResults written to backend_benchmark.csv" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
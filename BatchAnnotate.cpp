@@ -0,0 +1,468 @@
+#include "model_session.h"
+#include "yolo_detection.h"
+#include "yolo_labels.h"
+#include "bounded_queue.h"
+#include "detection_cache.h"
+#include "model_cache.h"
+#include "image_header.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Headless batch annotator: loads the model once and writes YOLO labels for
+// every image of a directory (recursive) or list file. Decoding, batched
+// inference and label writing run as a pipeline on separate threads.
+// Finished images are appended to a progress manifest, so an interrupted
+// run continues where it stopped. With --cache, detections are also kept
+// in a content-addressed cache, so a rerun (new images, other labels dir,
+// other NMS threshold) only infers images that are new or changed.
+
+struct DecodedImage {
+    std::string path;
+    cv::Mat image;
+    uint64_t contentHash = 0;
+};
+
+struct LabelJob {
+    std::string imagePath;
+    uint64_t contentHash = 0;
+    std::string labelPath;
+    std::vector<Detection> detections;
+    cv::Size imageSize;
+};
+
+// Pipeline stage threads. Closing both queues and joining on destruction
+// means an exception in the inference loop cannot leave joinable threads.
+struct PipelineThreads {
+    BoundedQueue<DecodedImage>& decoded;
+    BoundedQueue<LabelJob>& labeled;
+    std::vector<std::thread> decoders;
+    std::vector<std::thread> writers;
+
+    PipelineThreads(BoundedQueue<DecodedImage>& decoded, BoundedQueue<LabelJob>& labeled)
+        : decoded(decoded), labeled(labeled) {}
+
+    void join() {
+        decoded.close();
+        for (auto& t : decoders) {
+            if (t.joinable()) t.join();
+        }
+        labeled.close();
+        for (auto& t : writers) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    ~PipelineThreads() {
+        join();
+    }
+};
+
+// Append-only list of images whose labels are already written, one
+// "path" or "path<TAB>content hash" line per image. A changed image gets a
+// new line that supersedes the old one; superseded lines are dropped when
+// the manifest is opened.
+class ProgressManifest {
+private:
+    std::unordered_map<std::string, uint64_t> done;     // Content hash, 0 = not recorded
+    std::ofstream out;
+    std::mutex mutex;
+    size_t unflushed = 0;
+
+    static void writeLine(std::ostream& out, const std::string& imagePath, uint64_t contentHash) {
+        out << imagePath;
+        if (contentHash != 0) {
+            out << "\t" << std::hex << contentHash << std::dec;
+        }
+        out << "\n";
+    }
+
+public:
+    explicit ProgressManifest(const std::string& path) {
+        size_t lines = 0;
+        {
+            std::ifstream in(path);
+            std::string line;
+            while (std::getline(in, line)) {
+                if (line.empty()) continue;
+                lines++;
+                uint64_t hash = 0;
+                size_t tab = line.rfind('\t');
+                if (tab != std::string::npos) {
+                    hash = std::stoull(line.substr(tab + 1), nullptr, 16);
+                    line.resize(tab);
+                }
+                done[line] = hash;
+            }
+        }
+        if (lines > done.size()) {
+            std::string tmpPath = path + ".tmp";
+            {
+                std::ofstream compacted(tmpPath);
+                for (const auto& [imagePath, hash] : done) writeLine(compacted, imagePath, hash);
+                if (!compacted) {
+                    throw std::runtime_error("Cannot write progress manifest: " + tmpPath);
+                }
+            }
+            fs::rename(tmpPath, path);
+        }
+        out.open(path, std::ios::app);
+        if (!out.good()) {
+            throw std::runtime_error("Cannot open progress manifest: " + path);
+        }
+    }
+
+    bool contains(const std::string& imagePath) const {
+        return done.count(imagePath) > 0;
+    }
+
+    // Listed with this content; entries without a recorded hash count as
+    // unchanged, so labels from such runs are never overwritten
+    bool unchanged(const std::string& imagePath, uint64_t contentHash) const {
+        auto it = done.find(imagePath);
+        return it != done.end() && (it->second == 0 || it->second == contentHash);
+    }
+
+    size_t size() const { return done.size(); }
+
+    // Only appends; the loaded entries are not modified, so lookups need
+    // no lock
+    void markDone(const std::string& imagePath, uint64_t contentHash) {
+        std::lock_guard<std::mutex> lock(mutex);
+        writeLine(out, imagePath, contentHash);
+        if (++unflushed >= 64) {
+            out.flush();
+            unflushed = 0;
+        }
+    }
+
+    ~ProgressManifest() {
+        out.flush();
+    }
+};
+
+// Directory (recursive) or list file with one image path per line
+std::vector<std::string> collectImages(const std::string& input) {
+    std::vector<std::string> images;
+    if (fs::is_directory(input)) {
+        for (const auto& entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file() && isImageFile(entry.path())) {
+                images.push_back(fs::absolute(entry.path()).string());
+            }
+        }
+        std::sort(images.begin(), images.end());
+    } else {
+        std::ifstream list(input);
+        if (!list.good()) {
+            throw std::runtime_error("Cannot open input: " + input);
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty()) images.push_back(line);
+        }
+    }
+    return images;
+}
+
+// Deepest directory containing every image
+fs::path commonDirectory(const std::vector<std::string>& images) {
+    fs::path common;
+    for (const auto& image : images) {
+        fs::path dir = fs::absolute(image).parent_path();
+        if (common.empty()) {
+            common = dir;
+            continue;
+        }
+        fs::path shared;
+        auto a = common.begin();
+        auto b = dir.begin();
+        for (; a != common.end() && b != dir.end() && *a == *b; ++a, ++b) {
+            shared /= *a;
+        }
+        common = shared;
+    }
+    return common;
+}
+
+struct BatchOptions {
+    std::string labelsDir;       // Empty = Darknet images/ -> labels/ layout
+    std::string imageRoot;       // Label paths under labelsDir mirror the images below it
+    int batchSize = 8;
+    int decoders = 4;
+    int writers = 2;
+    float confThreshold = 0.5f;
+    float nmsThreshold = 0.4f;
+    int inputSize = 416;
+    BackendConfig backend;
+    std::string cacheDir;        // Detection cache, empty = off
+};
+
+class BatchAnnotator {
+private:
+    ModelSession session;
+    std::vector<std::string> classNames;
+    BatchOptions options;
+    std::unique_ptr<DetectionCache> cache;
+
+    std::string labelPathFor(const std::string& imagePath) const {
+        if (options.labelsDir.empty()) {
+            return labelPathForImage(imagePath);
+        }
+        // Keep the relative path, so same-named images in different
+        // directories do not share a label file
+        fs::path relative = fs::absolute(imagePath).lexically_relative(options.imageRoot);
+        if (relative.empty() || *relative.begin() == "..") {
+            relative = fs::path(imagePath).filename();
+        }
+        return (fs::path(options.labelsDir) / relative.replace_extension(".txt")).string();
+    }
+
+public:
+    BatchAnnotator(const std::string& configPath, const std::string& weightsPath,
+                   const std::string& classFile, const BatchOptions& options)
+        : session(configPath, weightsPath, cv::Size(options.inputSize, options.inputSize),
+                  options.backend),
+          classNames(loadClassNames(classFile)),
+          options(options) {
+        if (!options.labelsDir.empty()) {
+            fs::create_directories(options.labelsDir);
+        }
+        if (!options.cacheDir.empty()) {
+            // Candidates are stored above confThreshold, so it is part of the key
+            std::ostringstream preprocessing;
+            preprocessing << "size=" << options.inputSize
+                          << " precision=" << precisionName(options.backend.precision)
+                          << " conf=" << options.confThreshold;
+            uint64_t modelKey = ModelCache(options.cacheDir).modelKey(configPath, weightsPath);
+            cache = std::make_unique<DetectionCache>(options.cacheDir, modelKey, preprocessing.str());
+        }
+    }
+
+    LabelJob makeJob(const std::string& imagePath, uint64_t contentHash, const cv::Size& imageSize,
+                     const std::vector<Detection>& candidates) const {
+        LabelJob job;
+        job.imagePath = imagePath;
+        job.contentHash = contentHash;
+        job.labelPath = labelPathFor(imagePath);
+        job.imageSize = imageSize;
+        job.detections = suppressDetections(candidates, options.confThreshold, options.nmsThreshold);
+        return job;
+    }
+
+    void run(const std::vector<std::string>& images, ProgressManifest& manifest) {
+        BoundedQueue<DecodedImage> decoded(options.batchSize * 4);
+        BoundedQueue<LabelJob> labeled(options.batchSize * 4);
+        std::atomic<size_t> nextImage{0};
+        std::atomic<int> activeDecoders{options.decoders};
+        std::atomic<size_t> written{0};
+        std::atomic<size_t> failed{0};
+        std::atomic<size_t> cached{0};
+        std::atomic<size_t> unchanged{0};
+
+        PipelineThreads threads(decoded, labeled);
+
+        // Stage 1: decode. With the cache, images whose content matches the
+        // manifest are skipped (their labels may have been corrected by
+        // hand), and cache hits skip decoding and inference and go
+        // straight to the writers. A closed queue means the pipeline is
+        // shutting down.
+        for (int d = 0; d < options.decoders; ++d) {
+            threads.decoders.emplace_back([&] {
+                cv::Size cachedSize;
+                std::vector<Detection> candidates;
+                for (size_t i = nextImage++; i < images.size(); i = nextImage++) {
+                    uint64_t contentHash = 0;
+                    if (cache) {
+                        try {
+                            contentHash = cache->contentHash(images[i]);
+                        } catch (const std::exception&) {
+                            std::cerr << "Could not read the image: " << images[i] << std::endl;
+                            failed++;
+                            continue;
+                        }
+                        if (manifest.unchanged(images[i], contentHash)) {
+                            unchanged++;
+                            continue;
+                        }
+                        if (cache->get(contentHash, cachedSize, candidates, classNames)) {
+                            if (!labeled.push(makeJob(images[i], contentHash, cachedSize, candidates))) break;
+                            cached++;
+                            continue;
+                        }
+                    }
+
+                    cv::Mat img = cv::imread(images[i]);
+                    if (img.empty()) {
+                        std::cerr << "Could not read the image: " << images[i] << std::endl;
+                        failed++;
+                        continue;
+                    }
+                    if (!decoded.push({images[i], img, contentHash})) break;
+                }
+                if (--activeDecoders == 0) {
+                    decoded.close();
+                }
+            });
+        }
+
+        // Stage 3: write labels and record progress; a failed write leaves
+        // the image out of the manifest so the next run retries it
+        for (int w = 0; w < options.writers; ++w) {
+            threads.writers.emplace_back([&] {
+                LabelJob job;
+                while (labeled.pop(job)) {
+                    try {
+                        fs::create_directories(fs::path(job.labelPath).parent_path());
+                        writeYoloLabels(job.labelPath, job.detections, job.imageSize);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Could not write labels for " << job.imagePath << ": "
+                                  << e.what() << std::endl;
+                        failed++;
+                        continue;
+                    }
+                    manifest.markDone(job.imagePath, job.contentHash);
+                    written++;
+                }
+            });
+        }
+
+        // Stage 2: batched inference on this thread
+        auto start = std::chrono::steady_clock::now();
+        auto lastReport = start;
+        std::vector<DecodedImage> batch;
+        std::vector<cv::Mat> frames;
+        size_t processed = 0;
+        bool more = true;
+        while (more) {
+            batch.clear();
+            DecodedImage item;
+            while ((int)batch.size() < options.batchSize && (more = decoded.pop(item))) {
+                batch.push_back(std::move(item));
+            }
+            if (batch.empty()) break;
+
+            frames.clear();
+            for (const auto& b : batch) frames.push_back(b.image);
+            session.preprocessBatch(frames);
+            const std::vector<cv::Mat>& outs = session.forward();
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                cv::Size imageSize = batch[i].image.size();
+                std::vector<Detection> candidates =
+                    decodeYoloOutputs(sliceBatchOutputs(outs, (int)i, (int)batch.size()),
+                                      imageSize, options.confThreshold, classNames);
+                if (cache) {
+                    cache->put(batch[i].contentHash, imageSize, candidates, options.confThreshold);
+                }
+                labeled.push(makeJob(batch[i].path, batch[i].contentHash, imageSize, candidates));
+            }
+            processed += batch.size();
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastReport > std::chrono::seconds(5)) {
+                double sec = std::chrono::duration<double>(now - start).count();
+                std::cout << "Processed " << processed + cached << "/" << images.size() << " images ("
+                          << processed / sec << " images/sec inferred, " << cached << " cached)" << std::endl;
+                lastReport = now;
+            }
+        }
+
+        threads.join();
+
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nAnnotated " << written << " images in " << sec << " s ("
+                  << (sec > 0 ? written / sec : 0.0) << " images/sec), "
+                  << failed << " failed";
+        if (cache) {
+            std::cout << ", " << unchanged << " unchanged, " << cached << " served from the detection cache, "
+                      << processed << " inferred";
+        }
+        std::cout << std::endl;
+    }
+};
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " <model.cfg> <model.weights> <class_names> <image_dir|list.txt>\n"
+                  << "       [--labels dir] [--manifest file] [--batch 8] [--decoders 4] [--writers 2]\n"
+                  << "       [--conf 0.5] [--nms 0.4] [--size 416] [--backend name|config.yml] [--threads N]\n"
+                  << "       [--model-cache dir] [--cache dir]\n";
+        std::cerr << "Example: " << argv[0] << " yolov3.cfg yolov3.weights coco.names darknet_dataset/images\n";
+        return -1;
+    }
+
+    try {
+        std::string input = argv[4];
+        std::string manifestPath = fs::is_directory(input) ?
+            (fs::path(input) / ".annotate_progress").string() : input + ".progress";
+        std::string backendArg = "opencv";
+        int numThreads = 0;
+        std::string modelCacheDir;
+        BatchOptions options;
+
+        for (int i = 5; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--labels") options.labelsDir = value;
+            else if (arg == "--manifest") manifestPath = value;
+            else if (arg == "--batch") options.batchSize = std::max(1, std::stoi(value));
+            else if (arg == "--decoders") options.decoders = std::max(1, std::stoi(value));
+            else if (arg == "--writers") options.writers = std::max(1, std::stoi(value));
+            else if (arg == "--conf") options.confThreshold = std::stof(value);
+            else if (arg == "--nms") options.nmsThreshold = std::stof(value);
+            else if (arg == "--size") options.inputSize = std::stoi(value);
+            else if (arg == "--backend") backendArg = value;
+            else if (arg == "--threads") numThreads = std::stoi(value);
+            else if (arg == "--model-cache") modelCacheDir = value;
+            else if (arg == "--cache") options.cacheDir = value;
+        }
+        options.backend = resolveBackendConfig(backendArg, numThreads);
+        if (!modelCacheDir.empty()) {
+            options.backend.modelCacheDir = modelCacheDir;
+        }
+
+        std::vector<std::string> all = collectImages(input);
+        options.imageRoot = fs::is_directory(input) ? fs::absolute(input).string()
+                                                    : commonDirectory(all).string();
+        ProgressManifest manifest(manifestPath);
+
+        // Resume: skip everything the manifest already lists. With the
+        // detection cache listed images are kept too, and skipped by the
+        // decoders unless their content hash changed since.
+        std::vector<std::string> todo;
+        for (const auto& path : all) {
+            if (!options.cacheDir.empty() || !manifest.contains(path)) todo.push_back(path);
+        }
+        std::cout << "Found " << all.size() << " images, " << manifest.size() << " in the manifest ("
+                  << manifestPath << ")";
+        if (!options.cacheDir.empty()) {
+            std::cout << ", checking them for changes";
+        }
+        std::cout << "\n";
+        if (todo.empty()) {
+            return 0;
+        }
+
+        std::cout << "Loading model (" << backendName(options.backend.kind) << ")...\n";
+        BatchAnnotator annotator(argv[1], argv[2], argv[3], options);
+        annotator.run(todo, manifest);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
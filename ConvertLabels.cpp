@@ -0,0 +1,295 @@
+#include "annotation_formats.h"
+#include "image_header.h"
+#include "yolo_detection.h"
+#include "yolo_labels.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Converts detection labels between YOLO (one .txt per image), COCO JSON and
+// Pascal VOC XML (one .xml per image). Files are processed in batches:
+// every batch is parsed in parallel, then written (COCO serially through
+// the streaming writer, per-image formats in parallel), so memory is bounded
+// by the batch size except for a COCO input, which is read in one pass.
+//
+// YOLO coordinates are normalized, so YOLO input needs the image sizes:
+// either one size for all images (--image-size) or the image file headers
+// (--images dir, looked up by file stem).
+
+enum class Format { Yolo, Coco, Voc };
+
+struct ConvertOptions {
+    Format from = Format::Yolo;
+    Format to = Format::Coco;
+    std::string input;
+    std::string output;
+    std::string namesFile;
+    std::string imagesDir;
+    cv::Size imageSize;         // Fixed size for YOLO input, empty = read the images
+    int batchSize = 4096;
+};
+
+struct ConvertStats {
+    size_t images = 0;
+    size_t boxes = 0;
+    double seconds = 0;
+};
+
+Format parseFormat(const std::string& name) {
+    if (name == "yolo") return Format::Yolo;
+    if (name == "coco") return Format::Coco;
+    if (name == "voc") return Format::Voc;
+    throw std::runtime_error("Unknown format '" + name + "' (yolo, coco or voc)");
+}
+
+cv::Size parseSize(const std::string& text) {
+    size_t x = text.find('x');
+    if (x == std::string::npos) {
+        throw std::runtime_error("Image size must be WxH: " + text);
+    }
+    return cv::Size(std::stoi(text.substr(0, x)), std::stoi(text.substr(x + 1)));
+}
+
+std::vector<std::string> listFiles(const std::string& dir, const std::string& extension) {
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == extension) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Image belonging to a YOLO label file and its size
+void resolveImage(const ConvertOptions& options, const std::string& labelPath, AnnotatedImage& image) {
+    std::string stem = fs::path(labelPath).stem().string();
+    if (options.imageSize.area() > 0) {
+        image.fileName = stem + ".jpg";
+        image.size = options.imageSize;
+        return;
+    }
+    for (const char* ext : {".jpg", ".png", ".jpeg"}) {
+        fs::path candidate = fs::path(options.imagesDir) / (stem + ext);
+        if (!fs::exists(candidate)) continue;
+        image.fileName = candidate.filename().string();
+        image.size = imageSize(candidate.string());
+        if (image.size.area() <= 0) break;
+        return;
+    }
+    throw std::runtime_error("No readable image for " + labelPath + " in " + options.imagesDir);
+}
+
+void writeClassNames(const std::string& path, const std::vector<std::string>& classNames) {
+    std::ofstream out(path);
+    for (const auto& name : classNames) out << name << "\n";
+}
+
+ConvertStats convert(const ConvertOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    ConvertStats stats;
+
+    std::vector<std::string> classNames;
+    if (!options.namesFile.empty()) {
+        classNames = loadClassNames(options.namesFile);
+    }
+
+    // Inputs: per-image files, or the whole COCO dataset
+    std::vector<std::string> inputFiles;
+    CocoDataset coco;
+    size_t total;
+    if (options.from == Format::Coco) {
+        coco = readCoco(options.input);
+        if (classNames.empty()) classNames = coco.classNames;
+        total = coco.images.size();
+    } else {
+        inputFiles = listFiles(options.input, options.from == Format::Yolo ? ".txt" : ".xml");
+        total = inputFiles.size();
+    }
+    if (classNames.empty() && (options.from == Format::Voc || options.to != Format::Yolo)) {
+        throw std::runtime_error("Class names are required (--names obj.names)");
+    }
+
+    std::unique_ptr<CocoWriter> cocoWriter;
+    if (options.to == Format::Coco) {
+        fs::path parent = fs::path(options.output).parent_path();
+        if (!parent.empty()) fs::create_directories(parent);
+        cocoWriter = std::make_unique<CocoWriter>(options.output, classNames);
+    } else {
+        fs::create_directories(options.output);
+        if (!classNames.empty()) {
+            writeClassNames((fs::path(options.output) / "obj.names").string(), classNames);
+        }
+    }
+
+    std::vector<AnnotatedImage> batch;
+    for (size_t first = 0; first < total; first += options.batchSize) {
+        size_t count = std::min<size_t>(options.batchSize, total - first);
+
+        // Parse
+        if (options.from == Format::Coco) {
+            batch.assign(std::make_move_iterator(coco.images.begin() + first),
+                         std::make_move_iterator(coco.images.begin() + first + count));
+        } else {
+            batch.assign(count, AnnotatedImage());
+            cv::parallel_for_(cv::Range(0, (int)count), [&](const cv::Range& range) {
+                for (int i = range.start; i < range.end; ++i) {
+                    const std::string& path = inputFiles[first + i];
+                    if (options.from == Format::Voc) {
+                        batch[i] = readVocAnnotation(path, classNames);
+                    } else {
+                        batch[i].labels = readYoloLabels(path);
+                        if (options.to == Format::Yolo) {
+                            batch[i].fileName = fs::path(path).filename().string();
+                        } else {
+                            resolveImage(options, path, batch[i]);
+                        }
+                    }
+                }
+            });
+        }
+
+        // Write
+        if (cocoWriter) {
+            for (const auto& image : batch) {
+                cocoWriter->addImage(image.fileName, image.size, image.labels);
+            }
+        } else {
+            cv::parallel_for_(cv::Range(0, (int)count), [&](const cv::Range& range) {
+                for (int i = range.start; i < range.end; ++i) {
+                    const AnnotatedImage& image = batch[i];
+                    std::string stem = fs::path(image.fileName).stem().string();
+                    fs::path out = fs::path(options.output) / stem;
+                    if (options.to == Format::Yolo) {
+                        writeYoloLabels(out.string() + ".txt", image.labels);
+                    } else {
+                        writeVocAnnotation(out.string() + ".xml", image, classNames);
+                    }
+                }
+            });
+        }
+
+        for (const auto& image : batch) stats.boxes += image.labels.size();
+        stats.images += count;
+    }
+    if (cocoWriter) cocoWriter->finish();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void printStats(const std::string& name, const ConvertStats& stats) {
+    std::cout << name << ": " << stats.images << " images, " << stats.boxes << " boxes in "
+              << stats.seconds << " s (" << (stats.seconds > 0 ? stats.boxes / stats.seconds : 0.0)
+              << " boxes/sec)" << std::endl;
+}
+
+// Synthetic YOLO dataset (20 boxes per 640x480 image) converted through
+// every format and back
+int runBenchmark(size_t boxes) {
+    const int boxesPerImage = 20;
+    const int numClasses = 80;
+    size_t numImages = std::max<size_t>(1, boxes / boxesPerImage);
+    fs::path root = fs::temp_directory_path() / "convert_labels_benchmark";
+    fs::remove_all(root);
+    fs::create_directories(root / "yolo");
+
+    std::vector<std::string> classNames;
+    for (int c = 0; c < numClasses; ++c) classNames.push_back("class" + std::to_string(c));
+    writeClassNames((root / "obj.names").string(), classNames);
+
+    std::cout << "Generating " << numImages * boxesPerImage << " boxes in " << numImages
+              << " label files under " << root.string() << std::endl;
+    cv::parallel_for_(cv::Range(0, (int)numImages), [&](const cv::Range& range) {
+        cv::RNG rng(range.start + 1);
+        std::vector<YoloLabel> labels(boxesPerImage);
+        for (int i = range.start; i < range.end; ++i) {
+            for (auto& label : labels) {
+                label.class_id = rng.uniform(0, numClasses);
+                label.width = rng.uniform(0.02f, 0.4f);
+                label.height = rng.uniform(0.02f, 0.4f);
+                label.x_center = rng.uniform(label.width / 2, 1 - label.width / 2);
+                label.y_center = rng.uniform(label.height / 2, 1 - label.height / 2);
+            }
+            writeYoloLabels((root / "yolo" / (std::to_string(i) + ".txt")).string(), labels);
+        }
+    });
+
+    ConvertOptions options;
+    options.namesFile = (root / "obj.names").string();
+    options.imageSize = cv::Size(640, 480);
+
+    auto run = [&](const std::string& name, Format from, Format to,
+                   const fs::path& input, const fs::path& output) {
+        options.from = from;
+        options.to = to;
+        options.input = input.string();
+        options.output = output.string();
+        printStats(name, convert(options));
+    };
+    run("yolo -> coco", Format::Yolo, Format::Coco, root / "yolo", root / "coco.json");
+    run("coco -> yolo", Format::Coco, Format::Yolo, root / "coco.json", root / "yolo_from_coco");
+    run("yolo -> voc ", Format::Yolo, Format::Voc, root / "yolo", root / "voc");
+    run("voc  -> yolo", Format::Voc, Format::Yolo, root / "voc", root / "yolo_from_voc");
+
+    fs::remove_all(root);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--benchmark") {
+        try {
+            return runBenchmark(argc >= 3 ? std::stoull(argv[2]) : 1000000);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " <yolo|coco|voc> <yolo|coco|voc> <input> <output>\n"
+                  << "       [--names obj.names] [--images dir] [--image-size WxH] [--batch 4096] [--threads N]\n"
+                  << "       " << argv[0] << " --benchmark [boxes]\n";
+        std::cerr << "Example: " << argv[0] << " yolo coco darknet_dataset/labels/train train.json"
+                  << " --names darknet_dataset/obj.names --images darknet_dataset/images/train\n";
+        return -1;
+    }
+
+    try {
+        ConvertOptions options;
+        options.from = parseFormat(argv[1]);
+        options.to = parseFormat(argv[2]);
+        options.input = argv[3];
+        options.output = argv[4];
+
+        for (int i = 5; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--names") options.namesFile = value;
+            else if (arg == "--images") options.imagesDir = value;
+            else if (arg == "--image-size") options.imageSize = parseSize(value);
+            else if (arg == "--batch") options.batchSize = std::max(1, std::stoi(value));
+            else if (arg == "--threads") cv::setNumThreads(std::stoi(value));
+        }
+        if (options.from == Format::Yolo && options.to != Format::Yolo &&
+            options.imageSize.area() <= 0 && options.imagesDir.empty()) {
+            throw std::runtime_error("YOLO input needs --images or --image-size");
+        }
+
+        printStats("Converted", convert(options));
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
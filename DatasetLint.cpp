@@ -0,0 +1,98 @@
+#include "dataset_lint.h"
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+// Dataset lint: checks every image/label pair of a Darknet dataset for
+// missing files, unreadable images, size mismatches and bad boxes (out of
+// [0,1], degenerate, duplicate, unknown class). --repair rewrites the
+// affected label files with boxes clipped and bad boxes removed; missing
+// files and malformed labels are only reported.
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <images_dir> [labels_dir] [--names obj.names] [--image-size WxH]\n"
+                  << "       [--min-box 2] [--dup-iou 0.9] [--repair] [--report lint.txt] [--threads N]\n";
+        std::cerr << "Example: " << argv[0] << " darknet_dataset/images --names darknet_dataset/obj.names --repair\n";
+        return -1;
+    }
+
+    try {
+        std::string imagesDir = argv[1];
+        // Darknet layout: .../images/<subset> -> .../labels/<subset>
+        std::string labelsDir = fs::path(labelPathForImage((fs::path(imagesDir) / "x.jpg").string()))
+                                    .parent_path().string();
+        std::string reportPath;
+        LintOptions options;
+
+        int i = 2;
+        if (i < argc && argv[i][0] != '-') {
+            labelsDir = argv[i++];
+        }
+        for (; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--repair") {
+                options.repair = true;
+                continue;
+            }
+            if (i + 1 >= argc) break;
+            std::string value = argv[++i];
+            if (arg == "--names") options.numClasses = (int)loadClassNames(value).size();
+            else if (arg == "--image-size") {
+                size_t x = value.find('x');
+                options.expectedSize = cv::Size(std::stoi(value.substr(0, x)), std::stoi(value.substr(x + 1)));
+            }
+            else if (arg == "--min-box") options.minBoxPixels = std::stof(value);
+            else if (arg == "--dup-iou") options.duplicateIou = std::stof(value);
+            else if (arg == "--report") reportPath = value;
+            else if (arg == "--threads") cv::setNumThreads(std::stoi(value));
+        }
+
+        std::cout << "Images: " << imagesDir << "\nLabels: " << labelsDir << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        LintReport report = lintDataset(imagesDir, labelsDir, options);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Full list to the report file (or stdout), summary always on stdout
+        std::ofstream reportFile;
+        if (!reportPath.empty()) {
+            reportFile.open(reportPath);
+            if (!reportFile.good()) {
+                throw std::runtime_error("Cannot write report: " + reportPath);
+            }
+        }
+        std::ostream& out = reportPath.empty() ? std::cout : reportFile;
+        for (const auto& finding : report.findings) {
+            out << lintIssueName(finding.issue) << ": " << finding.path;
+            if (!finding.detail.empty()) out << " (" << finding.detail << ")";
+            out << "\n";
+        }
+
+        std::cout << "\nChecked " << report.images << " images, " << report.labelFiles << " label files, "
+                  << report.boxes << " boxes in " << sec << " s ("
+                  << (sec > 0 ? report.images / sec : 0.0) << " images/sec)\n";
+        std::cout << "Expected image size: " << report.expectedSize.width << "x"
+                  << report.expectedSize.height << "\n";
+        for (size_t k = 0; k < report.counts.size(); ++k) {
+            if (report.counts[k] > 0) {
+                std::cout << "  " << lintIssueName((LintIssue)k) << ": " << report.counts[k] << "\n";
+            }
+        }
+        if (options.repair) {
+            std::cout << "Repaired " << report.repairedFiles << " label files, removed "
+                      << report.removedBoxes << " boxes" << std::endl;
+        } else if (report.removedBoxes > 0) {
+            std::cout << "--repair would remove " << report.removedBoxes << " boxes" << std::endl;
+        }
+        return report.findings.empty() ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
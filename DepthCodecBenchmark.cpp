@@ -0,0 +1,153 @@
+#include "depth_codec.h"
+#include "instrumentation.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Compares depth storage formats on recorded Z16 frames (.zdepth or 16-bit
+// PNG, e.g. the depth/ folder written by ImageCaptureAnnotate --depth):
+// raw, PNG-16 at two compression levels and the .zdepth codec. Reports the
+// compression ratio and encode/decode time per frame, and checks that
+// every codec returns the frame bit-exact.
+
+struct Codec {
+    std::string name;
+    std::function<void(const cv::Mat&, std::vector<uchar>&)> encode;
+    std::function<void(const std::vector<uchar>&, cv::Mat&)> decode;
+};
+
+struct CodecStats {
+    size_t bytes = 0;
+    std::vector<double> encodeMs;
+    std::vector<double> decodeMs;
+    bool lossless = true;
+};
+
+template <typename F>
+double timeMs(F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<Codec> codecs() {
+    auto png = [](int level) {
+        Codec codec;
+        codec.name = "png16 (level " + std::to_string(level) + ")";
+        codec.encode = [level](const cv::Mat& depth, std::vector<uchar>& out) {
+            cv::imencode(".png", depth, out, {cv::IMWRITE_PNG_COMPRESSION, level});
+        };
+        codec.decode = [](const std::vector<uchar>& data, cv::Mat& depth) {
+            depth = cv::imdecode(data, cv::IMREAD_UNCHANGED);
+        };
+        return codec;
+    };
+
+    Codec raw;
+    raw.name = "raw";
+    raw.encode = [](const cv::Mat& depth, std::vector<uchar>& out) {
+        out.resize(depth.total() * depth.elemSize());
+        depth.copyTo(cv::Mat(depth.size(), CV_16U, out.data()));
+    };
+    raw.decode = [](const std::vector<uchar>& data, cv::Mat& depth) {
+        cv::Mat view(depth.size(), CV_16U, const_cast<uchar*>(data.data()));
+        view.copyTo(depth);
+    };
+
+    Codec zdepth;
+    zdepth.name = "zdepth";
+    zdepth.encode = [](const cv::Mat& depth, std::vector<uchar>& out) { encodeDepth(depth, out); };
+    zdepth.decode = [](const std::vector<uchar>& data, cv::Mat& depth) {
+        decodeDepth(data.data(), data.size(), depth);
+    };
+
+    return {raw, png(1), png(3), zdepth};
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <depth_dir|frame.zdepth|frame.png>... [--runs N]\n";
+        std::cerr << "Example: " << argv[0] << " darknet_dataset/depth/train --runs 5\n";
+        return -1;
+    }
+
+    int runs = 3;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::stoi(argv[++i]));
+        } else if (fs::is_directory(arg)) {
+            for (const auto& entry : fs::directory_iterator(arg)) {
+                std::string ext = entry.path().extension().string();
+                if (ext == kDepthFileExtension || ext == ".png") paths.push_back(entry.path().string());
+            }
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    try {
+        std::vector<Codec> codecList = codecs();
+        std::vector<CodecStats> stats(codecList.size());
+        size_t rawBytes = 0;
+        int frames = 0;
+
+        std::vector<uchar> encoded;
+        cv::Mat decoded;
+        for (const auto& path : paths) {
+            cv::Mat depth = readDepthImage(path);
+            rawBytes += depth.total() * depth.elemSize();
+            frames++;
+
+            for (size_t c = 0; c < codecList.size(); ++c) {
+                const Codec& codec = codecList[c];
+                decoded.create(depth.size(), CV_16U);
+                for (int run = 0; run < runs; ++run) {
+                    stats[c].encodeMs.push_back(timeMs([&] { codec.encode(depth, encoded); }));
+                    stats[c].decodeMs.push_back(timeMs([&] { codec.decode(encoded, decoded); }));
+                }
+                stats[c].bytes += encoded.size();
+                if (decoded.size() != depth.size() || cv::norm(depth, decoded, cv::NORM_INF) != 0) {
+                    stats[c].lossless = false;
+                }
+            }
+        }
+        if (frames == 0) {
+            std::cerr << "No depth frames found" << std::endl;
+            return -1;
+        }
+
+        double frameMB = (double)rawBytes / frames / (1024.0 * 1024.0);
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Frames: " << frames << ", runs per frame: " << runs
+                  << ", raw size per frame: " << frameMB << " MB\n\n";
+        std::cout << std::left << std::setw(18) << "codec" << std::setw(9) << "ratio"
+                  << std::setw(11) << "enc ms" << std::setw(11) << "dec ms"
+                  << std::setw(11) << "enc MB/s" << std::setw(11) << "dec MB/s" << "lossless\n";
+        for (size_t c = 0; c < codecList.size(); ++c) {
+            double encodeMs = median(stats[c].encodeMs);
+            double decodeMs = median(stats[c].decodeMs);
+            std::cout << std::setw(18) << codecList[c].name
+                      << std::setw(9) << (double)rawBytes / std::max<size_t>(1, stats[c].bytes)
+                      << std::setw(11) << encodeMs << std::setw(11) << decodeMs
+                      << std::setw(11) << (encodeMs > 0 ? frameMB * 1000.0 / encodeMs : 0.0)
+                      << std::setw(11) << (decodeMs > 0 ? frameMB * 1000.0 / decodeMs : 0.0)
+                      << (stats[c].lossless ? "yes" : "NO") << "\n";
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
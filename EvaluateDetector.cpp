@@ -0,0 +1,240 @@
+#include "candidate_store.h"
+#include "detection_eval.h"
+#include "dataset_split.h"
+#include "instrumentation.h"
+#include "model_session.h"
+#include "yolo_detection.h"
+#include "yolo_labels.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Measures detector accuracy against the YOLO labels of a dataset split,
+// together with its speed, so a backend, precision or input size change can
+// be judged on both. Predictions come from running the model or from a
+// directory of cached predictions (--save-predictions of an earlier run).
+// The report is printed and written as YAML; --baseline prints the deltas
+// against an earlier report. --save-candidates keeps the pre-NMS
+// candidates for ThresholdSweep.
+
+struct SpeedStats {
+    size_t samples = 0;
+    double mean_ms = 0;
+    double p50_ms = 0;
+    double p99_ms = 0;
+    double images_per_sec = 0;
+};
+
+std::string predictionPath(const std::string& dir, const std::string& imagePath) {
+    return (fs::path(dir) / fs::path(imagePath).stem()).string() + ".txt";
+}
+
+void writeReport(const std::string& path, const std::string& name, const std::string& backend,
+                 int inputSize, const SpeedStats& speed, const EvaluationResult& result,
+                 const std::vector<std::string>& classNames) {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot write report: " + path);
+    }
+    fs << "name" << name;
+    fs << "backend" << backend;
+    fs << "input_size" << inputSize;
+    fs << "images" << (int)result.images;
+    fs << "mean_ms" << speed.mean_ms;
+    fs << "p50_ms" << speed.p50_ms;
+    fs << "p99_ms" << speed.p99_ms;
+    fs << "images_per_sec" << speed.images_per_sec;
+    fs << "map" << result.map;
+    fs << "map50" << result.map50;
+    fs << "map75" << result.map75;
+    fs << "classes" << "[";
+    for (const auto& eval : result.classes) {
+        if (eval.numTruth == 0) continue;
+        fs << "{";
+        fs << "id" << eval.classId;
+        fs << "name" << (eval.classId < (int)classNames.size() ? classNames[eval.classId] : "");
+        fs << "truth" << (int)eval.numTruth;
+        fs << "predictions" << (int)eval.numPredictions;
+        fs << "ap" << eval.apMean;
+        fs << "ap50" << eval.ap[0];
+        fs << "ap75" << eval.ap[5];
+        fs << "pr50" << eval.precisionAt50;     // Precision at recall 0.00, 0.01, ..., 1.00
+        fs << "}";
+    }
+    fs << "]";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <valid.txt|image_dir> <class_names>\n"
+                  << "       (--cfg model.cfg --weights model.weights | --predictions dir)\n"
+                  << "       [--conf 0.005] [--nms 0.45] [--size 416] [--backend name|config.yml] [--threads N]\n"
+                  << "       [--save-predictions dir] [--save-candidates candidates.pack]\n"
+                  << "       [--report eval.yml] [--name label] [--baseline eval.yml]\n";
+        std::cerr << "Example: " << argv[0] << " darknet_dataset/valid.txt darknet_dataset/obj.names"
+                  << " --cfg yolov3.cfg --weights yolov3.weights --backend openvino --name openvino\n";
+        return -1;
+    }
+
+    try {
+        std::string input = argv[1];
+        std::vector<std::string> classNames = loadClassNames(argv[2]);
+        std::string cfgPath, weightsPath, predictionsDir, saveDir, candidatesPath;
+        std::string reportPath = "evaluation.yml";
+        std::string baselinePath;
+        std::string name;
+        std::string backendArg = "opencv";
+        float confThreshold = 0.005f;
+        float nmsThreshold = 0.45f;
+        int inputSize = 416;
+        int numThreads = 0;
+
+        for (int i = 3; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--cfg") cfgPath = value;
+            else if (arg == "--weights") weightsPath = value;
+            else if (arg == "--predictions") predictionsDir = value;
+            else if (arg == "--save-predictions") saveDir = value;
+            else if (arg == "--save-candidates") candidatesPath = value;
+            else if (arg == "--conf") confThreshold = std::stof(value);
+            else if (arg == "--nms") nmsThreshold = std::stof(value);
+            else if (arg == "--size") inputSize = std::stoi(value);
+            else if (arg == "--backend") backendArg = value;
+            else if (arg == "--threads") numThreads = std::stoi(value);
+            else if (arg == "--report") reportPath = value;
+            else if (arg == "--name") name = value;
+            else if (arg == "--baseline") baselinePath = value;
+        }
+        if (predictionsDir.empty() && weightsPath.empty()) {
+            throw std::runtime_error("Either --weights (with --cfg for Darknet) or --predictions is required");
+        }
+        if (!saveDir.empty()) {
+            fs::create_directories(saveDir);
+        }
+
+        std::vector<std::string> images = loadImageList(input);
+        std::cout << "Evaluating " << images.size() << " images, " << classNames.size() << " classes\n";
+
+        // Ground truth and cached predictions are read in parallel
+        std::vector<std::vector<YoloLabel>> truth(images.size());
+        std::vector<std::vector<ScoredLabel>> predictions(images.size());
+        cv::parallel_for_(cv::Range(0, (int)images.size()), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                truth[i] = readYoloLabels(labelPathForImage(images[i]));
+                if (!predictionsDir.empty()) {
+                    predictions[i] = readScoredLabels(predictionPath(predictionsDir, images[i]));
+                }
+            }
+        });
+
+        SpeedStats speed;
+        std::string backend = "cached";
+        if (predictionsDir.empty()) {
+            BackendConfig backendConfig = resolveBackendConfig(backendArg, numThreads);
+            ModelSession session(cfgPath, weightsPath, cv::Size(inputSize, inputSize), backendConfig);
+            backend = session.getBackendName();
+            std::unique_ptr<CandidateStore> candidateStore;
+            if (!candidatesPath.empty()) {
+                candidateStore = std::make_unique<CandidateStore>(candidatesPath);
+            }
+            std::cout << "Running " << backend << " at " << inputSize << "x" << inputSize << "...\n";
+
+            // Latency covers preprocess, forward, decode and NMS; image
+            // decoding is excluded
+            std::vector<double> latencies;
+            double totalMs = 0;
+            for (size_t i = 0; i < images.size(); ++i) {
+                cv::Mat frame = cv::imread(images[i]);
+                if (frame.empty()) {
+                    std::cerr << "Could not read the image: " << images[i] << std::endl;
+                    continue;
+                }
+                auto t0 = std::chrono::steady_clock::now();
+                std::vector<Detection> candidates =
+                    decodeYoloOutputs(session.run(frame), frame.size(), confThreshold, classNames);
+                std::vector<Detection> detections = suppressDetections(candidates, confThreshold, nmsThreshold);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                latencies.push_back(ms);
+                totalMs += ms;
+
+                if (candidateStore) {
+                    candidateStore->put(images[i], frame.size(), candidates, confThreshold);
+                }
+                for (const auto& det : detections) {
+                    predictions[i].push_back({toYoloLabel(det, frame.size()), det.confidence});
+                }
+                if (!saveDir.empty()) {
+                    writeScoredLabels(predictionPath(saveDir, images[i]), predictions[i]);
+                }
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            speed.samples = latencies.size();
+            speed.mean_ms = latencies.empty() ? 0.0 : totalMs / latencies.size();
+            speed.p50_ms = percentile(latencies, 0.50);
+            speed.p99_ms = percentile(latencies, 0.99);
+            speed.images_per_sec = totalMs > 0 ? 1000.0 * latencies.size() / totalMs : 0.0;
+        }
+
+        auto evalStart = std::chrono::steady_clock::now();
+        DetectionEvaluator evaluator((int)classNames.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            evaluator.add(truth[i], predictions[i]);
+        }
+        EvaluationResult result = evaluator.evaluate();
+        double evalSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - evalStart).count();
+
+        // Report
+        std::cout << std::fixed << std::setprecision(4) << "\n" << std::left << std::setw(20) << "class"
+                  << std::right << std::setw(8) << "truth" << std::setw(8) << "preds"
+                  << std::setw(10) << "AP" << std::setw(10) << "AP50" << std::setw(10) << "AP75" << "\n";
+        for (const auto& eval : result.classes) {
+            if (eval.numTruth == 0) continue;
+            std::cout << std::left << std::setw(20) << classNames[eval.classId] << std::right
+                      << std::setw(8) << eval.numTruth << std::setw(8) << eval.numPredictions
+                      << std::setw(10) << eval.apMean << std::setw(10) << eval.ap[0]
+                      << std::setw(10) << eval.ap[5] << "\n";
+        }
+        std::cout << "\nmAP@[.5:.95] " << result.map << "  mAP@.5 " << result.map50
+                  << "  mAP@.75 " << result.map75 << "  (" << result.truths << " boxes, "
+                  << result.predictions << " predictions, evaluated in " << evalSec << " s)\n";
+        if (speed.samples > 0) {
+            std::cout << std::setprecision(2) << "Latency mean " << speed.mean_ms << " ms, p50 "
+                      << speed.p50_ms << " ms, p99 " << speed.p99_ms << " ms, "
+                      << speed.images_per_sec << " images/sec\n";
+        }
+
+        writeReport(reportPath, name.empty() ? backend : name, backend, inputSize, speed, result, classNames);
+        std::cout << "Report written to " << reportPath << std::endl;
+
+        if (!baselinePath.empty()) {
+            cv::FileStorage baseline(baselinePath, cv::FileStorage::READ);
+            if (!baseline.isOpened()) {
+                throw std::runtime_error("Cannot open baseline report: " + baselinePath);
+            }
+            double baseMap = (double)baseline["map"], baseMap50 = (double)baseline["map50"];
+            double baseFps = (double)baseline["images_per_sec"];
+            std::cout << std::setprecision(4) << "\nAgainst " << (std::string)baseline["name"]
+                      << ": mAP " << std::showpos << result.map - baseMap
+                      << ", mAP@.5 " << result.map50 - baseMap50 << std::noshowpos;
+            if (speed.samples > 0 && baseFps > 0) {
+                std::cout << std::setprecision(2) << ", speed x" << speed.images_per_sec / baseFps;
+            }
+            std::cout << std::endl;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
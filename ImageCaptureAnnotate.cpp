@@ -1,114 +1,196 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include "ensemble_detector.h"
+#include "yolo_labels.h"
+#include "instrumentation.h"
+#include "overlay_renderer.h"
+#include "ui_control.h"
+#include "object_localization.h"
+#include "depth_codec.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <filesystem>
 #include <map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <memory>
 
 namespace fs = std::filesystem;
 
 class AutoAnnotator {
 private:
-    cv::dnn::Net net;
+    EnsembleDetector detector;
     std::vector<std::string> classes;
     std::map<std::string, int> class_map;
     float conf_threshold;
     float nms_threshold;
     
 public:
+    // Single pre-trained model (e.g., COCO trained model)
     AutoAnnotator(const std::string& model_cfg,
                  const std::string& model_weights,
                  const std::string& class_file,
                  float conf_thresh = 0.5,
-                 float nms_thresh = 0.4) 
-        : conf_threshold(conf_thresh), nms_threshold(nms_thresh) {
-        
-        // Load pre-trained model (e.g., COCO trained model)
-        net = cv::dnn::readNetFromDarknet(model_cfg, model_weights);
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+                 float nms_thresh = 0.4,
+                 const BackendConfig& backend = BackendConfig()) 
+        : AutoAnnotator({singleModel(model_cfg, model_weights, class_file, backend)},
+                        conf_thresh, nms_thresh) {}
+    
+    // Ensemble mode: all models run in parallel and their boxes are fused
+    AutoAnnotator(const std::vector<EnsembleMember>& models,
+                 float conf_thresh = 0.5,
+                 float nms_thresh = 0.4)
+        : detector(models, nms_thresh),
+          conf_threshold(conf_thresh), nms_threshold(nms_thresh) {
         
-        // Load class names
-        std::ifstream ifs(class_file);
-        std::string line;
-        int class_id = 0;
-        while (std::getline(ifs, line)) {
-            classes.push_back(line);
-            class_map[line] = class_id++;
+        // Class names are the union over all models
+        classes = detector.getClassNames();
+        for (size_t i = 0; i < classes.size(); ++i) {
+            class_map[classes[i]] = (int)i;
         }
     }
     
-    struct Detection {
+    using Detection = ::Detection;
+
+    float getConfThreshold() const { return conf_threshold; }
+    const std::vector<std::string>& getClassNames() const { return classes; }
+
+    std::vector<Detection> detectObjects(const cv::Mat& frame) {
+        return detectObjects(frame, conf_threshold);
+    }
+
+    // Keeps every candidate whose best class score is above min_confidence,
+    // so callers can also look at the near-misses below conf_threshold
+    std::vector<Detection> detectObjects(const cv::Mat& frame, float min_confidence) {
+        return detector.detect(frame, min_confidence);
+    }
+
+private:
+    static EnsembleMember singleModel(const std::string& model_cfg,
+                                      const std::string& model_weights,
+                                      const std::string& class_file,
+                                      const BackendConfig& backend) {
+        EnsembleMember model;
+        model.configPath = model_cfg;
+        model.weightsPath = model_weights;
+        model.classFile = class_file;
+        model.backend = backend;
+        return model;
+    }
+};
+
+// Minimal IoU tracker used to spot frames where the detector disagrees with
+// what it reported on previous frames (boxes popping in/out, class flips)
+class BoxTracker {
+private:
+    struct Track {
         cv::Rect box;
-        float confidence;
         int class_id;
-        std::string class_name;
+        int hits;
+        int misses;
     };
+    std::vector<Track> tracks;
+    float iou_threshold;
+    int max_misses;
+    bool has_history;
 
-    std::vector<Detection> detectObjects(const cv::Mat& frame) {
-        cv::Mat blob;
-        std::vector<Detection> detections;
-        
-        // Create blob from image
-        cv::dnn::blobFromImage(frame, blob, 1/255.0, cv::Size(416, 416), 
-                              cv::Scalar(0,0,0), true, false);
-        net.setInput(blob);
-        
-        // Get outputs
-        std::vector<cv::Mat> outs;
-        net.forward(outs, getOutputsNames());
-        
-        // Process detections
-        std::vector<int> classIds;
-        std::vector<float> confidences;
-        std::vector<cv::Rect> boxes;
-        
-        for (const auto& out : outs) {
-            for (int i = 0; i < out.rows; ++i) {
-                const float* data = (float*)out.row(i).data;
-                cv::Mat scores = out.row(i).colRange(5, out.cols);
-                cv::Point classIdPoint;
-                double confidence;
-                minMaxLoc(scores, 0, &confidence, 0, &classIdPoint);
-                
-                if (confidence > conf_threshold) {
-                    Detection det;
-                    int centerX = (int)(data[0] * frame.cols);
-                    int centerY = (int)(data[1] * frame.rows);
-                    int width = (int)(data[2] * frame.cols);
-                    int height = (int)(data[3] * frame.rows);
-                    
-                    det.box = cv::Rect(centerX - width/2, centerY - height/2, 
-                                     width, height);
-                    det.confidence = confidence;
-                    det.class_id = classIdPoint.x;
-                    det.class_name = classes[det.class_id];
-                    
-                    detections.push_back(det);
+public:
+    BoxTracker(float iou_thresh = 0.3f, int max_miss = 5)
+        : iou_threshold(iou_thresh), max_misses(max_miss), has_history(false) {}
+
+    // Matches detections to tracks and returns the disagreement in [0,1]:
+    // the share of boxes that appeared, vanished or changed class
+    float update(const std::vector<AutoAnnotator::Detection>& detections) {
+        std::vector<bool> matched(tracks.size(), false);
+        int disagreements = 0;
+        int total = (int)detections.size();
+
+        for (const auto& det : detections) {
+            int best = -1;
+            float best_iou = iou_threshold;
+            for (size_t t = 0; t < tracks.size(); ++t) {
+                if (matched[t]) continue;
+                float overlap = boxIoU(det.box, tracks[t].box);
+                if (overlap > best_iou) {
+                    best_iou = overlap;
+                    best = (int)t;
                 }
             }
+
+            if (best < 0) {
+                // Objects entering the scene only count once we have history
+                if (has_history) disagreements++;
+                tracks.push_back({det.box, det.class_id, 1, 0});
+                matched.push_back(true);
+                continue;
+            }
+
+            Track& track = tracks[best];
+            matched[best] = true;
+            if (track.class_id != det.class_id) {
+                disagreements++;
+                track.class_id = det.class_id;
+            }
+            track.box = det.box;
+            track.hits++;
+            track.misses = 0;
         }
-        
-        return detections;
-    }
 
-private:
-    std::vector<std::string> getOutputsNames() {
-        static std::vector<std::string> names;
-        if (names.empty()) {
-            std::vector<int> outLayers = net.getUnconnectedOutLayers();
-            std::vector<std::string> layersNames = net.getLayerNames();
-            names.resize(outLayers.size());
-            for (size_t i = 0; i < outLayers.size(); ++i) {
-                names[i] = layersNames[outLayers[i] - 1];
+        // Established tracks that were not seen on this frame
+        for (size_t t = 0; t < tracks.size(); ++t) {
+            if (matched[t]) continue;
+            tracks[t].misses++;
+            if (tracks[t].hits >= 2 && tracks[t].misses == 1) {
+                disagreements++;
+                total++;
             }
         }
-        return names;
+        tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+                                    [this](const Track& t) { return t.misses > max_misses; }),
+                     tracks.end());
+
+        has_history = true;
+        return total > 0 ? (float)disagreements / total : 0.0f;
     }
 };
 
+// Settings for the unattended active-learning mode
+struct UncertaintyConfig {
+    float near_band = 0.15f;       // Scores this close to conf_threshold are uncertain
+    float margin_weight = 0.4f;    // Top-1 vs top-2 class margin
+    float threshold_weight = 0.3f; // Confidence near the threshold
+    float tracking_weight = 0.3f;  // Disagreement with tracked boxes
+    float min_score = 0.25f;       // Frames below this are never saved
+    int window_frames = 90;        // Rate budget window (3 s at 30 FPS)
+    int saves_per_window = 2;      // At most this many frames saved per window
+};
+
+// Combines the uncertainty cues of one frame into a score in [0,1]
+float scoreFrameUncertainty(const std::vector<AutoAnnotator::Detection>& candidates,
+                            float conf_threshold, float disagreement,
+                            const UncertaintyConfig& config) {
+    float margin = 0.0f;
+    float near_threshold = 0.0f;
+
+    for (const auto& det : candidates) {
+        // Margin only matters for boxes that would end up in the labels
+        if (det.confidence > conf_threshold) {
+            margin = std::max(margin, 1.0f - (det.confidence - det.runner_up));
+        }
+        float distance = std::abs(det.confidence - conf_threshold);
+        near_threshold = std::max(near_threshold, 1.0f - distance / config.near_band);
+    }
+
+    return config.margin_weight * margin +
+           config.threshold_weight * near_threshold +
+           config.tracking_weight * disagreement;
+}
+
 class AutomaticDatasetAnnotator {
 private:
     rs2::pipeline pipe;
@@ -117,15 +199,37 @@ private:
     std::string dataset_path;
     std::string images_path;  // Added member variable
     std::string labels_path;  // Added member variable
+    std::string depth_path;
+    OverlayRenderer overlay;  // Reused across frames, keeps the label cache
     
+    // Depth mode: depth aligned to color, 3D positions stored with the labels
+    bool with_depth;
+    std::unique_ptr<rs2::align> align_to_color;
+    std::unique_ptr<ObjectLocalizer> localizer;
     
 public:
     AutomaticDatasetAnnotator(const std::string& base_path,
                             const std::string& model_cfg,
                             const std::string& model_weights,
-                            const std::string& class_file)
-        : annotator(model_cfg, model_weights, class_file) {
-        
+                            const std::string& class_file,
+                            const BackendConfig& backend = BackendConfig(),
+                            bool with_depth = false)
+        : annotator(model_cfg, model_weights, class_file, 0.5f, 0.4f, backend),
+          with_depth(with_depth) {
+        setupDataset(base_path);
+        setupRealSense();
+    }
+    
+    // Ensemble mode: labels come from the fused outputs of all models
+    AutomaticDatasetAnnotator(const std::string& base_path,
+                            const std::vector<EnsembleMember>& models,
+                            bool with_depth = false)
+        : annotator(models), with_depth(with_depth) {
+        setupDataset(base_path);
+        setupRealSense();
+    }
+    
+    void setupDataset(const std::string& base_path) {
          // Get absolute path for dataset
         dataset_path = fs::absolute(base_path).string();
         images_path = dataset_path + "/images/train";
@@ -134,108 +238,299 @@ public:
         // Create directories if they don't exist
         fs::create_directories(images_path);
         fs::create_directories(labels_path);
+        if (with_depth) {
+            depth_path = dataset_path + "/depth/train";
+            fs::create_directories(depth_path);
+        }
         
         // Print directory paths
         std::cout << "Dataset directory: " << dataset_path << std::endl;
         std::cout << "Images will be saved to: " << images_path << std::endl;
         std::cout << "Labels will be saved to: " << labels_path << std::endl;
-        setupRealSense();
+        
+        // Class ids in the labels refer to this list
+        std::ofstream names_file(dataset_path + "/obj.names");
+        for (const auto& name : annotator.getClassNames()) {
+            names_file << name << "\n";
+        }
     }
     
     void setupRealSense() {
         cfg.enable_stream(RS2_STREAM_COLOR, 640, 480, RS2_FORMAT_BGR8, 30);
-        pipe.start(cfg);
+        if (!with_depth) {
+            pipe.start(cfg);
+            return;
+        }
+        
+        cfg.enable_stream(RS2_STREAM_DEPTH, 640, 480, RS2_FORMAT_Z16, 30);
+        rs2::pipeline_profile profile = pipe.start(cfg);
+        align_to_color = std::make_unique<rs2::align>(RS2_STREAM_COLOR);
+        
+        // Depth is aligned to color, so the color intrinsics deproject it
+        rs2_intrinsics color_intrinsics = profile.get_stream(RS2_STREAM_COLOR)
+            .as<rs2::video_stream_profile>().get_intrinsics();
+        CameraIntrinsics intrinsics;
+        intrinsics.width = color_intrinsics.width;
+        intrinsics.height = color_intrinsics.height;
+        intrinsics.fx = color_intrinsics.fx;
+        intrinsics.fy = color_intrinsics.fy;
+        intrinsics.ppx = color_intrinsics.ppx;
+        intrinsics.ppy = color_intrinsics.ppy;
+        float depth_scale = profile.get_device().first<rs2::depth_sensor>().get_depth_scale();
+        localizer = std::make_unique<ObjectLocalizer>(intrinsics, depth_scale);
+        
+        // Recorded depth + intrinsics let positions be recomputed offline
+        saveIntrinsics(dataset_path + "/intrinsics.yml", intrinsics, depth_scale);
+        std::cout << "Depth frames will be saved to: " << depth_path << std::endl;
     }
     
-    void collectAndAnnotate(int num_frames) {
-        cv::namedWindow("Auto Annotation", cv::WINDOW_AUTOSIZE);
+    // Next frameset, with depth aligned to color in depth mode
+    rs2::frameset captureFrames() {
+        rs2::frameset frames;
+        {
+            ScopedTimer timer(Stage::CaptureWait);
+            frames = pipe.wait_for_frames();
+        }
+        if (align_to_color) {
+            frames = align_to_color->process(frames);
+        }
+        return frames;
+    }
+    
+    // Zero-copy view of the aligned depth, empty without depth mode
+    cv::Mat depthImage(const rs2::frameset& frames) const {
+        if (!with_depth) {
+            return cv::Mat();
+        }
+        rs2::depth_frame depth_frame = frames.get_depth_frame();
+        return cv::Mat(cv::Size(640, 480), CV_16UC1,
+                       (void*)depth_frame.get_data(), cv::Mat::AUTO_STEP);
+    }
+    
+    // Commands come from the window, stdin ("save", "retry", "quit") or
+    // signals; without a window the loop runs headless at camera rate
+    void collectAndAnnotate(int num_frames, bool show_window = true) {
+        ControlChannel control;
+        control.enableStdin();
+        control.enableSignals();
+        std::unique_ptr<DisplayThread> display_thread;
+        if (show_window) {
+            display_thread = std::make_unique<DisplayThread>("Auto Annotation", control);
+        }
         int frame_count = 0;
         
         while (frame_count < num_frames) {
             // Capture frame
-            rs2::frameset frames = pipe.wait_for_frames();
+            rs2::frameset frames = captureFrames();
             rs2::frame color_frame = frames.get_color_frame();
             cv::Mat frame(cv::Size(640, 480), CV_8UC3, 
                          (void*)color_frame.get_data(), cv::Mat::AUTO_STEP);
+            cv::Mat depth = depthImage(frames);
             
             // Detect objects
             auto detections = annotator.detectObjects(frame);
-            
-            // Draw detections
-            cv::Mat display = frame.clone();
-            for (const auto& det : detections) {
-                cv::rectangle(display, det.box, cv::Scalar(0, 255, 0), 2);
-                std::string label = det.class_name + " " + 
-                                  std::to_string(det.confidence).substr(0, 4);
-                cv::putText(display, label, 
-                           cv::Point(det.box.x, det.box.y - 5),
-                           cv::FONT_HERSHEY_SIMPLEX, 0.5, 
-                           cv::Scalar(0, 255, 0), 2);
+            std::vector<ObjectPosition> positions;
+            if (localizer) {
+                positions = localizer->localize(depth, detections);
             }
             
-            // Display info
-            std::string info = "Frame: " + std::to_string(frame_count) + 
-                             "/" + std::to_string(num_frames);
-            cv::putText(display, info, cv::Point(10, 30), 
-                       cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 255, 0), 2);
-            cv::putText(display, "SPACE: Save with annotations", 
-                       cv::Point(10, 60), cv::FONT_HERSHEY_SIMPLEX, 
-                       0.5, cv::Scalar(0, 255, 0), 1);
-            cv::putText(display, "R: Retry detection", 
-                       cv::Point(10, 80), cv::FONT_HERSHEY_SIMPLEX, 
-                       0.5, cv::Scalar(0, 255, 0), 1);
-            cv::putText(display, "Q: Quit", 
-                       cv::Point(10, 100), cv::FONT_HERSHEY_SIMPLEX, 
-                       0.5, cv::Scalar(0, 255, 0), 1);
+            if (display_thread) {
+                // Draw detections on the overlay layer, composited once
+                cv::Mat display = frame.clone();
+                {
+                    ScopedTimer timer(Stage::Draw);
+                    overlay.begin(display.size());
+                    for (const auto& det : detections) {
+                        overlay.addDetection(det);
+                    }
+                    
+                    // Distance of each located object under its box
+                    TextStyle depth_style;
+                    depth_style.color = cv::Scalar(255, 255, 0);
+                    depth_style.filledBackground = false;
+                    for (size_t i = 0; i < positions.size(); ++i) {
+                        if (!positions[i].valid) continue;
+                        std::ostringstream distance;
+                        distance << std::fixed << std::setprecision(2) << positions[i].centroid.z << "m";
+                        const cv::Rect& box = detections[i].box;
+                        overlay.addText(distance.str(), cv::Point(box.x, box.y + box.height + 15),
+                                        depth_style, cv::Rect(cv::Point(0, 0), display.size()));
+                    }
+                
+                    // Display info
+                    TextStyle info_style;
+                    info_style.color = cv::Scalar(0, 255, 0);
+                    info_style.filledBackground = false;
+                    TextStyle info_large = info_style;
+                    info_large.scale = 1.0;
+                    info_large.thickness = 2;
+                    std::string info = "Frame: " + std::to_string(frame_count) + 
+                                     "/" + std::to_string(num_frames);
+                    overlay.addText(info, cv::Point(10, 30), info_large);
+                    overlay.addText("SPACE: Save with annotations", cv::Point(10, 60), info_style);
+                    overlay.addText("R: Retry detection", cv::Point(10, 80), info_style);
+                    overlay.addText("Q: Quit", cv::Point(10, 100), info_style);
+                    overlay.compose(display);
+                }
+                drawLatencyOverlay(display);
+                display_thread->show(display);
+            }
             
-            cv::imshow("Auto Annotation", display);
-            char key = cv::waitKey(1);
+            int key = control.poll();
             
             if (key == ' ') {  // Space to save
-                saveAnnotations(frame, detections, frame_count);
+                saveAnnotations(frame, detections, frame_count, depth, &positions);
                 frame_count++;
             }
             else if (key == 'r') {  // Retry detection
                 continue;
             }
-            else if (key == 'q') {  // Quit
+            else if (key == 'q' || key == 27) {  // Quit
                 break;
             }
         }
+    }
+    
+    // Unattended mode: scores every frame and saves only the most uncertain
+    // ones, at most saves_per_window frames per window_frames captured
+    void collectUncertain(int num_frames,
+                          const UncertaintyConfig& config = UncertaintyConfig()) {
+        struct Candidate {
+            float score;
+            cv::Mat frame;
+            cv::Mat depth;
+            std::vector<AutoAnnotator::Detection> detections;
+        };
+        
+        BoxTracker tracker;
+        std::vector<Candidate> window;
+        float conf_threshold = annotator.getConfThreshold();
+        float min_confidence = std::max(0.0f, conf_threshold - config.near_band);
+        std::ofstream score_log(dataset_path + "/uncertainty.txt", std::ios::app);
+        int frame_count = 0;
+        int frames_in_window = 0;
+        long long captured = 0;
+        
+        // Saves the buffered candidates of the current window, best first
+        auto flushWindow = [&]() {
+            std::sort(window.begin(), window.end(),
+                      [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+            for (auto& candidate : window) {
+                if (frame_count >= num_frames) break;
+                saveAnnotations(candidate.frame, candidate.detections, frame_count,
+                                candidate.depth);
+                score_log << frame_count << ".jpg " << candidate.score << "\n";
+                frame_count++;
+            }
+            score_log.flush();
+            window.clear();
+            frames_in_window = 0;
+        };
+        
+        // Ctrl-C / SIGTERM stops after saving the current window
+        ControlChannel control;
+        control.enableSignals();
+        
+        std::cout << "Unattended annotation: saving up to " << config.saves_per_window
+                  << " frames every " << config.window_frames << " frames\n";
+        
+        while (frame_count < num_frames) {
+            control.poll();
+            if (control.quitRequested()) {
+                break;
+            }
+            
+            rs2::frameset frames = captureFrames();
+            rs2::frame color_frame = frames.get_color_frame();
+            cv::Mat frame(cv::Size(640, 480), CV_8UC3, 
+                         (void*)color_frame.get_data(), cv::Mat::AUTO_STEP);
+            cv::Mat depth = depthImage(frames);
+            captured++;
+            
+            // Candidates include near-misses below the threshold; only the
+            // accepted ones are tracked and written as labels
+            auto candidates = annotator.detectObjects(frame, min_confidence);
+            std::vector<AutoAnnotator::Detection> accepted;
+            for (const auto& det : candidates) {
+                if (det.confidence > conf_threshold) {
+                    accepted.push_back(det);
+                }
+            }
+            
+            float disagreement = tracker.update(accepted);
+            float score = scoreFrameUncertainty(candidates, conf_threshold,
+                                                disagreement, config);
+            
+            // Keep the top saves_per_window candidates of this window
+            if (score >= config.min_score) {
+                if ((int)window.size() < config.saves_per_window) {
+                    window.push_back({score, frame.clone(), depth.clone(), accepted});
+                } else if (!window.empty()) {
+                    auto weakest = std::min_element(window.begin(), window.end(),
+                        [](const Candidate& a, const Candidate& b) { return a.score < b.score; });
+                    if (score > weakest->score) {
+                        weakest->score = score;
+                        frame.copyTo(weakest->frame);
+                        depth.copyTo(weakest->depth);
+                        weakest->detections = accepted;
+                    }
+                }
+            }
+            
+            if (++frames_in_window >= config.window_frames) {
+                flushWindow();
+                std::cout << "Captured " << captured << " frames, saved " 
+                          << frame_count << "/" << num_frames << std::endl;
+            }
+        }
         
-        cv::destroyAllWindows();
+        flushWindow();
     }
     
 private:
+    // In depth mode the depth frame is saved losslessly (.zdepth) and the 3D object
+    // positions next to the labels (computed here unless already known)
     void saveAnnotations(const cv::Mat& frame, 
                         const std::vector<AutoAnnotator::Detection>& detections,
-                        int frame_count) {
+                        int frame_count,
+                        const cv::Mat& depth = cv::Mat(),
+                        const std::vector<ObjectPosition>* positions = nullptr) {
         // Generate filenames with absolute paths
         std::string img_filename = images_path + "/" + 
                                  std::to_string(frame_count) + ".jpg";
         std::string label_filename = labels_path + "/" + 
                                    std::to_string(frame_count) + ".txt";
         
-        // Save image
-        cv::imwrite(img_filename, frame);
-        
-        // Save annotations in YOLO format
-        std::ofstream label_file(label_filename);
-        
-        for (const auto& det : detections) {
-            float x_center = (det.box.x + det.box.width/2.0f) / frame.cols;
-            float y_center = (det.box.y + det.box.height/2.0f) / frame.rows;
-            float width = (float)det.box.width / frame.cols;
-            float height = (float)det.box.height / frame.rows;
+        // Save image, encoding and writing timed separately
+        std::vector<uchar> encoded;
+        {
+            ScopedTimer timer(Stage::Encode);
+            cv::imencode(".jpg", frame, encoded);
+        }
+        {
+            ScopedTimer timer(Stage::DiskWrite);
+            std::ofstream(img_filename, std::ios::binary)
+                .write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
             
-            label_file << det.class_id << " " 
-                      << x_center << " " 
-                      << y_center << " "
-                      << width << " " 
-                      << height << "\n";
+            // Save annotations in YOLO format
+            writeYoloLabels(label_filename, detections, frame.size());
         }
         
-        label_file.close();
+        if (localizer && !depth.empty()) {
+            std::vector<ObjectPosition> located = positions ? *positions
+                                                            : localizer->localize(depth, detections);
+            std::string base = std::to_string(frame_count);
+            writeObjectPositions(labels_path + "/" + base + ".positions.yml", detections, located);
+            
+            std::vector<uchar> encoded_depth;
+            {
+                ScopedTimer timer(Stage::Encode);
+                encodeDepth(depth, encoded_depth);
+            }
+            ScopedTimer timer(Stage::DiskWrite);
+            std::ofstream(depth_path + "/" + base + kDepthFileExtension, std::ios::binary)
+                .write(reinterpret_cast<const char*>(encoded_depth.data()), encoded_depth.size());
+        }
         
         // Print saved file locations
         std::cout << "Saved image to: " << img_filename << std::endl;
@@ -243,26 +538,98 @@ private:
     }
 };
 
-int main() 
+int main(int argc, char** argv) 
 {
     try {
+        // --auto [frames] runs the unattended active-learning mode,
+        // --ensemble fuses the COCO model with the custom kimbap model,
+        // --backend <name|config.yml> [--threads N] selects the inference backend,
+        // --model-cache <dir> loads Darknet models through the preprocessed cache,
+        // PERF_STATS=<file> in the environment enables stage latency stats,
+        // --headless runs without a window (default when no display is available),
+        // --depth also records aligned depth and stores 3D object positions
+        bool unattended = false;
+        bool ensemble = false;
+        int num_frames = 100;
+        std::string backend_arg = "opencv";
+        int num_threads = 0;
+        std::string model_cache_dir;
+        bool headless = !displayAvailable();
+        bool with_depth = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--auto") {
+                unattended = true;
+                if (i + 1 < argc && std::isdigit((unsigned char)argv[i + 1][0])) {
+                    num_frames = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--ensemble") {
+                ensemble = true;
+            } else if (arg == "--backend" && i + 1 < argc) {
+                backend_arg = argv[++i];
+            } else if (arg == "--threads" && i + 1 < argc) {
+                num_threads = std::stoi(argv[++i]);
+            } else if (arg == "--model-cache" && i + 1 < argc) {
+                model_cache_dir = argv[++i];
+            } else if (arg == "--headless") {
+                headless = true;
+            } else if (arg == "--depth") {
+                with_depth = true;
+            }
+        }
+        BackendConfig backend = resolveBackendConfig(backend_arg, num_threads);
+        auto latency_reporter = startInstrumentationFromEnv();
+        if (!model_cache_dir.empty()) {
+            backend.modelCacheDir = model_cache_dir;
+        }
+        std::cout << "Inference backend: " << backendName(backend.kind) << std::endl;
+        
         // Get current working directory
         std::string current_path = fs::current_path().string();
         std::cout << "Current working directory: " << current_path << std::endl;
 
-        AutomaticDatasetAnnotator annotator(
-            "darknet_dataset",
-            "yolov3.cfg",
-            "yolov3.weights",
-            "coco.names"
-        );
+        std::unique_ptr<AutomaticDatasetAnnotator> annotator_ptr;
+        if (ensemble) {
+            EnsembleMember coco;
+            coco.configPath = "yolov3.cfg";
+            coco.weightsPath = "yolov3.weights";
+            coco.classFile = "coco.names";
+            coco.backend = backend;
+            
+            EnsembleMember kimbap;
+            kimbap.configPath = "/home/thornch/Documents/YOLOv3_custom_data_and_onnx/yolov3_darknet_kimbap/darknet/cfg/yolov3-kimbap.cfg";
+            kimbap.weightsPath = "/home/thornch/Documents/YOLOv3_custom_data_and_onnx/yolov3_darknet_kimbap/darknet/backup/yolov3-kimbap_3000.weights";
+            kimbap.classFile = "darknet_dataset_Capture/obj.names";
+            kimbap.backend = backend;
+            
+            annotator_ptr = std::make_unique<AutomaticDatasetAnnotator>(
+                "darknet_dataset", std::vector<EnsembleMember>{coco, kimbap}, with_depth);
+        } else {
+            annotator_ptr = std::make_unique<AutomaticDatasetAnnotator>(
+                "darknet_dataset",
+                "yolov3.cfg",
+                "yolov3.weights",
+                "coco.names",
+                backend,
+                with_depth
+            );
+        }
+        AutomaticDatasetAnnotator& annotator = *annotator_ptr;
 
-        std::cout << "\nPress:\n";
-        std::cout << "SPACE - Save frame with annotations\n";
-        std::cout << "R     - Retry detection\n";
-        std::cout << "Q     - Quit\n\n";
+        if (unattended) {
+            annotator.collectUncertain(num_frames);
+            return 0;
+        }
+
+        std::cout << "\nPress (in the window) or type (on stdin):\n";
+        std::cout << "SPACE / save  - Save frame with annotations\n";
+        std::cout << "R     / retry - Retry detection\n";
+        std::cout << "Q     / quit  - Quit (also Ctrl-C)\n\n";
+        if (headless) {
+            std::cout << "Running headless, no display window\n";
+        }
         
-        annotator.collectAndAnnotate(100);  // Collect 100 frames
+        annotator.collectAndAnnotate(num_frames, !headless);
         
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -1,11 +1,16 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
+#include "instrumentation.h"
+#include "ui_control.h"
+#include "depth_codec.h"
+#include "dataset_split.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
 #include <chrono>
 #include <thread>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -16,18 +21,23 @@ private:
     std::string dataset_path;
     std::string images_path;
     std::string labels_path;
+    std::string depth_path;
+    bool with_depth;   // Also store Z16 depth aligned to color
+    std::unique_ptr<rs2::align> align_to_color;
     int frame_count;
     int image_width;
     int image_height;
     std::vector<std::string> class_names;
 
 public:
-    DatasetCollector(const std::string& base_path, int width = 640, int height = 480) // width 640 height 480 
-        : image_width(width), image_height(height) {
+    DatasetCollector(const std::string& base_path, int width = 640, int height = 480, // width 640 height 480 
+                     bool with_depth = false)
+        : with_depth(with_depth), image_width(width), image_height(height) {
         // Create directory structure for darknet format
         dataset_path = base_path;
         images_path = dataset_path + "/images";
         labels_path = dataset_path + "/labels";
+        depth_path = dataset_path + "/depth";
 
         createDirectories();
         setupRealSense();
@@ -79,10 +89,18 @@ public:
         fs::create_directories(images_path + "/valid");
         fs::create_directories(labels_path + "/train");
         fs::create_directories(labels_path + "/valid");
+        if (with_depth) {
+            fs::create_directories(depth_path + "/train");
+            fs::create_directories(depth_path + "/valid");
+        }
     }
 
     void setupRealSense() {
         cfg.enable_stream(RS2_STREAM_COLOR, image_width, image_height, RS2_FORMAT_BGR8, 30);
+        if (with_depth) {
+            cfg.enable_stream(RS2_STREAM_DEPTH, image_width, image_height, RS2_FORMAT_Z16, 30);
+            align_to_color = std::make_unique<rs2::align>(RS2_STREAM_COLOR);
+        }
         pipe.start(cfg);
         
         // Warm up camera
@@ -115,81 +133,124 @@ public:
         data_file.close();
     }
 
-    cv::Mat captureFrame() {
-        rs2::frameset frames = pipe.wait_for_frames();
+    // Color frame, and the aligned depth frame in depth mode
+    cv::Mat captureFrame(cv::Mat* depth = nullptr) {
+        rs2::frameset frames;
+        {
+            ScopedTimer timer(Stage::CaptureWait);
+            frames = pipe.wait_for_frames();
+        }
+        if (align_to_color) {
+            frames = align_to_color->process(frames);
+            if (depth) {
+                rs2::depth_frame depth_frame = frames.get_depth_frame();
+                *depth = cv::Mat(cv::Size(image_width, image_height), CV_16UC1,
+                                 (void*)depth_frame.get_data(), cv::Mat::AUTO_STEP);
+            }
+        }
         rs2::frame color_frame = frames.get_color_frame();
         return cv::Mat(cv::Size(image_width, image_height), CV_8UC3, 
                       (void*)color_frame.get_data(), cv::Mat::AUTO_STEP);
     }
 
-    void collectDataset(int num_frames) {
-        cv::namedWindow("Dataset Collection", cv::WINDOW_AUTOSIZE);
-        std::cout << "Press 'SPACE' to capture, 'Q' to quit\n";
+    void collectDataset(int num_frames, bool show_window = true) {
+        // Commands come from the window, stdin ("save", "quit") or signals
+        ControlChannel control;
+        control.enableStdin();
+        control.enableSignals();
+        std::unique_ptr<DisplayThread> display_thread;
+        if (show_window) {
+            display_thread = std::make_unique<DisplayThread>("Dataset Collection", control);
+        }
+        std::cout << "Press 'SPACE' to capture, 'Q' to quit (or type save / quit)\n";
 
         while (frame_count < num_frames) {
-            cv::Mat frame = captureFrame();
+            cv::Mat depth;
+            cv::Mat frame = captureFrame(&depth);
             
             // Show preview with overlay
-            cv::Mat display = frame.clone();
-            std::string info = "Captured: " + std::to_string(frame_count) + 
-                             "/" + std::to_string(num_frames);
-            cv::putText(display, info, cv::Point(10, 30), 
-                       cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 255, 0), 2);
+            if (display_thread) {
+                cv::Mat display = frame.clone();
+                {
+                    ScopedTimer timer(Stage::Draw);
+                    std::string info = "Captured: " + std::to_string(frame_count) + 
+                                     "/" + std::to_string(num_frames);
+                    cv::putText(display, info, cv::Point(10, 30), 
+                               cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 255, 0), 2);
+                }
+                drawLatencyOverlay(display);
+                display_thread->show(display);
+            }
             
-            cv::imshow("Dataset Collection", display);
-            char key = cv::waitKey(1);
+            int key = control.poll();
 
             if (key == ' ') {  // Spacebar
-                saveFrame(frame);
+                saveFrame(frame, depth);
                 std::this_thread::sleep_for(std::chrono::milliseconds(500));
             }
-            else if (key == 'q') {
+            else if (key == 'q' || key == 27) {
                 break;
             }
         }
         
-        cv::destroyAllWindows();
         createTrainValidLists();
     }
 
 private:
-    void saveFrame(const cv::Mat& frame) {
-        // Determine if this frame goes to train or valid (80/20 split)
-        std::string subset = (frame_count % 5 == 0) ? "valid" : "train";
+    void saveFrame(const cv::Mat& frame, const cv::Mat& depth = cv::Mat()) {
+        // Frames are stored under train/; the train/valid assignment is
+        // made by createTrainValidLists over whole windows of frames
+        std::string subset = "train";
         
         // Generate filename
         std::stringstream ss;
         ss << frame_count << ".jpg";
         std::string filename = ss.str();
 
-        // Save image
-        cv::imwrite(images_path + "/" + subset + "/" + filename, frame);
+        // Save image, encoding and writing timed separately. Depth uses the
+        // lossless .zdepth codec, PNG-16 is too slow to keep up at 30 FPS
+        std::vector<uchar> encoded;
+        std::vector<uchar> encoded_depth;
+        {
+            ScopedTimer timer(Stage::Encode);
+            cv::imencode(".jpg", frame, encoded);
+            if (!depth.empty()) {
+                encodeDepth(depth, encoded_depth);
+            }
+        }
+        {
+            ScopedTimer timer(Stage::DiskWrite);
+            std::ofstream(images_path + "/" + subset + "/" + filename, std::ios::binary)
+                .write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            if (!encoded_depth.empty()) {
+                std::ofstream(depth_path + "/" + subset + "/" + std::to_string(frame_count) +
+                              kDepthFileExtension, std::ios::binary)
+                    .write(reinterpret_cast<const char*>(encoded_depth.data()), encoded_depth.size());
+            }
 
-        // Create empty label file
-        std::ofstream label_file(labels_path + "/" + subset + "/" + 
-                               std::to_string(frame_count) + ".txt");
-        label_file.close();
+            // Create empty label file
+            std::ofstream label_file(labels_path + "/" + subset + "/" + 
+                                   std::to_string(frame_count) + ".txt");
+            label_file.close();
+        }
 
         frame_count++;
         std::cout << "Saved frame " << frame_count << " to " << subset << " set\n";
     }
 
     void createTrainValidLists() {
-        // Create train.txt and valid.txt
-        createImageList("train");
-        createImageList("valid");
-    }
-
-    void createImageList(const std::string& subset) {
-        std::string list_file = dataset_path + "/" + subset + ".txt";
-        std::ofstream ofs(list_file);
-        
-        for (const auto& entry : fs::directory_iterator(images_path + "/" + subset)) {
-            if (entry.path().extension() == ".jpg") {
-                ofs << fs::absolute(entry.path()).string() << "\n";
-            }
+        // Create train.txt and valid.txt (80/20). Consecutive frames are
+        // near-identical, so windows of frames go to one subset together;
+        // rerun SplitDataset after labeling for a class-stratified split
+        SplitConfig config;
+        config.group = SplitGroup::FrameWindow;
+        DatasetSplitter splitter(dataset_path + "/train.txt", dataset_path + "/valid.txt", config);
+        for (const auto& image_path : listImagesInFrameOrder(images_path)) {
+            splitter.add(image_path, readYoloLabels(labelPathForImage(image_path)));
         }
-        ofs.close();
+        splitter.finish();
+        std::cout << "Split: " << splitter.stats().images[0] << " train, "
+                  << splitter.stats().images[1] << " valid\n";
     }
 
 public:
@@ -198,14 +259,26 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        // --headless runs without a preview window (default when no display is available),
+        // --depth also saves the aligned depth of every frame (.zdepth)
+        bool headless = !displayAvailable();
+        bool with_depth = false;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string(argv[i]) == "--headless") headless = true;
+            if (std::string(argv[i]) == "--depth") with_depth = true;
+        }
+
+        // PERF_STATS=<file> enables capture/encode/write latency stats
+        auto latency_reporter = startInstrumentationFromEnv();
+
         std::string dataset_path = "darknet_dataset_Capture";
-        DatasetCollector collector(dataset_path);
+        DatasetCollector collector(dataset_path, 640, 480, with_depth);
 
         // Collect images
         int num_frames = 100;  // Change this to desired number of frames
-        collector.collectDataset(num_frames);
+        collector.collectDataset(num_frames, !headless);
 
         std::cout << "\nDataset collection complete. Next steps:\n";
         std::cout << "1. Use a labeling tool to annotate images\n";
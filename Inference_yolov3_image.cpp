@@ -1,55 +1,40 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include "model_session.h"
+#include "instrumentation.h"
+#include "overlay_renderer.h"
+#include "ui_control.h"
 #include <iostream>
 #include <vector>
 #include <fstream>
+#include <memory>
 
 class YoloDetector {
 private:
-    cv::dnn::Net net;
+    std::unique_ptr<ModelSession> session;
+    OverlayRenderer renderer;
     float confThreshold;
     float nmsThreshold;
     
     void postprocess(cv::Mat& frame, const std::vector<cv::Mat>& outs);
-    std::vector<std::string> getOutputsNames();
 
 public:
     YoloDetector(const std::string& modelPath, 
                  const std::string& configPath,
                  float confidenceThreshold = 0.5,
                  float nmsThreshold = 0.4) {
-        // Check if files exist
-        std::ifstream modelFile(modelPath);
-        if (!modelFile.good()) {
-            throw std::runtime_error("Cannot open weights file: " + modelPath);
-        }
+        std::cout << "Loading YOLOv3 network...\n";
+        std::cout << "Config: " << configPath << "\n";
+        std::cout << "Weights: " << modelPath << "\n";
         
-        std::ifstream configFile(configPath);
-        if (!configFile.good()) {
-            throw std::runtime_error("Cannot open config file: " + configPath);
-        }
-
-        try {
-            std::cout << "Loading YOLOv3 network...\n";
-            std::cout << "Config: " << configPath << "\n";
-            std::cout << "Weights: " << modelPath << "\n";
-            
-            net = cv::dnn::readNetFromDarknet(configPath, modelPath);
-            if (net.empty()) {
-                throw std::runtime_error("Failed to create network");
-            }
-            
-            net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-            net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-            
-            this->confThreshold = confidenceThreshold;
-            this->nmsThreshold = nmsThreshold;
-            
-            std::cout << "Network loaded successfully\n";
-        }
-        catch (const cv::Exception& e) {
-            throw std::runtime_error("Failed to load the network: " + std::string(e.what()));
-        }
+        // The session checks the files, loads the net and resolves the
+        // output layers once; it throws std::runtime_error on failure
+        session = std::make_unique<ModelSession>(configPath, modelPath);
+        
+        this->confThreshold = confidenceThreshold;
+        this->nmsThreshold = nmsThreshold;
+        
+        std::cout << "Network loaded successfully\n";
     }
 
     cv::Mat detect(const cv::Mat& frame);
@@ -57,22 +42,14 @@ public:
 
 // Detect method implementation
 cv::Mat YoloDetector::detect(const cv::Mat& frame) {
-    cv::Mat blob;
     cv::Mat processedFrame = frame.clone();
     
     try {
-        // Create a 4D blob from a frame
-        cv::dnn::blobFromImage(frame, blob, 1/255.0, 
-                              cv::Size(416, 416), 
-                              cv::Scalar(0,0,0), 
-                              true, false);
-        
-        // Sets the input to the network
-        net.setInput(blob);
+        // Create a 4D blob from a frame in the session's input buffer
+        session->preprocess(frame);
         
         // Runs the forward pass to get output of the output layers
-        std::vector<cv::Mat> outs;
-        net.forward(outs, getOutputsNames());
+        const std::vector<cv::Mat>& outs = session->forward();
         
         // Remove the bounding boxes with low confidence
         postprocess(processedFrame, outs);
@@ -90,72 +67,54 @@ void YoloDetector::postprocess(cv::Mat& frame, const std::vector<cv::Mat>& outs)
     std::vector<float> confidences;
     std::vector<cv::Rect> boxes;
     
-    for (const auto& out : outs) {
-        float* data = (float*)out.data;
-        for (int j = 0; j < out.rows; ++j, data += out.cols) {
-            float confidence = data[4];  // Object confidence
+    {
+        ScopedTimer timer(Stage::Decode);
+        for (const auto& out : outs) {
+            float* data = (float*)out.data;
+            for (int j = 0; j < out.rows; ++j, data += out.cols) {
+                float confidence = data[4];  // Object confidence
             
-            // For single class, we only need to check the first class probability
-            float classProb = data[5];
-            confidence *= classProb;
+                // For single class, we only need to check the first class probability
+                float classProb = data[5];
+                confidence *= classProb;
             
-            if (confidence > confThreshold) {
-                int centerX = (int)(data[0] * frame.cols);
-                int centerY = (int)(data[1] * frame.rows);
-                int width = (int)(data[2] * frame.cols);
-                int height = (int)(data[3] * frame.rows);
-                int left = centerX - width / 2;
-                int top = centerY - height / 2;
+                if (confidence > confThreshold) {
+                    int centerX = (int)(data[0] * frame.cols);
+                    int centerY = (int)(data[1] * frame.rows);
+                    int width = (int)(data[2] * frame.cols);
+                    int height = (int)(data[3] * frame.rows);
+                    int left = centerX - width / 2;
+                    int top = centerY - height / 2;
                 
-                confidences.push_back(confidence);
-                boxes.push_back(cv::Rect(left, top, width, height));
+                    confidences.push_back(confidence);
+                    boxes.push_back(cv::Rect(left, top, width, height));
+                }
             }
         }
     }
     
-    // Perform non maximum suppression to eliminate redundant overlapping boxes
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
+    {
+        ScopedTimer timer(Stage::Nms);
+        // Perform non maximum suppression to eliminate redundant overlapping boxes
+        cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
+    }
     
     // Draw Bounding boxes
+    ScopedTimer timer(Stage::Draw);
+    TextStyle style;
+    style.color = cv::Scalar(0, 0, 0);
+    style.background = cv::Scalar(255, 255, 255);
+    
+    renderer.begin(frame.size());
     for (size_t i = 0; i < indices.size(); ++i) {
         int idx = indices[i];
-        cv::Rect box = boxes[idx];
-        
-        // Draw a rectangle displaying the bounding box
-        cv::rectangle(frame, box, cv::Scalar(0, 255, 0), 3);
-        
-        // Display confidence score
-        std::string label = cv::format("Confidence: %.2f", confidences[idx]);
-        
-        // Display the label at the top of the bounding box
-        int baseLine;
-        cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
-                                           0.5, 1, &baseLine);
-        cv::rectangle(frame, 
-                     cv::Point(box.x, box.y - labelSize.height),
-                     cv::Point(box.x + labelSize.width, box.y + baseLine),
-                     cv::Scalar(255, 255, 255), 
-                     cv::FILLED);
-        cv::putText(frame, label, 
-                   cv::Point(box.x, box.y),
-                   cv::FONT_HERSHEY_SIMPLEX, 
-                   0.5, cv::Scalar(0, 0, 0));
-    }
-}
-
-// GetOutputsNames method implementation
-std::vector<std::string> YoloDetector::getOutputsNames() {
-    static std::vector<std::string> names;
-    if (names.empty()) {
-        std::vector<int> outLayers = net.getUnconnectedOutLayers();
-        std::vector<std::string> layersNames = net.getLayerNames();
-        names.resize(outLayers.size());
-        for (size_t i = 0; i < outLayers.size(); ++i) {
-            names[i] = layersNames[outLayers[i] - 1];
-        }
+        
+        // Box with "Confidence: 0.87" on top; label bitmaps are cached
+        renderer.addLabeledBox(boxes[idx], "Confidence: " + confidenceText(confidences[idx]),
+                               cv::Scalar(0, 255, 0), style, 3);
     }
-    return names;
+    renderer.compose(frame);
 }
 
 // No Image path added at the running
@@ -205,15 +164,19 @@ std::vector<std::string> YoloDetector::getOutputsNames() {
 int main(int argc, char** argv) {
     try {
         // Check if image path is provided as command line argument
-        if (argc != 2) {
-            std::cerr << "Usage: " << argv[0] << " <image_path>\n";
+        if (argc != 2 && argc != 3) {
+            std::cerr << "Usage: " << argv[0] << " <image_path> [output_image]\n";
             std::cerr << "Example: " << argv[0] << " /path/to/image.jpg\n";
+            std::cerr << "With an output path (or without a display) the result is saved, not shown\n";
             return -1;
         }
 
         std::string imagePath = argv[1];
         std::cout << "Starting YOLOv3 detection program...\n";
         
+        // PERF_STATS=<file> turns on stage timing, written when the program exits
+        auto latencyReporter = startInstrumentationFromEnv();
+        
         // Model paths remain constant
         std::string modelPath = "/home/thornch/Documents/YOLOv3_custom_data_and_onnx/yolov3_darknet_kimbap/darknet/backup/yolov3-kimbap_3000.weights";
         std::string configPath = "/home/thornch/Documents/YOLOv3_custom_data_and_onnx/yolov3_darknet_kimbap/darknet/cfg/yolov3-kimbap.cfg";
@@ -237,6 +200,14 @@ int main(int argc, char** argv) {
         // Perform detection
         cv::Mat result = detector.detect(frame);
         
+        // Save the result on headless machines, show it otherwise
+        if (argc == 3 || !displayAvailable()) {
+            std::string outputPath = argc == 3 ? argv[2] : "detection_result.jpg";
+            cv::imwrite(outputPath, result);
+            std::cout << "Detection completed. Result saved to: " << outputPath << "\n";
+            return 0;
+        }
+        
         std::cout << "Detection completed. Showing results...\n";
         
         // Show result
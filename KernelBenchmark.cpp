@@ -0,0 +1,576 @@
+#include "micro_benchmark.h"
+#include "image_augmentation.h"
+#include "image_similarity.h"
+#include "yolo_detection.h"
+#include "yolo_labels.h"
+#include "roi.h"
+#include "overlay_renderer.h"
+#include "object_localization.h"
+#include "depth_filters.h"
+#include "depth_codec.h"
+#include "thumbnail_cache.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Micro-benchmarks of the per-frame kernels: preprocessing, YOLO decoding,
+// NMS, SSIM dedup, every augmentation branch, ROIBox operations, label
+// writing, thumbnail decoding, per-detection depth localization, the depth
+// filter chain and the depth codec. Everything runs offline on fixtures
+// generated from a fixed seed (plus optional sample images), with OpenCV
+// pinned to --threads threads, so runs are comparable across changes.
+// Results are written as Google Benchmark compatible JSON (compare.py
+// works on two result files).
+
+struct Fixture {
+    std::string name;
+    cv::Mat image;
+};
+
+// Gradient background with random filled shapes and mild noise, so filters
+// and codecs see something closer to a camera frame than uniform noise
+cv::Mat syntheticImage(int width, int height, uint64_t seed) {
+    cv::RNG rng(seed);
+    cv::Mat img(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        cv::Vec3b* row = img.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = cv::Vec3b((uchar)(x * 255 / width), (uchar)(y * 255 / height), 128);
+        }
+    }
+    for (int i = 0; i < 40; ++i) {
+        cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        cv::Point p(rng.uniform(0, width), rng.uniform(0, height));
+        if (i % 2) {
+            cv::circle(img, p, rng.uniform(5, height / 6), color, cv::FILLED);
+        } else {
+            cv::rectangle(img, cv::Rect(p.x, p.y, rng.uniform(10, width / 4),
+                                        rng.uniform(10, height / 4)), color, cv::FILLED);
+        }
+    }
+    cv::Mat noise(img.size(), img.type());
+    cv::theRNG().state = seed;
+    cv::randn(noise, 0, 8);
+    return img + noise;
+}
+
+// YOLOv3-416 shaped heads (13/26/52 grids x 3 anchors, 80 classes). Most rows
+// are background; numObjects objects each fire on a few neighbouring rows.
+std::vector<cv::Mat> syntheticYoloOutputs(int numObjects, uint64_t seed) {
+    const int numClasses = 80;
+    cv::RNG rng(seed);
+    std::vector<cv::Mat> outs;
+    for (int grid : {13, 26, 52}) {
+        cv::Mat out(grid * grid * 3, 5 + numClasses, CV_32F);
+        for (int r = 0; r < out.rows; ++r) {
+            float* row = out.ptr<float>(r);
+            for (int c = 0; c < 4; ++c) row[c] = rng.uniform(0.0f, 1.0f);
+            row[4] = rng.uniform(0.0f, 0.05f);
+            for (int c = 5; c < out.cols; ++c) row[c] = rng.uniform(0.0f, 0.1f);
+        }
+        outs.push_back(out);
+    }
+    for (int i = 0; i < numObjects; ++i) {
+        cv::Mat& out = outs[rng.uniform(0, (int)outs.size())];
+        float cx = rng.uniform(0.1f, 0.9f), cy = rng.uniform(0.1f, 0.9f);
+        float w = rng.uniform(0.05f, 0.3f), h = rng.uniform(0.05f, 0.3f);
+        int cls = rng.uniform(0, numClasses);
+        int first = rng.uniform(0, out.rows - 4);
+        for (int k = 0; k < 4; ++k) {
+            float* row = out.ptr<float>(first + k);
+            row[0] = cx + rng.uniform(-0.01f, 0.01f);
+            row[1] = cy + rng.uniform(-0.01f, 0.01f);
+            row[2] = w;
+            row[3] = h;
+            row[4] = rng.uniform(0.7f, 1.0f);
+            row[5 + cls] = rng.uniform(0.7f, 1.0f);
+        }
+    }
+    return outs;
+}
+
+std::vector<Detection> randomDetections(int count, const cv::Size& frameSize, uint64_t seed) {
+    cv::RNG rng(seed);
+    std::vector<Detection> detections;
+    for (int i = 0; i < count; ++i) {
+        Detection det;
+        int w = rng.uniform(10, frameSize.width / 4);
+        int h = rng.uniform(10, frameSize.height / 4);
+        det.box = cv::Rect(rng.uniform(0, frameSize.width - w), rng.uniform(0, frameSize.height - h), w, h);
+        det.confidence = rng.uniform(0.3f, 1.0f);
+        det.runner_up = 0.0f;
+        det.class_id = rng.uniform(0, 80);
+        detections.push_back(det);
+    }
+    return detections;
+}
+
+std::vector<Fixture> loadFixtures(const std::string& imageDir, uint64_t seed) {
+    std::vector<Fixture> fixtures = {
+        {"synthetic_640x480", syntheticImage(640, 480, seed)},
+        {"synthetic_1280x720", syntheticImage(1280, 720, seed + 1)},
+    };
+    if (imageDir.empty()) return fixtures;
+
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::directory_iterator(imageDir)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png") paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+    for (size_t i = 0; i < paths.size() && i < 2; ++i) {
+        cv::Mat img = cv::imread(paths[i].string());
+        if (!img.empty()) {
+            fixtures.push_back({"sample_" + paths[i].stem().string(), img});
+        }
+    }
+    return fixtures;
+}
+
+void registerBenchmarks(BenchmarkSuite& suite, const std::vector<Fixture>& fixtures,
+                        uint64_t seed, const std::string& scratchDir) {
+    const cv::Size inputSize(416, 416);
+
+    for (const auto& fixture : fixtures) {
+        cv::Mat img = fixture.image;
+
+        suite.add("preprocess/blobFromImage/" + fixture.name, [img, inputSize](BenchmarkState& state) {
+            cv::Mat blob;
+            while (state.keepRunning()) {
+                cv::dnn::blobFromImage(img, blob, 1/255.0, inputSize,
+                                       cv::Scalar(0,0,0), true, false, CV_32F);
+                doNotOptimize(blob.data);
+            }
+            state.setItemsProcessed(state.iterations());
+        });
+
+        suite.add("ssim/" + fixture.name, [img](BenchmarkState& state) {
+            cv::Mat other = augmentBrightness(img);
+            while (state.keepRunning()) {
+                double ssim = computeSSIM(img, other);
+                doNotOptimize(ssim);
+            }
+        });
+
+        for (const auto& branch : augmentationBranches()) {
+            auto apply = branch.apply;
+            suite.add("augment/" + branch.name + "/" + fixture.name, [img, apply, seed](BenchmarkState& state) {
+                cv::theRNG().state = seed;
+                while (state.keepRunning()) {
+                    cv::Mat out = apply(img);
+                    doNotOptimize(out.data);
+                }
+            });
+        }
+    }
+
+    cv::Mat frame = fixtures.front().image;
+    suite.add("preprocess/blobFromImages_batch8", [frame, inputSize](BenchmarkState& state) {
+        std::vector<cv::Mat> batch(8, frame);
+        cv::Mat blob;
+        while (state.keepRunning()) {
+            cv::dnn::blobFromImages(batch, blob, 1/255.0, inputSize,
+                                    cv::Scalar(0,0,0), true, false, CV_32F);
+            doNotOptimize(blob.data);
+        }
+        state.setItemsProcessed(state.iterations() * 8);
+    });
+
+    auto outs = std::make_shared<std::vector<cv::Mat>>(syntheticYoloOutputs(30, seed));
+    size_t totalRows = 0;
+    for (const auto& out : *outs) totalRows += out.rows;
+    for (float threshold : {0.5f, 0.01f}) {
+        std::string name = threshold >= 0.5f ? "yolo/decode_conf0.5" : "yolo/decode_conf0.01";
+        suite.add(name, [outs, frame, threshold, totalRows](BenchmarkState& state) {
+            while (state.keepRunning()) {
+                auto detections = decodeYoloOutputs(*outs, frame.size(), threshold, {});
+                doNotOptimize(detections);
+            }
+            state.setItemsProcessed(state.iterations() * totalRows);
+        });
+    }
+
+    auto decoded = std::make_shared<std::vector<Detection>>(
+        decodeYoloOutputs(*outs, frame.size(), 0.25f, {}));
+    auto dense = std::make_shared<std::vector<Detection>>(randomDetections(2000, frame.size(), seed));
+    for (const auto& [name, input] : {std::make_pair(std::string("nms/decoded"), decoded),
+                                      std::make_pair(std::string("nms/dense_2000"), dense)}) {
+        auto candidates = input;
+        suite.add(name, [candidates](BenchmarkState& state) {
+            while (state.keepRunning()) {
+                auto kept = suppressDetections(*candidates, 0.25f, 0.4f);
+                doNotOptimize(kept);
+            }
+            state.setItemsProcessed(state.iterations() * candidates->size());
+        });
+    }
+
+    ROIBox roi(frame.cols / 4, frame.rows / 4, frame.cols / 2, frame.rows / 2);
+    auto rects = std::make_shared<std::vector<cv::Rect>>();
+    for (const auto& det : *dense) rects->push_back(det.box);
+
+    suite.add("roi/extractROI", [roi, frame](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            cv::Mat crop = roi.extractROI(frame);
+            doNotOptimize(crop.data);
+        }
+    });
+    suite.add("roi/clipRectToROI_2000", [roi, rects](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            for (const auto& rect : *rects) {
+                cv::Rect clipped = roi.clipRectToROI(rect);
+                doNotOptimize(clipped);
+            }
+        }
+        state.setItemsProcessed(state.iterations() * rects->size());
+    });
+    suite.add("roi/view", [roi, frame](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            cv::Mat view = roi.view(frame);
+            doNotOptimize(view.data);
+        }
+    });
+    suite.add("roi/copyTo_preallocated", [roi, frame](BenchmarkState& state) {
+        cv::Mat buffer;
+        while (state.keepRunning()) {
+            roi.copyTo(frame, buffer);
+            doNotOptimize(buffer.data);
+        }
+    });
+    suite.add("roi/clipRectsToROI_2000", [roi, rects](BenchmarkState& state) {
+        std::vector<cv::Rect> clipped;
+        while (state.keepRunning()) {
+            roi.clipRectsToROI(*rects, clipped);
+            doNotOptimize(clipped);
+        }
+        state.setItemsProcessed(state.iterations() * rects->size());
+    });
+    suite.add("roi/isWithinFrame", [roi, frame](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            bool inside = roi.isWithinFrame(frame);
+            doNotOptimize(inside);
+        }
+    });
+    ROISet zones(frame.size());
+    zones.addROI(roi);
+    zones.addPolygon({cv::Point(20, 20), cv::Point(frame.cols / 3, 40),
+                      cv::Point(frame.cols / 4, frame.rows / 2), cv::Point(30, frame.rows / 3)});
+    zones.build();
+    suite.add("roi/ROISet_filterByCenter_2000", [zones, rects](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            auto kept = zones.filterByCenter(*rects);
+            doNotOptimize(kept);
+        }
+        state.setItemsProcessed(state.iterations() * rects->size());
+    });
+    suite.add("roi/ROISet_filterByOverlap_2000", [zones, rects](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            auto kept = zones.filterByOverlap(*rects, 0.5);
+            doNotOptimize(kept);
+        }
+        state.setItemsProcessed(state.iterations() * rects->size());
+    });
+    suite.add("roi/draw", [roi, frame](BenchmarkState& state) {
+        cv::Mat canvas = frame.clone();
+        while (state.keepRunning()) {
+            roi.draw(canvas);
+        }
+    });
+
+    auto shown = std::make_shared<std::vector<Detection>>(randomDetections(200, frame.size(), seed + 3));
+    for (auto& det : *shown) det.class_name = "class" + std::to_string(det.class_id);
+    suite.add("draw/overlay_200", [shown, frame](BenchmarkState& state) {
+        OverlayRenderer renderer;
+        cv::Mat display = frame.clone();
+        while (state.keepRunning()) {
+            renderer.begin(display.size());
+            for (const auto& det : *shown) renderer.addDetection(det);
+            renderer.compose(display);
+        }
+        state.setItemsProcessed(state.iterations() * shown->size());
+    });
+
+    auto labels = std::make_shared<std::vector<Detection>>(randomDetections(20, frame.size(), seed + 2));
+    std::string labelPath = (fs::path(scratchDir) / "bench_labels.txt").string();
+    suite.add("labels/writeYoloLabels_20", [labels, frame, labelPath](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            writeYoloLabels(labelPath, *labels, frame.size());
+        }
+        state.setItemsProcessed(state.iterations() * labels->size());
+    });
+
+    // Dataset scans: full decode vs DCT-scaled decode vs a cached thumbnail
+    std::string jpegPath = (fs::path(scratchDir) / "bench_frame.jpg").string();
+    cv::imwrite(jpegPath, frame);
+    suite.add("thumbnail/imread_full", [jpegPath](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            cv::Mat img = cv::imread(jpegPath);
+            doNotOptimize(img);
+        }
+    });
+    suite.add("thumbnail/imread_reduced_gray_4", [jpegPath](BenchmarkState& state) {
+        while (state.keepRunning()) {
+            cv::Mat img = cv::imread(jpegPath, cv::IMREAD_REDUCED_GRAYSCALE_4);
+            doNotOptimize(img);
+        }
+    });
+    std::string thumbnailDir = (fs::path(scratchDir) / "thumbnails").string();
+    suite.add("thumbnail/cache_hit_gray_4", [jpegPath, thumbnailDir](BenchmarkState& state) {
+        ThumbnailCache cache(thumbnailDir);
+        cache.get(jpegPath, 4, true);
+        while (state.keepRunning()) {
+            cv::Mat img = cache.get(jpegPath, 4, true);
+            doNotOptimize(img);
+        }
+    });
+}
+
+// Depth scene for the localizer: a tilted background wall, objects at
+// closer depths inside their boxes, holes (0) and sensor noise
+struct DepthFixture {
+    std::string name;
+    cv::Mat depth;
+    CameraIntrinsics intrinsics;
+    float depthScale;
+    std::vector<Detection> detections;
+};
+
+DepthFixture syntheticDepth(int width, int height, int numObjects, uint64_t seed) {
+    cv::RNG rng(seed);
+    DepthFixture fixture;
+    fixture.name = "synthetic_" + std::to_string(width) + "x" + std::to_string(height);
+    fixture.depthScale = 0.001f;
+    fixture.intrinsics.width = width;
+    fixture.intrinsics.height = height;
+    fixture.intrinsics.fx = fixture.intrinsics.fy = 0.9f * width;
+    fixture.intrinsics.ppx = width / 2.0f;
+    fixture.intrinsics.ppy = height / 2.0f;
+
+    fixture.depth.create(height, width, CV_16U);
+    for (int y = 0; y < height; ++y) {
+        ushort* row = fixture.depth.ptr<ushort>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = (ushort)(3000 + x / 2);
+        }
+    }
+    fixture.detections = randomDetections(numObjects, cv::Size(width, height), seed + 1);
+    for (const auto& det : fixture.detections) {
+        // Object fills the middle of its box, the edges show the wall
+        cv::Rect body(det.box.x + det.box.width / 6, det.box.y + det.box.height / 6,
+                      det.box.width * 2 / 3, det.box.height * 2 / 3);
+        fixture.depth(body).setTo(cv::Scalar(rng.uniform(600, 2500)));
+    }
+    cv::Mat noise(height, width, CV_16S);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 8);
+    cv::add(fixture.depth, noise, fixture.depth, cv::noArray(), CV_16U);
+    for (int i = 0; i < width * height / 50; ++i) {
+        fixture.depth.at<ushort>(rng.uniform(0, height), rng.uniform(0, width)) = 0;
+    }
+    return fixture;
+}
+
+// First recorded frame of a dataset written by ImageCaptureAnnotate --depth:
+// <dir>/intrinsics.yml, <dir>/depth/train/<n>.zdepth (or 16-bit .png),
+// <dir>/labels/train/<n>.txt
+bool loadRecordedDepth(const std::string& datasetDir, DepthFixture& fixture) {
+    fs::path dir(datasetDir);
+    if (!fs::is_directory(dir / "depth" / "train")) return false;
+    std::vector<fs::path> depthPaths;
+    for (const auto& entry : fs::directory_iterator(dir / "depth" / "train")) {
+        std::string ext = entry.path().extension().string();
+        if (ext == kDepthFileExtension || ext == ".png") depthPaths.push_back(entry.path());
+    }
+    if (depthPaths.empty()) return false;
+    std::sort(depthPaths.begin(), depthPaths.end());
+
+    fixture.name = "recorded_" + depthPaths[0].stem().string();
+    fixture.intrinsics = loadIntrinsics((dir / "intrinsics.yml").string());
+    fixture.depthScale = loadDepthScale((dir / "intrinsics.yml").string());
+    fixture.depth = readDepthImage(depthPaths[0].string());
+
+    std::ifstream labels(dir / "labels" / "train" / (depthPaths[0].stem().string() + ".txt"));
+    YoloLabel label;
+    while (labels >> label.class_id >> label.x_center >> label.y_center >> label.width >> label.height) {
+        Detection det;
+        det.box = cv::Rect((int)((label.x_center - label.width / 2) * fixture.depth.cols),
+                           (int)((label.y_center - label.height / 2) * fixture.depth.rows),
+                           (int)(label.width * fixture.depth.cols),
+                           (int)(label.height * fixture.depth.rows));
+        det.confidence = 1.0f;
+        det.runner_up = 0.0f;
+        det.class_id = label.class_id;
+        fixture.detections.push_back(det);
+    }
+    return !fixture.detections.empty();
+}
+
+void registerDepthBenchmarks(BenchmarkSuite& suite, uint64_t seed, const std::string& recordingDir) {
+    std::vector<DepthFixture> fixtures = {syntheticDepth(1280, 720, 8, seed + 4)};
+    DepthFixture recorded;
+    if (!recordingDir.empty() && loadRecordedDepth(recordingDir, recorded)) {
+        fixtures.push_back(recorded);
+    }
+
+    for (const auto& fixture : fixtures) {
+        auto shared = std::make_shared<DepthFixture>(fixture);
+        std::string suffix = fixture.name + "_" + std::to_string(fixture.detections.size()) + "boxes";
+        suite.add("depth/localize/" + suffix, [shared](BenchmarkState& state) {
+            ObjectLocalizer localizer(shared->intrinsics, shared->depthScale);
+            while (state.keepRunning()) {
+                auto positions = localizer.localize(shared->depth, shared->detections);
+                doNotOptimize(positions);
+            }
+            state.setItemsProcessed(state.iterations() * shared->detections.size());
+        });
+    }
+
+    // D4xx high-quality depth mode; frames alternate so the temporal
+    // filter sees changing input rather than a static frame
+    auto frames = std::make_shared<std::vector<cv::Mat>>();
+    for (int i = 0; i < 2; ++i) {
+        frames->push_back(syntheticDepth(848, 480, 8, seed + 5 + i).depth);
+    }
+    for (int decimation : {1, 2}) {
+        suite.add("depth/filter_chain_848x480_dec" + std::to_string(decimation),
+                  [frames, decimation](BenchmarkState& state) {
+            DepthFilterConfig config;
+            config.decimation = decimation;
+            DepthFilterChain chain(config);
+            size_t i = 0;
+            while (state.keepRunning()) {
+                const cv::Mat& filtered = chain.process((*frames)[i++ % frames->size()]);
+                doNotOptimize(filtered);
+            }
+            state.setItemsProcessed(state.iterations());
+        });
+    }
+
+    // Lossless storage of one frame; PNG-16 is the baseline it replaces
+    std::vector<std::pair<std::string, cv::Mat>> codecFrames = {{"synthetic_848x480", (*frames)[0]}};
+    if (fixtures.size() > 1) {
+        codecFrames.push_back({recorded.name, recorded.depth});
+    }
+    for (const auto& [suffix, frame] : codecFrames) {
+        auto depth = std::make_shared<cv::Mat>(frame);
+        suite.add("depth/codec_encode/" + suffix, [depth](BenchmarkState& state) {
+            std::vector<uchar> encoded;
+            while (state.keepRunning()) {
+                encodeDepth(*depth, encoded);
+                doNotOptimize(encoded);
+            }
+            state.setItemsProcessed(state.iterations());
+        });
+        suite.add("depth/codec_decode/" + suffix, [depth](BenchmarkState& state) {
+            std::vector<uchar> encoded;
+            encodeDepth(*depth, encoded);
+            cv::Mat decoded;
+            while (state.keepRunning()) {
+                decodeDepth(encoded.data(), encoded.size(), decoded);
+                doNotOptimize(decoded);
+            }
+            state.setItemsProcessed(state.iterations());
+        });
+        suite.add("depth/png16_encode/" + suffix, [depth](BenchmarkState& state) {
+            std::vector<uchar> encoded;
+            while (state.keepRunning()) {
+                cv::imencode(".png", *depth, encoded);
+                doNotOptimize(encoded);
+            }
+            state.setItemsProcessed(state.iterations());
+        });
+    }
+}
+
+std::string currentDate() {
+    std::time_t now = std::time(nullptr);
+    std::ostringstream ss;
+    ss << std::put_time(std::localtime(&now), "%Y-%m-%dT%H:%M:%S");
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string imageDir;
+    std::string jsonPath = "kernel_benchmark.json";
+    std::string filter;
+    double minTime = 0.5;
+    int repetitions = 5;
+    int threads = 1;
+    uint64_t seed = 42;
+    std::string recordingDir;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--images") imageDir = value;
+        else if (arg == "--json") jsonPath = value;
+        else if (arg == "--filter") filter = value;
+        else if (arg == "--min-time") minTime = std::stod(value);
+        else if (arg == "--repetitions") repetitions = std::max(1, std::stoi(value));
+        else if (arg == "--threads") threads = std::stoi(value);
+        else if (arg == "--seed") seed = std::stoull(value);
+        else if (arg == "--recording") recordingDir = value;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--images dir] [--json out.json] [--filter substr]\n"
+                      << "       [--min-time 0.5] [--repetitions 5] [--threads 1] [--seed 42]\n"
+                      << "       [--recording dataset_dir]\n";
+            return -1;
+        }
+    }
+
+    try {
+        // A fixed thread count keeps results comparable between machines/runs
+        cv::setNumThreads(threads);
+
+        std::vector<Fixture> fixtures = loadFixtures(imageDir, seed);
+        std::string scratchDir = (fs::temp_directory_path() / "kernel_benchmark").string();
+        fs::create_directories(scratchDir);
+
+        BenchmarkSuite suite;
+        registerBenchmarks(suite, fixtures, seed, scratchDir);
+        registerDepthBenchmarks(suite, seed, recordingDir);
+        suite.run(minTime, repetitions, filter);
+
+        char host[256] = {0};
+        gethostname(host, sizeof(host) - 1);
+        std::ostringstream fixtureNames;
+        for (size_t i = 0; i < fixtures.size(); ++i) {
+            fixtureNames << (i ? "," : "") << fixtures[i].name;
+        }
+
+        std::map<std::string, std::string> context = {
+            {"date", currentDate()},
+            {"host_name", host},
+            {"executable", argv[0]},
+            {"num_cpus", std::to_string(cv::getNumberOfCPUs())},
+            {"opencv_version", CV_VERSION},
+            {"opencv_threads", std::to_string(threads)},
+            {"seed", std::to_string(seed)},
+            {"fixtures", fixtureNames.str()},
+#ifdef NDEBUG
+            {"library_build_type", "release"},
+#else
+            {"library_build_type", "debug"},
+#endif
+        };
+        suite.writeJson(jsonPath, context);
+        fs::remove_all(scratchDir);
+
+        std::cout << "\nResults written to: " << jsonPath << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
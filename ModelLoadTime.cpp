@@ -0,0 +1,88 @@
+#include "instrumentation.h"
+#include "model_cache.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Measures model startup time: plain readNetFromDarknet() against a cold
+// (cache build) and warm (memory-mapped) load through ModelCache. Each
+// variant is timed up to the first forward pass, since that is what a tool
+// waits for before it can process a frame.
+
+double firstForwardMs(cv::dnn::Net& net, const cv::Mat& blob) {
+    auto start = std::chrono::steady_clock::now();
+    net.setInput(blob);
+    std::vector<cv::Mat> outs;
+    net.forward(outs, net.getUnconnectedOutLayersNames());
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <model.cfg> <model.weights> [cache_dir] [runs] [size]\n";
+        std::cerr << "Example: " << argv[0] << " yolov3.cfg yolov3.weights model_cache 5 416\n";
+        return -1;
+    }
+
+    std::string cfgPath = argv[1];
+    std::string weightsPath = argv[2];
+    std::string cacheDir = argc > 3 ? argv[3] : "model_cache";
+    int runs = argc > 4 ? std::max(1, std::stoi(argv[4])) : 5;
+    int size = argc > 5 ? std::stoi(argv[5]) : 416;
+
+    try {
+        cv::Mat image(size, size, CV_8UC3, cv::Scalar(114, 114, 114));
+        cv::Mat blob = cv::dnn::blobFromImage(image, 1 / 255.0, cv::Size(size, size),
+                                              cv::Scalar(), true, false);
+        ModelCache cache(cacheDir);
+
+        std::vector<double> plainLoad, plainFirst, cachedLoad, cachedFirst;
+        double coldMs = -1.0;
+
+        for (int run = 0; run < runs; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            cv::dnn::Net plain = cv::dnn::readNetFromDarknet(cfgPath, weightsPath);
+            plainLoad.push_back(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count());
+            plainFirst.push_back(firstForwardMs(plain, blob));
+
+            cv::dnn::Net cached = cache.loadDarknet(cfgPath, weightsPath);
+            if (!cache.lastLoadWasHit()) {
+                // The cold build is reported on its own, not mixed into the warm numbers
+                coldMs = cache.lastLoadMs();
+                cached = cache.loadDarknet(cfgPath, weightsPath);
+            }
+            cachedLoad.push_back(cache.lastLoadMs());
+            cachedFirst.push_back(firstForwardMs(cached, blob));
+            std::cout << "Run " << run + 1 << "/" << runs << " done" << std::endl;
+        }
+
+        double plainTotal = median(plainLoad) + median(plainFirst);
+        double cachedTotal = median(cachedLoad) + median(cachedFirst);
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "\nModel: " << cfgPath << " + " << weightsPath << "\n";
+        std::cout << "Cache key: " << std::hex << cache.modelKey(cfgPath, weightsPath) << std::dec << "\n";
+        if (coldMs >= 0) {
+            std::cout << "Cache build (cold):     " << coldMs << " ms\n";
+        }
+        std::cout << std::left << std::setw(24) << "" << std::setw(12) << "load ms"
+                  << std::setw(16) << "1st forward ms" << "total ms\n";
+        std::cout << std::setw(24) << "readNetFromDarknet" << std::setw(12) << median(plainLoad)
+                  << std::setw(16) << median(plainFirst) << plainTotal << "\n";
+        std::cout << std::setw(24) << "model cache (warm)" << std::setw(12) << median(cachedLoad)
+                  << std::setw(16) << median(cachedFirst) << cachedTotal << "\n";
+        std::cout << "Startup speedup: " << std::setprecision(2)
+                  << (cachedTotal > 0 ? plainTotal / cachedTotal : 0.0) << "x\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
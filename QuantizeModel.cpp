@@ -0,0 +1,168 @@
+#include "instrumentation.h"
+#include "model_session.h"
+#include "model_quantization.h"
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// INT8 quantization for the Darknet models.
+//
+//   calibrate: pick representative images from the captured dataset and
+//              write the calibration file used by the int8 runtime mode
+//   report:    run FP32 and INT8 on the same images and compare detections
+//              (YoloDetector defaults: conf 0.5, NMS 0.4) and speed
+//
+// The runtime mode is selected with a backend config such as:
+//   backend: "opencv"
+//   precision: "int8"
+//   calibration: "calibration.yml"
+
+struct TimedDetections {
+    std::vector<Detection> detections;
+    double ms;
+};
+
+TimedDetections detectTimed(ModelSession& session, const cv::Mat& img,
+                            float confThreshold, float nmsThreshold) {
+    auto t0 = std::chrono::steady_clock::now();
+    const std::vector<cv::Mat>& outs = session.run(img);
+    auto t1 = std::chrono::steady_clock::now();
+
+    TimedDetections result;
+    result.ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    result.detections = suppressDetections(
+        decodeYoloOutputs(outs, img.size(), confThreshold, {}),
+        confThreshold, nmsThreshold);
+    return result;
+}
+
+int calibrate(const std::string& datasetDir, const std::string& outPath,
+              int count, int inputSize) {
+    std::vector<std::string> images = selectCalibrationImages(datasetDir, count);
+    if (images.empty()) {
+        std::cerr << "Error: no images found in " << datasetDir << std::endl;
+        return -1;
+    }
+
+    saveCalibrationSet(outPath, images, cv::Size(inputSize, inputSize));
+    std::cout << "Selected " << images.size() << " calibration images from " << datasetDir << "\n";
+    std::cout << "Calibration file written to: " << outPath << std::endl;
+    return 0;
+}
+
+int report(const std::string& configPath, const std::string& weightsPath,
+           const std::string& calibrationPath, const std::string& imageDir,
+           int maxImages) {
+    cv::Size inputSize;
+    loadCalibrationBlob(calibrationPath, &inputSize);
+
+    std::cout << "Loading FP32 model...\n";
+    ModelSession fp32(configPath, weightsPath, inputSize);
+
+    std::cout << "Quantizing model to INT8...\n";
+    BackendConfig int8Config;
+    int8Config.precision = Precision::Int8;
+    int8Config.calibrationFile = calibrationPath;
+    auto q0 = std::chrono::steady_clock::now();
+    ModelSession int8(configPath, weightsPath, inputSize, int8Config);
+    double quantizeSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - q0).count();
+
+    // Evaluate on images that were not necessarily part of calibration
+    std::vector<std::string> images = selectCalibrationImages(imageDir, maxImages);
+
+    const float confThreshold = 0.5f;
+    const float nmsThreshold = 0.4f;
+    std::vector<double> fp32Ms, int8Ms;
+    size_t fp32Boxes = 0, int8Boxes = 0, matched = 0;
+    double iouSum = 0.0, confDeltaSum = 0.0;
+
+    for (const auto& path : images) {
+        cv::Mat img = cv::imread(path);
+        if (img.empty()) continue;
+
+        TimedDetections ref = detectTimed(fp32, img, confThreshold, nmsThreshold);
+        TimedDetections test = detectTimed(int8, img, confThreshold, nmsThreshold);
+        fp32Ms.push_back(ref.ms);
+        int8Ms.push_back(test.ms);
+        fp32Boxes += ref.detections.size();
+        int8Boxes += test.detections.size();
+
+        // Greedy same-class matching at IoU >= 0.5
+        std::vector<bool> used(test.detections.size(), false);
+        for (const auto& r : ref.detections) {
+            int best = -1;
+            float bestIoU = 0.5f;
+            for (size_t t = 0; t < test.detections.size(); ++t) {
+                if (used[t] || test.detections[t].class_id != r.class_id) continue;
+                float overlap = boxIoU(r.box, test.detections[t].box);
+                if (overlap >= bestIoU) {
+                    bestIoU = overlap;
+                    best = (int)t;
+                }
+            }
+            if (best >= 0) {
+                used[best] = true;
+                matched++;
+                iouSum += bestIoU;
+                confDeltaSum += std::abs(r.confidence - test.detections[best].confidence);
+            }
+        }
+    }
+
+    double fp32Median = median(fp32Ms);
+    double int8Median = median(int8Ms);
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "INT8 vs FP32 report (" << fp32Ms.size() << " images, input "
+        << inputSize.width << "x" << inputSize.height << ")\n";
+    out << "  Quantization time:      " << quantizeSec << " s\n";
+    out << "  FP32 latency p50:       " << fp32Median << " ms\n";
+    out << "  INT8 latency p50:       " << int8Median << " ms\n";
+    out << "  Speedup:                " << (int8Median > 0 ? fp32Median / int8Median : 0.0) << "x\n";
+    out << "  FP32 boxes:             " << fp32Boxes << "\n";
+    out << "  INT8 boxes:             " << int8Boxes << "\n";
+    out << "  Matched (IoU>=0.5):     " << matched << "\n";
+    out << "  Recall vs FP32:         " << (fp32Boxes ? (double)matched / fp32Boxes : 1.0) << "\n";
+    out << "  Precision vs FP32:      " << (int8Boxes ? (double)matched / int8Boxes : 1.0) << "\n";
+    out << "  Mean IoU of matches:    " << (matched ? iouSum / matched : 0.0) << "\n";
+    out << "  Mean |conf delta|:      " << (matched ? confDeltaSum / matched : 0.0) << "\n";
+
+    std::cout << "\n" << out.str();
+    std::ofstream("quantization_report.txt") << out.str();
+    std::cout << "Report written to quantization_report.txt" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        std::string mode = argc > 1 ? argv[1] : "";
+
+        if (mode == "calibrate" && argc >= 3) {
+            std::string out = argc > 3 ? argv[3] : "calibration.yml";
+            int count = argc > 4 ? std::stoi(argv[4]) : 32;
+            int size = argc > 5 ? std::stoi(argv[5]) : 416;
+            return calibrate(argv[2], out, count, size);
+        }
+        if (mode == "report" && argc >= 6) {
+            int maxImages = argc > 6 ? std::stoi(argv[6]) : 100;
+            return report(argv[2], argv[3], argv[4], argv[5], maxImages);
+        }
+
+        std::cerr << "Usage:\n";
+        std::cerr << "  " << argv[0] << " calibrate <dataset_dir> [calibration.yml] [count=32] [size=416]\n";
+        std::cerr << "  " << argv[0] << " report <model.cfg> <model.weights> <calibration.yml> <image_dir> [max_images=100]\n";
+        std::cerr << "Example: " << argv[0] << " calibrate darknet_dataset_Capture/images\n";
+        return -1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -1,32 +1,64 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
-
-cv::Rect roi;
-bool drawing = false;
-cv::Point start_point;
+#include "roi_config.h"
+#include "depth_filters.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+// Mouse editing state; the ROI itself lives in the shared config
+struct EditorState {
+    SharedROIConfig* config;
+    cv::Size frameSize;
+    bool drawing = false;
+    cv::Point start_point;
+};
 
 void mouseCallback(int event, int x, int y, int flags, void* userdata) {
+    EditorState* state = static_cast<EditorState*>(userdata);
     if (event == cv::EVENT_LBUTTONDOWN) {
-        drawing = true;
-        start_point = cv::Point(x, y);
-    } else if (event == cv::EVENT_MOUSEMOVE) {
-        if (drawing) {
-            roi = cv::Rect(start_point, cv::Point(x, y));
+        state->drawing = true;
+        state->start_point = cv::Point(x, y);
+    } else if (event == cv::EVENT_MOUSEMOVE || event == cv::EVENT_LBUTTONUP) {
+        if (state->drawing) {
+            // Publishes a new snapshot; the capture loop never waits for this
+            cv::Rect frame_rect(cv::Point(0, 0), state->frameSize);
+            cv::Rect roi = cv::Rect(state->start_point, cv::Point(x, y)) & frame_rect;
+            state->config->update([roi](ROIGridConfig& config) { config.roi = roi; });
+        }
+        if (event == cv::EVENT_LBUTTONUP) {
+            state->drawing = false;
         }
-    } else if (event == cv::EVENT_LBUTTONUP) {
-        drawing = false;
     }
 }
 
-float get_depth_at_pixel(const rs2::depth_frame& frame, int x, int y) 
+float get_depth_at_pixel(const cv::Mat& depth, float depth_scale, int x, int y) 
 {
-    // Get the depth value at the specified pixel
-    uint16_t depth_value = frame.get_distance(x, y);
+    // Get the depth value (meters) at the specified pixel
+    float depth_value = depth.at<ushort>(y, x) * depth_scale;
     return depth_value;
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    // ROI and grid are loaded from / saved to this file (YAML or JSON),
+    // the optional second file configures the depth filter chain
+    std::string config_path = argc > 1 ? argv[1] : "roi_grid.yml";
+    DepthFilterConfig filter_config;
+    if (argc > 2) {
+        filter_config = loadDepthFilterConfig(argv[2]);
+    }
+    DepthFilterChain depth_filter(filter_config);
+    bool filter_depth = true;
+    ROIGridConfig initial;
+    if (std::filesystem::exists(config_path)) {
+        initial = loadROIConfig(config_path, cv::Size(640, 480));
+        std::cout << "Loaded ROI config from " << config_path << std::endl;
+    }
+    SharedROIConfig config(initial);
+
     // Create a context and a pipeline
     rs2::context ctx;
     rs2::pipeline pipe(ctx);
@@ -38,13 +70,19 @@ int main() {
 
     // Start the pipeline
     rs2::pipeline_profile profile = pipe.start(cfg);
+    float depth_scale = profile.get_device().first<rs2::depth_sensor>().get_depth_scale();
 
     // Create an OpenCV window to display the result
     const std::string window_name = "RealSense D456 ROI with Grid";
+    EditorState editor;
+    editor.config = &config;
+    editor.frameSize = cv::Size(640, 480);
     cv::namedWindow(window_name, cv::WINDOW_AUTOSIZE);
-    cv::setMouseCallback(window_name, mouseCallback);
+    cv::setMouseCallback(window_name, mouseCallback, &editor);
+
+    std::cout << "Drag to set the ROI. +/- columns, >/< rows, x clear, f toggle depth filter, s save, q quit\n";
 
-    while (cv::waitKey(1) < 0) {
+    while (true) {
         // Wait for the next set of frames
         rs2::frameset frames = pipe.wait_for_frames();
 
@@ -56,13 +94,26 @@ int main() {
         cv::Mat color_image(cv::Size(640, 480), CV_8UC3, (void*)color_frame.get_data(), cv::Mat::AUTO_STEP);
         cv::Mat depth_image(cv::Size(640, 480), CV_16U, (void*)depth_frame.get_data(), cv::Mat::AUTO_STEP);
 
+        // Filter every frame so the temporal history stays continuous;
+        // cells are sampled at the decimated resolution
+        cv::Mat cell_depth = depth_image;
+        int decimation = 1;
+        if (filter_depth) {
+            cell_depth = depth_filter.process(depth_image);
+            decimation = depth_filter.getConfig().decimation;
+        }
+
+        // One consistent snapshot per frame, even while the ROI is being dragged
+        std::shared_ptr<const ROIGridConfig> grid = config.snapshot();
+        const cv::Rect& roi = grid->roi;
+
         // Draw the ROI if it is being defined
-        if (!roi.empty()) {
+        if (grid->hasROI()) {
             cv::rectangle(color_image, roi, cv::Scalar(0, 255, 0), 2);
 
             // Draw the grid within the ROI
-            int rows = 2;
-            int columns = 10;
+            int rows = grid->gridRows;
+            int columns = grid->gridColumns;
             int cell_width = roi.width / columns;
             int cell_height = roi.height / rows;
 
@@ -78,20 +129,43 @@ int main() {
             { 
                 for (int j = 0; j < rows; ++j) 
                 { 
-                    int cell_x = roi.x + i * cell_width + cell_width / 2; 
-                    int cell_y = roi.y + j * cell_height + cell_height / 2; 
-                    float depth = get_depth_at_pixel(depth_frame, cell_x, cell_y); 
+                    cv::Point cell = grid->cellCenter(j, i);
+                    int sample_x = std::min(cell.x / decimation, cell_depth.cols - 1);
+                    int sample_y = std::min(cell.y / decimation, cell_depth.rows - 1);
+                    float depth = get_depth_at_pixel(cell_depth, depth_scale, sample_x, sample_y); 
                     std::ostringstream depth_text; 
                     depth_text << std::fixed << std::setprecision(2) << depth << "m"; 
-                    cv::putText(color_image, depth_text.str(), cv::Point(cell_x - 10, cell_y), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 1); 
+                    cv::putText(color_image, depth_text.str(), cv::Point(cell.x - 10, cell.y), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 1); 
                     // Optionally print depth values to the console 
-                    std::cout << "Depth at (" << cell_x << ", " << cell_y << "): " << depth << "m" << std::endl; 
+                    std::cout << "Depth at (" << cell.x << ", " << cell.y << "): " << depth << "m" << std::endl; 
                     }
             }
         }
 
         // Display the result
         cv::imshow(window_name, color_image);
+
+        int key = cv::waitKey(1);
+        if (key == 'q' || key == 27) {
+            break;
+        } else if (key == '+' || key == '-') {
+            config.update([key](ROIGridConfig& c) {
+                c.gridColumns = std::max(1, c.gridColumns + (key == '+' ? 1 : -1));
+            });
+        } else if (key == '>' || key == '<') {
+            config.update([key](ROIGridConfig& c) {
+                c.gridRows = std::max(1, c.gridRows + (key == '>' ? 1 : -1));
+            });
+        } else if (key == 'f') {
+            filter_depth = !filter_depth;
+            depth_filter.reset();
+            std::cout << "Depth filter " << (filter_depth ? "on" : "off") << std::endl;
+        } else if (key == 'x') {
+            config.update([](ROIGridConfig& c) { c.roi = cv::Rect(); });
+        } else if (key == 's') {
+            saveROIConfig(config_path, *config.snapshot());
+            std::cout << "Saved ROI config to " << config_path << std::endl;
+        }
     }
 
     return 0;
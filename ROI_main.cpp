@@ -1,73 +1,51 @@
 #include "roi.h"
+#include "roi_config.h"
+#include "model_session.h"
+#include "overlay_renderer.h"
 #include <opencv2/dnn.hpp>
 #include <iostream>
 #include <fstream>
 #include <vector>
 
-// Function to read class names from coco.names
-std::vector<std::string> loadClassNames(const std::string& filename) {
-    std::vector<std::string> classNames;
-    std::ifstream file(filename);
-    std::string line;
-    while (std::getline(file, line)) {
-        classNames.push_back(line);
-    }
-    return classNames;
-}
-
 // Function to draw the detected objects
 void drawDetections(cv::Mat& frame, const ROIBox& roiBox,
                    const std::vector<cv::Rect>& boxes,
                    const std::vector<int>& classIds,
                    const std::vector<float>& confidences,
-                   const std::vector<std::string>& classNames) {
-    // Draw ROI
-    roiBox.draw(frame);
-
+                   const std::vector<std::string>& classNames,
+                   OverlayRenderer& renderer) {
     cv::Rect roi = roiBox.getROI();
+    renderer.begin(frame.size());
+
+    // Clip all detections to the ROI at once
+    std::vector<cv::Rect> clipped;
+    roiBox.clipRectsToROI(boxes, clipped);
     
     for (size_t i = 0; i < boxes.size(); ++i) {
-        // Clip detection to ROI and convert to frame coordinates
-        cv::Rect clippedBox = roiBox.clipRectToROI(boxes[i]);
+        // Convert to frame coordinates
+        cv::Rect clippedBox = clipped[i];
         clippedBox.x += roi.x;
         clippedBox.y += roi.y;
 
-        // Generate random color for this class
-        cv::Scalar color(rand() % 256, rand() % 256, rand() % 256);
-        
-        // Draw detection box
-        cv::rectangle(frame, clippedBox, color, 2);
-        
-        // Prepare label
-        std::string label = classNames[classIds[i]] + ": " + 
-                           cv::format("%.2f", confidences[i]);
-        
-        // Calculate label position
-        int baseLine;
-        cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
-                                           0.5, 1, &baseLine);
-        
-        cv::Point labelPos(clippedBox.x, clippedBox.y);
-        
-        // Ensure label stays within ROI
-        if (labelPos.y - labelSize.height - baseLine - 10 < roi.y) {
-            labelPos.y = clippedBox.y + clippedBox.height + labelSize.height;
-        } else {
-            labelPos.y = clippedBox.y - baseLine - 5;
-        }
-        
-        // Draw label background and text
-        cv::rectangle(frame, 
-                     cv::Point(labelPos.x, labelPos.y - labelSize.height - baseLine - 5),
-                     cv::Point(labelPos.x + labelSize.width, labelPos.y),
-                     color, cv::FILLED);
-        cv::putText(frame, label, labelPos, cv::FONT_HERSHEY_SIMPLEX, 
-                    0.5, cv::Scalar(255, 255, 255), 1);
+        // Same color for a class on every frame; label kept inside the ROI
+        TextStyle style;
+        style.background = classColor(classIds[i]);
+        renderer.addLabeledBox(clippedBox, classNames[classIds[i]] + ": " + confidenceText(confidences[i]),
+                               style.background, style, 2, roi);
     }
+    
+    renderer.compose(frame);
+
+    // Draw ROI
+    roiBox.draw(frame);
 }
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        // Optional ROI config (YAML/JSON, as saved by ROI_Grid); its ROI
+        // and zones replace the default box
+        std::string roiConfigPath = argc > 1 ? argv[1] : "";
+
         // Initialize YOLO model
         std::string modelConfig = "yolov3.cfg";
         std::string modelWeights = "yolov3.weights";
@@ -76,10 +54,8 @@ int main() {
         // Load class names
         std::vector<std::string> classNames = loadClassNames(classFile);
 
-        // Load network
-        cv::dnn::Net net = cv::dnn::readNetFromDarknet(modelConfig, modelWeights);
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        // Load network (output names are resolved once by the session)
+        ModelSession session(modelConfig, modelWeights);
 
         // Read input image
         cv::Mat frame = cv::imread("zidane.jpg");
@@ -87,26 +63,27 @@ int main() {
             throw std::runtime_error("Failed to load image!");
         }
 
-        // Create and set ROI
-        ROIBox roiBox;
-        roiBox.setROI(180, 100, 500, 610);
+        // ROI and detection zones, clipped to the frame
+        ROIGridConfig roiConfig;
+        if (!roiConfigPath.empty()) {
+            roiConfig = loadROIConfig(roiConfigPath, frame.size());
+        }
+        if (!roiConfig.hasROI()) {
+            roiConfig.roi = cv::Rect(180, 100, 500, 610) & cv::Rect(cv::Point(0, 0), frame.size());
+        }
+        ROIBox roiBox = roiConfig.toROIBox();
         cv::Rect roi = roiBox.getROI();
+        ROISet zones = roiConfig.toROISet(frame.size());
 
         // Create a black image same size as original
         cv::Mat blackImage = cv::Mat::zeros(frame.size(), frame.type());
         
-        // Copy ONLY the ROI content to the black image
-        frame(roi).copyTo(blackImage(roi));
+        // Copy ONLY the ROI content to the black image (views, no temporary)
+        cv::Mat target = roiBox.view(blackImage);
+        roiBox.view(frame).copyTo(target);
 
         // Now run detection on the modified image
-        cv::Mat blob;
-        cv::dnn::blobFromImage(blackImage, blob, 1/255.0, cv::Size(416, 416), 
-                              cv::Scalar(0,0,0), true, false, CV_32F);
-
-        // Run network on modified image
-        net.setInput(blob);
-        std::vector<cv::Mat> outputs;
-        net.forward(outputs, net.getUnconnectedOutLayersNames());
+        const std::vector<cv::Mat>& outputs = session.run(blackImage);
 
         // Process detections
         std::vector<cv::Rect> boxes;
@@ -134,9 +111,9 @@ int main() {
                         int left = centerX - width/2;
                         int top = centerY - height/2;
 
-                        // Only accept detection if it's within ROI
+                        // Only accept detection if its center is in a zone (O(1) mask lookup)
                         cv::Point center(centerX, centerY);
-                        if (roi.contains(center)) {
+                        if (zones.contains(center)) {
                             boxes.push_back(cv::Rect(left, top, width, height));
                             confidences.push_back(static_cast<float>(maxScore));
                             classIds.push_back(classIdPoint.x);
@@ -153,54 +130,20 @@ int main() {
             cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
         }
 
-        // Draw ROI box
-        cv::rectangle(frame, roi, cv::Scalar(255, 0, 0), 2);
-
-        // Draw valid detections with clipping
-        for (size_t i = 0; i < indices.size(); ++i) {
-            int idx = indices[i];
-            cv::Rect box = boxes[idx];
-
-            // Only draw if box center is in ROI
-            cv::Point boxCenter(box.x + box.width/2, box.y + box.height/2);
-            if (roi.contains(boxCenter)) {
-                // Clip the detection box to ROI boundaries
-                cv::Rect clippedBox = box & roi;  // Intersection with ROI
-                
-                cv::Scalar color(0, 255, 0);
-                cv::rectangle(frame, clippedBox, color, 2);
-
-                // Adjust label position to stay within ROI
-                std::string label = classNames[classIds[idx]] + ": " + 
-                                  cv::format("%.2f", confidences[idx]);
-
-                int baseLine;
-                cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
-                                                   0.5, 1, &baseLine);
-
-                // Calculate label position to ensure it stays within ROI
-                cv::Point labelPos;
-                labelPos.x = std::max(clippedBox.x, roi.x);
-                labelPos.y = std::max(clippedBox.y - baseLine - 5, roi.y + labelSize.height);
-
-                // Ensure label width doesn't exceed ROI
-                if (labelPos.x + labelSize.width > roi.x + roi.width) {
-                    labelPos.x = roi.x + roi.width - labelSize.width;
-                }
-
-                // Ensure label background stays within ROI
-                cv::Rect labelBackground(
-                    cv::Point(labelPos.x, labelPos.y - labelSize.height - baseLine - 5),
-                    cv::Point(labelPos.x + labelSize.width, labelPos.y)
-                );
-                labelBackground = labelBackground & roi;  // Clip to ROI
-
-                cv::rectangle(frame, labelBackground, color, cv::FILLED);
-                cv::putText(frame, label, 
-                           cv::Point(labelBackground.x, labelBackground.y + labelBackground.height - 5),
-                           cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
-            }
+        // Draw the kept detections (already limited to the zones above),
+        // labels clipped to the ROI
+        OverlayRenderer renderer;
+        renderer.begin(frame.size());
+        for (int idx : indices) {
+            TextStyle style;
+            style.background = classColor(classIds[idx]);
+            renderer.addLabeledBox(boxes[idx], classNames[classIds[idx]] + ": " + confidenceText(confidences[idx]),
+                                   style.background, style, 2, roi);
         }
+        renderer.compose(frame);
+
+        // Draw ROI box
+        roiBox.draw(frame);
 
         // Show debug images
         cv::imshow("Black Image with ROI", blackImage);
@@ -1,7 +1,15 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
+#include "depth_filters.h"
+
+int main(int argc, char** argv) {
+    // Optional depth filter config (YAML/JSON), defaults otherwise
+    DepthFilterConfig filter_config;
+    if (argc > 1) {
+        filter_config = loadDepthFilterConfig(argv[1]);
+    }
+    DepthFilterChain depth_filter(filter_config);
 
-int main() {
     rs2::pipeline pipe;
     rs2::config cfg;
     
@@ -29,9 +37,16 @@ int main() {
         cv::Mat depth_image(cv::Size(depth_width, depth_height), CV_16UC1, (void*)depth.get_data(), cv::Mat::AUTO_STEP);
         cv::Mat color_image(cv::Size(color_width, color_height), CV_8UC3, (void*)color.get_data(), cv::Mat::AUTO_STEP);
 
+        // Holes and flicker removed before visualizing; decimated output is
+        // scaled back up to the color resolution
+        const cv::Mat& filtered_depth = depth_filter.process(depth_image);
+
         cv::Mat depth_colormap;
-        cv::convertScaleAbs(depth_image, depth_colormap, 0.03);
+        cv::convertScaleAbs(filtered_depth, depth_colormap, 0.03);
         applyColorMap(depth_colormap, depth_colormap, cv::COLORMAP_JET);
+        if (depth_colormap.size() != color_image.size()) {
+            cv::resize(depth_colormap, depth_colormap, color_image.size(), 0, 0, cv::INTER_NEAREST);
+        }
 
         cv::Mat overlay;
         addWeighted(color_image, 0.7, depth_colormap, 0.3, 0, overlay);
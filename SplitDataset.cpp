@@ -0,0 +1,116 @@
+#include "dataset_split.h"
+#include "yolo_labels.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+// Writes train.txt/valid.txt for a Darknet dataset with a deterministic,
+// class-stratified and group-aware split (see DatasetSplitter). Labels are
+// read one image at a time; a list file input is streamed line by line in
+// its own order, a directory is sorted into capture order first.
+
+SplitConfig parseGroup(const std::string& spec, SplitConfig config) {
+    size_t colon = spec.find(':');
+    std::string mode = spec.substr(0, colon);
+    std::string value = colon == std::string::npos ? "" : spec.substr(colon + 1);
+    if (mode == "none") config.group = SplitGroup::None;
+    else if (mode == "dir") config.group = SplitGroup::Directory;
+    else if (mode == "frames") {
+        config.group = SplitGroup::FrameWindow;
+        if (!value.empty()) config.frameWindow = std::stoi(value);
+    }
+    else if (mode == "gap") {
+        config.group = SplitGroup::TimeGap;
+        if (!value.empty()) config.timeGap = std::stod(value);
+    }
+    else throw std::runtime_error("Unknown group mode: " + spec);
+    return config;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <dataset_dir|images_dir|list.txt> [--valid 0.2] [--seed 0]\n"
+                  << "       [--group none|dir|frames:30|gap:2.0] [--out dir]\n";
+        std::cerr << "Example: " << argv[0] << " darknet_dataset_Capture --group frames:30\n";
+        return -1;
+    }
+
+    try {
+        std::string input = argv[1];
+        SplitConfig config;
+        std::string outDir = fs::is_directory(input) ? input : fs::path(input).parent_path().string();
+        for (int i = 2; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--valid") config.validFraction = std::stod(value);
+            else if (arg == "--seed") config.seed = std::stoull(value);
+            else if (arg == "--group") config = parseGroup(value, config);
+            else if (arg == "--out") outDir = value;
+        }
+        if (outDir.empty()) outDir = ".";
+
+        auto start = std::chrono::steady_clock::now();
+        DatasetSplitter splitter((fs::path(outDir) / "train.txt").string(),
+                                 (fs::path(outDir) / "valid.txt").string(), config);
+
+        size_t unreadable = 0;
+        auto addImage = [&](const std::string& imagePath) {
+            std::vector<YoloLabel> labels;
+            try {
+                labels = readYoloLabels(labelPathForImage(imagePath));
+            } catch (const std::runtime_error& e) {
+                // Counted as background rather than aborting a long run
+                std::cerr << "Warning: " << e.what() << std::endl;
+                unreadable++;
+            }
+            splitter.add(imagePath, labels);
+        };
+
+        if (fs::is_directory(input)) {
+            std::string imagesDir = fs::is_directory(fs::path(input) / "images") ?
+                (fs::path(input) / "images").string() : input;
+            for (const auto& imagePath : listImagesInFrameOrder(imagesDir)) {
+                addImage(imagePath);
+            }
+        } else {
+            std::ifstream list(input);
+            if (!list.good()) {
+                throw std::runtime_error("Cannot open image list: " + input);
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) addImage(line);
+            }
+        }
+        splitter.finish();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const SplitStats& stats = splitter.stats();
+        size_t total = stats.images[0] + stats.images[1];
+        std::cout << "Split " << total << " images in " << stats.groups << " groups in " << sec << " s: "
+                  << stats.images[0] << " train, " << stats.images[1] << " valid";
+        if (unreadable > 0) std::cout << " (" << unreadable << " unreadable label files)";
+        std::cout << "\n\n" << std::left << std::setw(10) << "class" << std::setw(10) << "train"
+                  << std::setw(10) << "valid" << "valid %\n";
+        for (const auto& [classId, counts] : stats.classImages) {
+            size_t images = counts[0] + counts[1];
+            std::cout << std::setw(10) << (classId < 0 ? std::string("none") : std::to_string(classId))
+                      << std::setw(10) << counts[0] << std::setw(10) << counts[1]
+                      << std::fixed << std::setprecision(1)
+                      << (images > 0 ? 100.0 * counts[1] / images : 0.0) << "\n";
+        }
+        std::cout << "\nWrote " << (fs::path(outDir) / "train.txt").string() << " and "
+                  << (fs::path(outDir) / "valid.txt").string() << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
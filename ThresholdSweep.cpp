@@ -0,0 +1,181 @@
+#include "candidate_store.h"
+#include "detection_eval.h"
+#include "yolo_detection.h"
+#include "yolo_labels.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Sweeps confidence and NMS thresholds over stored pre-NMS candidates
+// (EvaluateDetector --save-candidates) without running the network: every
+// setting only re-runs suppressDetections, in parallel over the images, and
+// is scored against the YOLO labels (labels per image, precision, recall,
+// F1 at one IoU, and mAP@.5 of what the setting keeps).
+
+struct SweepResult {
+    float conf;
+    float nms;
+    size_t labels = 0;
+    MatchCounts counts;
+    double precision = 0;
+    double recall = 0;
+    double f1 = 0;
+    double map50 = 0;
+};
+
+// "start:stop:step" or a single value
+std::vector<float> parseRange(const std::string& text) {
+    std::vector<float> values;
+    size_t first = text.find(':');
+    if (first == std::string::npos) {
+        values.push_back(std::stof(text));
+        return values;
+    }
+    size_t second = text.find(':', first + 1);
+    float start = std::stof(text.substr(0, first));
+    float stop = std::stof(text.substr(first + 1, second - first - 1));
+    float step = second == std::string::npos ? 0.1f : std::stof(text.substr(second + 1));
+    if (step <= 0) {
+        throw std::runtime_error("Range step must be positive: " + text);
+    }
+    for (int i = 0; start + i * step <= stop + 1e-6f; ++i) {
+        values.push_back(start + i * step);
+    }
+    return values;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <candidates.pack> <class_names> [--conf 0.1:0.9:0.1]\n"
+                  << "       [--nms 0.3:0.6:0.05] [--iou 0.5] [--csv threshold_sweep.csv] [--threads N]\n";
+        std::cerr << "Example: " << argv[0] << " eval/candidates.pack darknet_dataset/obj.names --conf 0.2:0.6:0.05\n";
+        return -1;
+    }
+
+    try {
+        std::vector<std::string> classNames = loadClassNames(argv[2]);
+        std::vector<float> confValues = parseRange("0.1:0.9:0.1");
+        std::vector<float> nmsValues = parseRange("0.3:0.6:0.05");
+        float iouThreshold = 0.5f;
+        std::string csvPath = "threshold_sweep.csv";
+
+        for (int i = 3; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--conf") confValues = parseRange(value);
+            else if (arg == "--nms") nmsValues = parseRange(value);
+            else if (arg == "--iou") iouThreshold = std::stof(value);
+            else if (arg == "--csv") csvPath = value;
+            else if (arg == "--threads") cv::setNumThreads(std::stoi(value));
+        }
+
+        // Candidates and ground truth stay in memory for the whole sweep
+        auto loadStart = std::chrono::steady_clock::now();
+        CandidateStore store(argv[1]);
+        std::vector<std::string> images = store.imagePaths();
+        std::vector<std::vector<Detection>> candidates(images.size());
+        std::vector<cv::Size> frameSizes(images.size());
+        std::vector<std::vector<YoloLabel>> truth(images.size());
+        cv::parallel_for_(cv::Range(0, (int)images.size()), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                store.get(images[i], frameSizes[i], candidates[i], classNames);
+                truth[i] = readYoloLabels(labelPathForImage(images[i]));
+            }
+        });
+        size_t numCandidates = 0;
+        for (const auto& c : candidates) numCandidates += c.size();
+        double loadSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "Loaded " << images.size() << " images, " << numCandidates << " candidates in "
+                  << loadSec << " s\n";
+        if (images.empty()) {
+            return 0;
+        }
+
+        // Candidates below the floor were never stored, so lower thresholds
+        // would silently report too few detections
+        float lowestConf = *std::min_element(confValues.begin(), confValues.end());
+        if (lowestConf < store.confidenceFloor() - 1e-6f) {
+            throw std::runtime_error("--conf " + std::to_string(lowestConf) +
+                                     " is below the confidence threshold the candidates were stored with (" +
+                                     std::to_string(store.confidenceFloor()) + ")");
+        }
+
+        auto sweepStart = std::chrono::steady_clock::now();
+        std::vector<SweepResult> results;
+        std::vector<std::vector<ScoredLabel>> kept(images.size());
+        std::vector<MatchCounts> perImage(images.size());
+        for (float nms : nmsValues) {
+            for (float conf : confValues) {
+                SweepResult result;
+                result.conf = conf;
+                result.nms = nms;
+
+                cv::parallel_for_(cv::Range(0, (int)images.size()), [&](const cv::Range& range) {
+                    for (int i = range.start; i < range.end; ++i) {
+                        kept[i].clear();
+                        for (const auto& det : suppressDetections(candidates[i], conf, nms)) {
+                            kept[i].push_back({toYoloLabel(det, frameSizes[i]), det.confidence});
+                        }
+                        perImage[i] = countMatches(truth[i], kept[i], iouThreshold);
+                    }
+                });
+
+                DetectionEvaluator evaluator((int)classNames.size());
+                for (size_t i = 0; i < images.size(); ++i) {
+                    evaluator.add(truth[i], kept[i]);
+                    result.labels += kept[i].size();
+                    result.counts.truePositives += perImage[i].truePositives;
+                    result.counts.falsePositives += perImage[i].falsePositives;
+                    result.counts.falseNegatives += perImage[i].falseNegatives;
+                }
+                result.map50 = evaluator.evaluate().map50;
+
+                const MatchCounts& c = result.counts;
+                size_t predicted = c.truePositives + c.falsePositives;
+                size_t actual = c.truePositives + c.falseNegatives;
+                result.precision = predicted > 0 ? (double)c.truePositives / predicted : 0.0;
+                result.recall = actual > 0 ? (double)c.truePositives / actual : 0.0;
+                double sum = result.precision + result.recall;
+                result.f1 = sum > 0 ? 2 * result.precision * result.recall / sum : 0.0;
+                results.push_back(result);
+            }
+        }
+        double sweepSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - sweepStart).count();
+
+        // Report
+        std::cout << "\n" << std::fixed << std::setw(6) << "conf" << std::setw(6) << "nms"
+                  << std::setw(10) << "labels" << std::setw(9) << "per img" << std::setw(9) << "TP"
+                  << std::setw(9) << "FP" << std::setw(9) << "FN" << std::setw(8) << "prec"
+                  << std::setw(8) << "recall" << std::setw(8) << "F1" << std::setw(8) << "mAP50" << "\n";
+        std::ofstream csv(csvPath);
+        csv << "conf,nms,labels,true_positives,false_positives,false_negatives,precision,recall,f1,map50\n";
+        const SweepResult* best = &results.front();
+        for (const auto& r : results) {
+            std::cout << std::setprecision(2) << std::setw(6) << r.conf << std::setw(6) << r.nms
+                      << std::setw(10) << r.labels << std::setw(9) << (double)r.labels / images.size()
+                      << std::setw(9) << r.counts.truePositives << std::setw(9) << r.counts.falsePositives
+                      << std::setw(9) << r.counts.falseNegatives << std::setprecision(3)
+                      << std::setw(8) << r.precision << std::setw(8) << r.recall
+                      << std::setw(8) << r.f1 << std::setw(8) << r.map50 << "\n";
+            csv << r.conf << "," << r.nms << "," << r.labels << "," << r.counts.truePositives << ","
+                << r.counts.falsePositives << "," << r.counts.falseNegatives << "," << r.precision << ","
+                << r.recall << "," << r.f1 << "," << r.map50 << "\n";
+            if (r.f1 > best->f1) best = &r;
+        }
+
+        std::cout << std::setprecision(2) << "\n" << results.size() << " settings in " << sweepSec
+                  << " s. Best F1 " << std::setprecision(3) << best->f1 << std::setprecision(2)
+                  << " at conf " << best->conf << ", nms " << best->nms << "\n";
+        std::cout << "Results written to " << csvPath << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
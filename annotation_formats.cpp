@@ -0,0 +1,508 @@
+#include "annotation_formats.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const size_t kFlushBytes = 1 << 20;
+
+template <typename T>
+void appendNumber(std::string& out, T value) {
+    char text[32];
+    out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+}
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendXmlText(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            default: out += c;
+        }
+    }
+}
+
+// YOLO (normalized center/size) <-> pixel box (x, y, width, height)
+void toPixelBox(const YoloLabel& label, const cv::Size& size, float box[4]) {
+    box[0] = (label.x_center - label.width / 2) * size.width;
+    box[1] = (label.y_center - label.height / 2) * size.height;
+    box[2] = label.width * size.width;
+    box[3] = label.height * size.height;
+}
+
+YoloLabel fromPixelBox(int classId, const float box[4], const cv::Size& size) {
+    YoloLabel label;
+    label.class_id = classId;
+    label.x_center = (box[0] + box[2] / 2) / size.width;
+    label.y_center = (box[1] + box[3] / 2) / size.height;
+    label.width = box[2] / size.width;
+    label.height = box[3] / size.height;
+    return label;
+}
+
+// Minimal pull scanner over JSON text. Only what COCO needs is decoded,
+// everything else is skipped without allocating.
+class JsonScanner {
+public:
+    JsonScanner(const char* begin, const char* end) : p(begin), end(end) {}
+
+    void expect(char c) {
+        skipSpace();
+        if (p >= end || *p != c) fail(std::string("expected '") + c + "'");
+        ++p;
+    }
+
+    // Inside an object or array: true if another element follows
+    bool next(char close, bool& first) {
+        skipSpace();
+        if (p < end && *p == close) {
+            ++p;
+            return false;
+        }
+        if (!first) expect(',');
+        first = false;
+        return true;
+    }
+
+    std::string string() {
+        expect('"');
+        std::string value;
+        while (p < end && *p != '"') {
+            if (*p == '\\' && p + 1 < end) {
+                ++p;
+                switch (*p) {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case 'r': value += '\r'; break;
+                    case 'b': value += '\b'; break;
+                    case 'f': value += '\f'; break;
+                    case 'u': {
+                        // Code points are kept as UTF-8
+                        unsigned code = 0;
+                        if (end - p < 5 || std::from_chars(p + 1, p + 5, code, 16).ptr != p + 5) {
+                            fail("bad \\u escape");
+                        }
+                        if (code < 0x80) {
+                            value += (char)code;
+                        } else if (code < 0x800) {
+                            value += (char)(0xC0 | (code >> 6));
+                            value += (char)(0x80 | (code & 0x3F));
+                        } else {
+                            value += (char)(0xE0 | (code >> 12));
+                            value += (char)(0x80 | ((code >> 6) & 0x3F));
+                            value += (char)(0x80 | (code & 0x3F));
+                        }
+                        p += 4;
+                        break;
+                    }
+                    default: value += *p;
+                }
+            } else {
+                value += *p;
+            }
+            ++p;
+        }
+        if (p >= end) fail("unterminated string");
+        ++p;
+        return value;
+    }
+
+    double number() {
+        skipSpace();
+        double value = 0;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) fail("expected a number");
+        p = result.ptr;
+        return value;
+    }
+
+    void skipValue() {
+        skipSpace();
+        if (p >= end) fail("unexpected end");
+        if (*p == '"') {
+            ++p;
+            while (p < end && *p != '"') p += (*p == '\\') ? 2 : 1;
+            if (p >= end) fail("unterminated string");
+            ++p;
+        } else if (*p == '{' || *p == '[') {
+            char close = *p == '{' ? '}' : ']';
+            bool isObject = *p == '{';
+            ++p;
+            bool first = true;
+            while (next(close, first)) {
+                if (isObject) {
+                    string();
+                    expect(':');
+                }
+                skipValue();
+            }
+        } else {
+            // Number, true, false or null
+            while (p < end && !std::strchr(",}] \t\r\n", *p)) ++p;
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("COCO JSON: " + what);
+    }
+
+private:
+    const char* p;
+    const char* end;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    }
+};
+
+// Calls field(key) for every member of the next object
+template <typename F>
+void forEachMember(JsonScanner& json, F&& field) {
+    json.expect('{');
+    bool first = true;
+    while (json.next('}', first)) {
+        std::string key = json.string();
+        json.expect(':');
+        field(key);
+    }
+}
+
+// Calls element() for every element of the next array
+template <typename F>
+void forEachElement(JsonScanner& json, F&& element) {
+    json.expect('[');
+    bool first = true;
+    while (json.next(']', first)) {
+        element();
+    }
+}
+
+// Text between <tag> and </tag>, searching from pos; pos moves past it
+bool xmlTag(std::string_view text, const std::string& tag, size_t& pos, std::string_view& content) {
+    std::string open = "<" + tag + ">";
+    std::string close = "</" + tag + ">";
+    size_t start = text.find(open, pos);
+    if (start == std::string_view::npos) return false;
+    start += open.size();
+    size_t stop = text.find(close, start);
+    if (stop == std::string_view::npos) return false;
+    content = text.substr(start, stop - start);
+    pos = stop + close.size();
+    return true;
+}
+
+std::string xmlString(std::string_view text, const std::string& tag) {
+    size_t pos = 0;
+    std::string_view content;
+    if (!xmlTag(text, tag, pos, content)) return "";
+    std::string value(content);
+    for (auto [entity, c] : {std::pair<const char*, char>{"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'}}) {
+        size_t at;
+        while ((at = value.find(entity)) != std::string::npos) value.replace(at, std::strlen(entity), 1, c);
+    }
+    return value;
+}
+
+float xmlNumber(std::string_view text, const std::string& tag) {
+    size_t pos = 0;
+    std::string_view content;
+    float value = 0;
+    if (!xmlTag(text, tag, pos, content)) return value;
+    while (!content.empty() && std::isspace((unsigned char)content.front())) content.remove_prefix(1);
+    std::from_chars(content.data(), content.data() + content.size(), value);
+    return value;
+}
+
+} // namespace
+
+CocoWriter::CocoWriter(const std::string& path, const std::vector<std::string>& classNames)
+    : path(path), tmpPath(path + ".tmp"), annotationsPath(path + ".annotations.tmp"),
+      classNames(classNames) {
+    out.open(tmpPath, std::ios::binary);
+    annotationsOut.open(annotationsPath, std::ios::binary);
+    if (!out.good() || !annotationsOut.good()) {
+        throw std::runtime_error("Cannot write COCO file: " + path);
+    }
+    imageBuffer = "{\"info\":{\"description\":\"converted from YOLO labels\"},\"images\":[";
+}
+
+CocoWriter::~CocoWriter() {
+    // Not finished (conversion failed): discard the partial output instead
+    // of publishing a truncated file
+    if (finished) return;
+    out.close();
+    annotationsOut.close();
+    std::error_code ec;
+    fs::remove(tmpPath, ec);
+    fs::remove(annotationsPath, ec);
+}
+
+int64_t CocoWriter::addImage(const std::string& fileName, const cv::Size& size,
+                             const std::vector<YoloLabel>& labels) {
+    int64_t imageId = (int64_t)++images;
+    if (imageId > 1) imageBuffer += ',';
+    imageBuffer += "\n{\"id\":";
+    appendNumber(imageBuffer, imageId);
+    imageBuffer += ",\"file_name\":";
+    appendJsonString(imageBuffer, fileName);
+    imageBuffer += ",\"width\":";
+    appendNumber(imageBuffer, size.width);
+    imageBuffer += ",\"height\":";
+    appendNumber(imageBuffer, size.height);
+    imageBuffer += '}';
+
+    for (const auto& label : labels) {
+        float box[4];
+        toPixelBox(label, size, box);
+        if (++annotations > 1) annotationBuffer += ',';
+        annotationBuffer += "\n{\"id\":";
+        appendNumber(annotationBuffer, (int64_t)annotations);
+        annotationBuffer += ",\"image_id\":";
+        appendNumber(annotationBuffer, imageId);
+        annotationBuffer += ",\"category_id\":";
+        appendNumber(annotationBuffer, label.class_id + 1);
+        annotationBuffer += ",\"bbox\":[";
+        for (int i = 0; i < 4; ++i) {
+            if (i) annotationBuffer += ',';
+            appendNumber(annotationBuffer, box[i]);
+        }
+        annotationBuffer += "],\"area\":";
+        appendNumber(annotationBuffer, box[2] * box[3]);
+        annotationBuffer += ",\"iscrowd\":0}";
+    }
+
+    flushBuffers(false);
+    return imageId;
+}
+
+void CocoWriter::flushBuffers(bool force) {
+    if (force || imageBuffer.size() >= kFlushBytes) {
+        out.write(imageBuffer.data(), imageBuffer.size());
+        imageBuffer.clear();
+    }
+    if (force || annotationBuffer.size() >= kFlushBytes) {
+        annotationsOut.write(annotationBuffer.data(), annotationBuffer.size());
+        annotationBuffer.clear();
+    }
+}
+
+void CocoWriter::finish() {
+    if (finished) return;
+
+    imageBuffer += "],\"annotations\":[";
+    flushBuffers(true);
+    annotationsOut.close();
+
+    // Append the annotations in chunks, never holding them all in memory
+    {
+        std::ifstream annotationsIn(annotationsPath, std::ios::binary);
+        std::vector<char> chunk(kFlushBytes);
+        while (annotationsIn.read(chunk.data(), chunk.size()) || annotationsIn.gcount() > 0) {
+            out.write(chunk.data(), annotationsIn.gcount());
+        }
+    }
+    fs::remove(annotationsPath);
+
+    std::string tail = "],\"categories\":[";
+    for (size_t i = 0; i < classNames.size(); ++i) {
+        if (i) tail += ',';
+        tail += "\n{\"id\":";
+        appendNumber(tail, (int)i + 1);
+        tail += ",\"name\":";
+        appendJsonString(tail, classNames[i]);
+        tail += ",\"supercategory\":\"none\"}";
+    }
+    tail += "]}\n";
+    out.write(tail.data(), tail.size());
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Cannot write COCO file: " + path);
+    }
+    fs::rename(tmpPath, path);
+    finished = true;
+}
+
+CocoDataset readCoco(const std::string& path) {
+    MappedFile file(path);
+    JsonScanner json(file.data(), file.data() + file.size());
+
+    struct RawAnnotation {
+        int64_t imageId;
+        int64_t categoryId;
+        float bbox[4];
+    };
+    CocoDataset dataset;
+    std::unordered_map<int64_t, size_t> imageIndex;
+    std::vector<std::pair<int64_t, std::string>> categories;
+    std::vector<RawAnnotation> annotations;
+
+    forEachMember(json, [&](const std::string& section) {
+        if (section == "images") {
+            forEachElement(json, [&] {
+                AnnotatedImage image;
+                int64_t id = -1;
+                forEachMember(json, [&](const std::string& key) {
+                    if (key == "id") id = (int64_t)json.number();
+                    else if (key == "file_name") image.fileName = json.string();
+                    else if (key == "width") image.size.width = (int)json.number();
+                    else if (key == "height") image.size.height = (int)json.number();
+                    else json.skipValue();
+                });
+                imageIndex[id] = dataset.images.size();
+                dataset.images.push_back(std::move(image));
+            });
+        } else if (section == "annotations") {
+            forEachElement(json, [&] {
+                RawAnnotation annotation{-1, -1, {0, 0, 0, 0}};
+                forEachMember(json, [&](const std::string& key) {
+                    if (key == "image_id") annotation.imageId = (int64_t)json.number();
+                    else if (key == "category_id") annotation.categoryId = (int64_t)json.number();
+                    else if (key == "bbox") {
+                        int i = 0;
+                        forEachElement(json, [&] {
+                            float value = (float)json.number();
+                            if (i < 4) annotation.bbox[i++] = value;
+                        });
+                    }
+                    else json.skipValue();
+                });
+                annotations.push_back(annotation);
+            });
+        } else if (section == "categories") {
+            forEachElement(json, [&] {
+                int64_t id = -1;
+                std::string name;
+                forEachMember(json, [&](const std::string& key) {
+                    if (key == "id") id = (int64_t)json.number();
+                    else if (key == "name") name = json.string();
+                    else json.skipValue();
+                });
+                categories.emplace_back(id, name);
+            });
+        } else {
+            json.skipValue();
+        }
+    });
+
+    // YOLO class ids are the category positions in id order
+    std::sort(categories.begin(), categories.end());
+    std::map<int64_t, int> classIds;
+    for (const auto& [id, name] : categories) {
+        classIds[id] = (int)dataset.classNames.size();
+        dataset.classNames.push_back(name);
+    }
+
+    for (const auto& annotation : annotations) {
+        auto image = imageIndex.find(annotation.imageId);
+        auto classId = classIds.find(annotation.categoryId);
+        if (image == imageIndex.end() || classId == classIds.end()) {
+            throw std::runtime_error("COCO annotation refers to an unknown image or category: " + path);
+        }
+        AnnotatedImage& target = dataset.images[image->second];
+        if (target.size.width <= 0 || target.size.height <= 0) {
+            throw std::runtime_error("COCO image without size: " + target.fileName);
+        }
+        target.labels.push_back(fromPixelBox(classId->second, annotation.bbox, target.size));
+    }
+    return dataset;
+}
+
+void writeVocAnnotation(const std::string& path, const AnnotatedImage& image,
+                        const std::vector<std::string>& classNames) {
+    std::string xml = "<annotation>\n  <filename>";
+    appendXmlText(xml, image.fileName);
+    xml += "</filename>\n  <size>\n    <width>";
+    appendNumber(xml, image.size.width);
+    xml += "</width>\n    <height>";
+    appendNumber(xml, image.size.height);
+    xml += "</height>\n    <depth>3</depth>\n  </size>\n";
+
+    for (const auto& label : image.labels) {
+        if (label.class_id < 0 || label.class_id >= (int)classNames.size()) {
+            throw std::runtime_error("Class id " + std::to_string(label.class_id) +
+                                     " has no name (" + path + ")");
+        }
+        float box[4];
+        toPixelBox(label, image.size, box);
+        xml += "  <object>\n    <name>";
+        appendXmlText(xml, classNames[label.class_id]);
+        xml += "</name>\n    <pose>Unspecified</pose>\n    <truncated>0</truncated>\n"
+               "    <difficult>0</difficult>\n    <bndbox>\n      <xmin>";
+        appendNumber(xml, (int)std::lround(box[0]));
+        xml += "</xmin>\n      <ymin>";
+        appendNumber(xml, (int)std::lround(box[1]));
+        xml += "</ymin>\n      <xmax>";
+        appendNumber(xml, (int)std::lround(box[0] + box[2]));
+        xml += "</xmax>\n      <ymax>";
+        appendNumber(xml, (int)std::lround(box[1] + box[3]));
+        xml += "</ymax>\n    </bndbox>\n  </object>\n";
+    }
+    xml += "</annotation>\n";
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(xml.data(), xml.size())) {
+        throw std::runtime_error("Cannot write VOC annotation: " + path);
+    }
+}
+
+AnnotatedImage readVocAnnotation(const std::string& path,
+                                 const std::vector<std::string>& classNames) {
+    MappedFile file(path);
+    std::string_view text(file.data(), file.size());
+
+    AnnotatedImage image;
+    image.fileName = xmlString(text, "filename");
+    size_t pos = 0;
+    std::string_view size;
+    if (!xmlTag(text, "size", pos, size)) {
+        throw std::runtime_error("VOC annotation without <size>: " + path);
+    }
+    image.size = cv::Size((int)xmlNumber(size, "width"), (int)xmlNumber(size, "height"));
+    if (image.size.width <= 0 || image.size.height <= 0) {
+        throw std::runtime_error("VOC annotation with invalid size: " + path);
+    }
+
+    pos = 0;
+    std::string_view object;
+    while (xmlTag(text, "object", pos, object)) {
+        std::string name = xmlString(object, "name");
+        auto it = std::find(classNames.begin(), classNames.end(), name);
+        if (it == classNames.end()) {
+            throw std::runtime_error("Unknown class '" + name + "' in " + path);
+        }
+        float xmin = xmlNumber(object, "xmin"), ymin = xmlNumber(object, "ymin");
+        float box[4] = {xmin, ymin, xmlNumber(object, "xmax") - xmin, xmlNumber(object, "ymax") - ymin};
+        image.labels.push_back(fromPixelBox((int)(it - classNames.begin()), box, image.size));
+    }
+    return image;
+}
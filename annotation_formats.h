@@ -0,0 +1,73 @@
+#ifndef ANNOTATION_FORMATS_H
+#define ANNOTATION_FORMATS_H
+
+#include "yolo_labels.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// COCO and Pascal VOC conversion for YOLO labels. Class ids are indices
+// into one class name list, as in obj.names.
+
+// Writes a COCO detection JSON incrementally: images go straight to the
+// output file and annotations to a side file that is appended on
+// finish(), so memory stays bounded by the write buffers no matter how
+// large the dataset is. The result appears under its final name only
+// after finish(); a writer destroyed without it deletes its partial files.
+class CocoWriter {
+public:
+    CocoWriter(const std::string& path, const std::vector<std::string>& classNames);
+    ~CocoWriter();
+
+    CocoWriter(const CocoWriter&) = delete;
+    CocoWriter& operator=(const CocoWriter&) = delete;
+
+    // Image ids are 1-based in call order
+    int64_t addImage(const std::string& fileName, const cv::Size& size,
+                     const std::vector<YoloLabel>& labels);
+    void finish();
+
+    size_t imageCount() const { return images; }
+    size_t annotationCount() const { return annotations; }
+
+private:
+    std::string path;
+    std::string tmpPath;
+    std::string annotationsPath;
+    std::vector<std::string> classNames;
+    std::ofstream out;
+    std::ofstream annotationsOut;
+    std::string imageBuffer;
+    std::string annotationBuffer;
+    size_t images = 0;
+    size_t annotations = 0;
+    bool finished = false;
+
+    void flushBuffers(bool force);
+};
+
+struct AnnotatedImage {
+    std::string fileName;
+    cv::Size size;
+    std::vector<YoloLabel> labels;
+};
+
+struct CocoDataset {
+    std::vector<std::string> classNames;   // Categories ordered by id
+    std::vector<AnnotatedImage> images;
+};
+
+// Single pass over the memory-mapped JSON without building a DOM; only the
+// image, annotation and category fields needed for YOLO are kept
+CocoDataset readCoco(const std::string& path);
+
+// Pascal VOC XML, one file per image, boxes in integer pixels
+void writeVocAnnotation(const std::string& path, const AnnotatedImage& image,
+                        const std::vector<std::string>& classNames);
+// Object names must be in classNames
+AnnotatedImage readVocAnnotation(const std::string& path,
+                                 const std::vector<std::string>& classNames);
+
+#endif // ANNOTATION_FORMATS_H
@@ -0,0 +1,176 @@
+#include "candidate_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kMagic[4] = {'C', 'N', 'D', '2'};
+const char kOldMagic[4] = {'C', 'N', 'D', '1'};     // Without minConfidence
+
+// Entry: header, image path bytes, count records
+struct EntryHeader {
+    char magic[4];
+    uint32_t pathLength;
+    uint32_t count;
+    int32_t width;
+    int32_t height;
+    float minConfidence;
+};
+
+struct Record {
+    uint16_t classId;
+    uint16_t confidence;        // * 65535
+    uint16_t runnerUp;          // * 65535
+    int16_t x, y, width, height;
+};
+static_assert(sizeof(Record) == 14, "Candidate records must be packed");
+
+uint16_t quantize(float score) {
+    return (uint16_t)std::lround(std::min(std::max(score, 0.0f), 1.0f) * 65535.0f);
+}
+
+int16_t clampInt16(int value) {
+    return (int16_t)std::min(std::max(value, -32768), 32767);
+}
+
+} // namespace
+
+CandidateStore::CandidateStore(const std::string& path) : path(path) {
+    fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) fs::create_directories(parent);
+    loadPack();
+    appender.open(path, std::ios::binary | std::ios::app);
+    if (!appender.good()) {
+        throw std::runtime_error("Cannot write candidate store: " + path);
+    }
+}
+
+void CandidateStore::loadPack() {
+    if (!fs::exists(path) || fs::file_size(path) == 0) {
+        return;
+    }
+    pack = std::make_unique<MappedFile>(path);
+    if (pack->size() >= sizeof(kOldMagic) &&
+        std::memcmp(pack->data(), kOldMagic, sizeof(kOldMagic)) == 0) {
+        throw std::runtime_error("Candidate store has the old format without confidence floor, "
+                                 "store the candidates again: " + path);
+    }
+
+    // A torn entry at the end (crash while appending) is cut off
+    size_t offset = 0;
+    while (offset + sizeof(EntryHeader) <= pack->size()) {
+        EntryHeader header;
+        std::memcpy(&header, pack->data() + offset, sizeof(header));
+        size_t entrySize = sizeof(header) + header.pathLength + (size_t)header.count * sizeof(Record);
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            offset + entrySize > pack->size()) {
+            break;
+        }
+        const char* text = pack->data() + offset + sizeof(header);
+        std::string imagePath(text, header.pathLength);
+        auto it = index.find(imagePath);
+        size_t order = it != index.end() ? it->second.order : index.size();
+        index[imagePath] = {text + header.pathLength, header.count,
+                            cv::Size(header.width, header.height), header.minConfidence, order};
+        offset += entrySize;
+    }
+    if (offset < pack->size()) {
+        fs::resize_file(path, offset);
+    }
+    for (const auto& [imagePath, entry] : index) {
+        storedFloor = std::max(storedFloor, entry.minConfidence);
+    }
+}
+
+void CandidateStore::put(const std::string& imagePath, const cv::Size& frameSize,
+                         const std::vector<Detection>& candidates, float minConfidence) {
+    auto records = std::make_unique<std::vector<char>>(candidates.size() * sizeof(Record));
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const Detection& det = candidates[i];
+        Record record;
+        record.classId = (uint16_t)det.class_id;
+        record.confidence = quantize(det.confidence);
+        record.runnerUp = quantize(det.runner_up);
+        record.x = clampInt16(det.box.x);
+        record.y = clampInt16(det.box.y);
+        record.width = clampInt16(det.box.width);
+        record.height = clampInt16(det.box.height);
+        std::memcpy(records->data() + i * sizeof(Record), &record, sizeof(Record));
+    }
+
+    EntryHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.pathLength = (uint32_t)imagePath.size();
+    header.count = (uint32_t)candidates.size();
+    header.width = frameSize.width;
+    header.height = frameSize.height;
+    header.minConfidence = minConfidence;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    appender.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    appender.write(imagePath.data(), imagePath.size());
+    appender.write(records->data(), records->size());
+    appender.flush();
+    if (!appender) {
+        throw std::runtime_error("Cannot write candidate store: " + path);
+    }
+
+    auto it = index.find(imagePath);
+    size_t order = it != index.end() ? it->second.order : index.size();
+    index[imagePath] = {records->data(), header.count, frameSize, minConfidence, order};
+    appended.push_back(std::move(records));
+    storedFloor = std::max(storedFloor, minConfidence);
+}
+
+bool CandidateStore::get(const std::string& imagePath, cv::Size& frameSize,
+                         std::vector<Detection>& candidates,
+                         const std::vector<std::string>& classNames) const {
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(imagePath);
+        if (it == index.end()) {
+            return false;
+        }
+        entry = it->second;
+    }
+
+    frameSize = entry.frameSize;
+    candidates.resize(entry.count);
+    for (uint32_t i = 0; i < entry.count; ++i) {
+        Record record;
+        std::memcpy(&record, entry.records + i * sizeof(Record), sizeof(Record));
+        Detection& det = candidates[i];
+        det.box = cv::Rect(record.x, record.y, record.width, record.height);
+        det.confidence = record.confidence / 65535.0f;
+        det.runner_up = record.runnerUp / 65535.0f;
+        det.class_id = record.classId;
+        det.class_name = record.classId < classNames.size() ?
+                         classNames[record.classId] : std::to_string(record.classId);
+    }
+    return true;
+}
+
+std::vector<std::string> CandidateStore::imagePaths() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> paths(index.size());
+    for (const auto& [imagePath, entry] : index) {
+        paths[entry.order] = imagePath;
+    }
+    return paths;
+}
+
+size_t CandidateStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size();
+}
+
+float CandidateStore::confidenceFloor() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return storedFloor;
+}
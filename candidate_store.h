@@ -0,0 +1,67 @@
+#ifndef CANDIDATE_STORE_H
+#define CANDIDATE_STORE_H
+
+#include "mapped_file.h"
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Persistent store of pre-NMS detection candidates per image, so confidence
+// and NMS thresholds can be tuned by re-running only suppressDetections
+// instead of the network.
+//
+// Candidates are appended to one pack file as fixed 14-byte records: class
+// id, confidence and runner-up quantized to 16 bits (error < 1e-5), box in
+// 16-bit pixels (decodeYoloOutputs already rounds boxes to whole pixels).
+// That is about a third of the float Detection and a tiny fraction of the
+// raw output tensors. The pack is memory-mapped on open; re-storing an
+// image appends a new entry that supersedes the old one.
+class CandidateStore {
+public:
+    // Opens (or creates) the pack for reading and appending
+    explicit CandidateStore(const std::string& path);
+
+    // Candidates are normally decodeYoloOutputs(..., minConfidence) output;
+    // only confidence >= the lowest threshold to sweep needs to be kept.
+    // minConfidence is recorded, since lower thresholds cannot be swept.
+    void put(const std::string& imagePath, const cv::Size& frameSize,
+             const std::vector<Detection>& candidates, float minConfidence);
+    // False if the image is not stored. class_name is filled from classNames.
+    bool get(const std::string& imagePath, cv::Size& frameSize, std::vector<Detection>& candidates,
+             const std::vector<std::string>& classNames = {}) const;
+
+    // Stored images in first-stored order
+    std::vector<std::string> imagePaths() const;
+    size_t size() const;
+
+    // Highest minConfidence of the stored entries: the lowest confidence
+    // threshold the store can answer correctly
+    float confidenceFloor() const;
+
+private:
+    struct Entry {
+        const char* records;        // Into the mapping or into appended
+        uint32_t count;
+        cv::Size frameSize;
+        float minConfidence;
+        size_t order;
+    };
+
+    std::string path;
+    std::unique_ptr<MappedFile> pack;
+    std::vector<std::unique_ptr<std::vector<char>>> appended;     // Records stored this run
+    std::unordered_map<std::string, Entry> index;
+    float storedFloor = 0.0f;
+    std::ofstream appender;
+    mutable std::mutex mutex;
+
+    void loadPack();
+};
+
+#endif // CANDIDATE_STORE_H
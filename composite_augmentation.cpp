@@ -0,0 +1,330 @@
+#include "composite_augmentation.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Box in canvas pixels. area is the unclipped, uncovered area used for the
+// visibility test; hidden holds the parts of box covered by later pastes.
+struct PixelBox {
+    int classId;
+    cv::Rect2f box;
+    float area;
+    std::vector<cv::Rect2f> hidden;
+};
+
+// Area of the union of a few rectangles, summed over the grid of their edges
+float unionArea(const std::vector<cv::Rect2f>& rects) {
+    std::vector<float> xs, ys;
+    for (const auto& r : rects) {
+        xs.insert(xs.end(), {r.x, r.x + r.width});
+        ys.insert(ys.end(), {r.y, r.y + r.height});
+    }
+    std::sort(xs.begin(), xs.end());
+    std::sort(ys.begin(), ys.end());
+    float area = 0;
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+        for (size_t j = 0; j + 1 < ys.size(); ++j) {
+            cv::Point2f center((xs[i] + xs[i + 1]) / 2, (ys[j] + ys[j + 1]) / 2);
+            for (const auto& r : rects) {
+                if (r.contains(center)) {
+                    area += (xs[i + 1] - xs[i]) * (ys[j + 1] - ys[j]);
+                    break;
+                }
+            }
+        }
+    }
+    return area;
+}
+
+// Maps the labels of a source image whose region srcRoi is drawn into
+// dstRect of the canvas, keeping boxes that stay visible enough
+void placeBoxes(const LabeledImage& source, const cv::Rect& srcRoi, const cv::Rect& dstRect,
+                const CompositeConfig& config, std::vector<PixelBox>& boxes) {
+    float sx = (float)dstRect.width / srcRoi.width;
+    float sy = (float)dstRect.height / srcRoi.height;
+    cv::Rect2f dst(dstRect);
+    for (const auto& label : source.labels) {
+        float x0 = (label.x_center - label.width / 2) * source.image.cols;
+        float y0 = (label.y_center - label.height / 2) * source.image.rows;
+        cv::Rect2f mapped(dst.x + (x0 - srcRoi.x) * sx, dst.y + (y0 - srcRoi.y) * sy,
+                          label.width * source.image.cols * sx, label.height * source.image.rows * sy);
+        cv::Rect2f clipped = mapped & dst;
+        float area = mapped.area();
+        if (area <= 0 || clipped.area() < config.minVisibility * area ||
+            clipped.width < config.minBoxPixels || clipped.height < config.minBoxPixels) {
+            continue;
+        }
+        boxes.push_back({label.class_id, clipped, area, {}});
+    }
+}
+
+// Pasting over patch hides part of every box below it; overlapping pastes
+// hide the union of their patches, not the sum
+void coverBoxes(const cv::Rect& patch, const CompositeConfig& config, std::vector<PixelBox>& boxes) {
+    cv::Rect2f covered(patch);
+    boxes.erase(std::remove_if(boxes.begin(), boxes.end(), [&](PixelBox& b) {
+        cv::Rect2f hidden = b.box & covered;
+        if (hidden.area() <= 0) return false;
+        b.hidden.push_back(hidden);
+        return b.box.area() - unionArea(b.hidden) < config.minVisibility * b.area;
+    }), boxes.end());
+}
+
+// Resizes srcRoi of the source straight into the canvas region
+void drawRegion(const LabeledImage& source, const cv::Rect& srcRoi, cv::Mat& canvas,
+                const cv::Rect& dstRect, const cv::Scalar& fill) {
+    cv::Mat dst = canvas(dstRect);
+    if (source.image.empty() || srcRoi.area() <= 0) {
+        dst.setTo(fill);
+        return;
+    }
+    cv::resize(source.image(srcRoi), dst, dstRect.size(), 0, 0, cv::INTER_LINEAR);
+}
+
+void toLabels(const std::vector<PixelBox>& boxes, const cv::Size& canvasSize,
+              std::vector<YoloLabel>& labels) {
+    labels.clear();
+    for (const auto& b : boxes) {
+        labels.push_back({b.classId,
+                          (b.box.x + b.box.width / 2) / canvasSize.width,
+                          (b.box.y + b.box.height / 2) / canvasSize.height,
+                          b.box.width / canvasSize.width,
+                          b.box.height / canvasSize.height});
+    }
+}
+
+cv::Rect fullRect(const cv::Mat& image) {
+    return cv::Rect(0, 0, image.cols, image.rows);
+}
+
+// Base image stretched over the whole canvas
+void drawBase(const LabeledImage& base, CompositeSample& sample, const CompositeConfig& config,
+              std::vector<PixelBox>& boxes) {
+    cv::Rect canvasRect = fullRect(sample.image);
+    drawRegion(base, fullRect(base.image), sample.image, canvasRect, config.fill);
+    if (!base.image.empty()) {
+        placeBoxes(base, fullRect(base.image), canvasRect, config, boxes);
+    }
+}
+
+} // namespace
+
+CompositeKind parseCompositeKind(const std::string& name) {
+    if (name == "mosaic") return CompositeKind::Mosaic;
+    if (name == "cutmix") return CompositeKind::CutMix;
+    if (name == "copypaste") return CompositeKind::CopyPaste;
+    throw std::runtime_error("Unknown composite augmentation '" + name + "' (mosaic, cutmix, copypaste)");
+}
+
+std::string compositeKindName(CompositeKind kind) {
+    switch (kind) {
+        case CompositeKind::Mosaic: return "mosaic";
+        case CompositeKind::CutMix: return "cutmix";
+        case CompositeKind::CopyPaste: return "copypaste";
+    }
+    return "?";
+}
+
+SourceCache::SourceCache(const std::vector<std::string>& imagePaths, size_t capacityBytes)
+    : paths(imagePaths), capacityBytes(capacityBytes) {}
+
+std::shared_ptr<const LabeledImage> SourceCache::get(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = slots.find(index);
+        if (it != slots.end()) {
+            recency.splice(recency.begin(), recency, it->second.position);
+            hitCount++;
+            return it->second.source;
+        }
+    }
+
+    // A source whose image or labels cannot be read stays empty and is
+    // skipped by the generator
+    auto source = std::make_shared<LabeledImage>();
+    source->image = cv::imread(paths[index]);
+    if (!source->image.empty()) {
+        try {
+            source->labels = readYoloLabels(labelPathForImage(paths[index]));
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping " << paths[index] << ": " << e.what() << std::endl;
+            source->image.release();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    missCount++;
+    auto it = slots.find(index);
+    if (it != slots.end()) {
+        return it->second.source;       // Decoded by another thread meanwhile
+    }
+    recency.push_front(index);
+    slots[index] = {source, recency.begin()};
+    usedBytes += source->image.total() * source->image.elemSize();
+
+    // Evict least recently used; entries still in use stay alive through
+    // their shared_ptr
+    while (usedBytes > capacityBytes && recency.size() > 1) {
+        auto victim = slots.find(recency.back());
+        usedBytes -= victim->second.source->image.total() * victim->second.source->image.elemSize();
+        slots.erase(victim);
+        recency.pop_back();
+    }
+    return source;
+}
+
+CompositeGenerator::CompositeGenerator(const std::vector<std::string>& imagePaths,
+                                       const CompositeConfig& config, size_t cacheBytes,
+                                       size_t numThreads, uint64_t seed)
+    : config(config), cache(imagePaths, cacheBytes), pool(numThreads), seed(seed) {
+    if (imagePaths.empty()) {
+        throw std::runtime_error("Composite augmentation needs at least one source image");
+    }
+    if (config.kinds.empty()) {
+        throw std::runtime_error("No composite augmentation kinds configured");
+    }
+}
+
+void CompositeGenerator::generate(std::vector<CompositeSample>& batch, uint64_t firstIndex) {
+    size_t chunks = std::min(pool.size(), batch.size());
+    std::vector<std::future<void>> done;
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t begin = batch.size() * c / chunks;
+        size_t end = batch.size() * (c + 1) / chunks;
+        done.push_back(pool.submit([this, &batch, firstIndex, begin, end] {
+            for (size_t i = begin; i < end; ++i) {
+                compose(firstIndex + i, batch[i]);
+            }
+        }));
+    }
+    // Every task writes into batch, so all of them must finish before a
+    // failure is passed on
+    std::exception_ptr failure;
+    for (auto& f : done) {
+        try {
+            f.get();
+        } catch (...) {
+            if (!failure) failure = std::current_exception();
+        }
+    }
+    if (failure) std::rethrow_exception(failure);
+}
+
+void CompositeGenerator::compose(uint64_t sampleIndex, CompositeSample& sample) {
+    cv::RNG rng(seed * 0x9E3779B97F4A7C15ull + sampleIndex * 0xBF58476D1CE4E5B9ull + 1);
+    sample.kind = config.kinds[rng.uniform(0, (int)config.kinds.size())];
+    sample.image.create(config.outputSize, CV_8UC3);
+    switch (sample.kind) {
+        case CompositeKind::Mosaic: mosaic(rng, sample); break;
+        case CompositeKind::CutMix: cutMix(rng, sample); break;
+        case CompositeKind::CopyPaste: copyPaste(rng, sample); break;
+    }
+}
+
+std::shared_ptr<const LabeledImage> CompositeGenerator::randomSource(cv::RNG& rng) {
+    std::shared_ptr<const LabeledImage> source;
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        source = cache.get(rng.uniform(0, (int)cache.size()));
+        if (!source->image.empty()) break;
+    }
+    return source;
+}
+
+void CompositeGenerator::mosaic(cv::RNG& rng, CompositeSample& sample) {
+    int width = config.outputSize.width;
+    int height = config.outputSize.height;
+    int cx = cvRound(width * (0.5f + rng.uniform(-config.mosaicCenterRange, config.mosaicCenterRange)));
+    int cy = cvRound(height * (0.5f + rng.uniform(-config.mosaicCenterRange, config.mosaicCenterRange)));
+    cx = std::min(std::max(cx, 1), width - 1);
+    cy = std::min(std::max(cy, 1), height - 1);
+
+    const cv::Rect quadrants[4] = {cv::Rect(0, 0, cx, cy), cv::Rect(cx, 0, width - cx, cy),
+                                   cv::Rect(0, cy, cx, height - cy), cv::Rect(cx, cy, width - cx, height - cy)};
+    std::vector<PixelBox> boxes;
+    for (int q = 0; q < 4; ++q) {
+        const cv::Rect& dst = quadrants[q];
+        auto source = randomSource(rng);
+        if (source->image.empty()) {
+            sample.image(dst).setTo(config.fill);
+            continue;
+        }
+
+        // Cover the quadrant with up to 1.5x zoom; the crop touches the
+        // mosaic center, so the four images meet there
+        const cv::Mat& img = source->image;
+        float scale = std::max((float)dst.width / img.cols, (float)dst.height / img.rows) *
+                      rng.uniform(1.0f, 1.5f);
+        int cropW = std::min(img.cols, std::max(1, cvRound(dst.width / scale)));
+        int cropH = std::min(img.rows, std::max(1, cvRound(dst.height / scale)));
+        int x = (q % 2 == 0) ? img.cols - cropW : 0;
+        int y = (q < 2) ? img.rows - cropH : 0;
+        cv::Rect crop(x, y, cropW, cropH);
+
+        drawRegion(*source, crop, sample.image, dst, config.fill);
+        placeBoxes(*source, crop, dst, config, boxes);
+    }
+    toLabels(boxes, config.outputSize, sample.labels);
+}
+
+void CompositeGenerator::cutMix(cv::RNG& rng, CompositeSample& sample) {
+    std::vector<PixelBox> boxes;
+    drawBase(*randomSource(rng), sample, config, boxes);
+
+    // Rectangle of the second image at the same relative position
+    int width = config.outputSize.width;
+    int height = config.outputSize.height;
+    float area = rng.uniform(config.cutMixMinArea, config.cutMixMaxArea) * width * height;
+    float aspect = std::exp(rng.uniform(std::log(0.5f), std::log(2.0f)));
+    int patchW = std::min(width, std::max(1, cvRound(std::sqrt(area * aspect))));
+    int patchH = std::min(height, std::max(1, cvRound(area / patchW)));
+    cv::Rect patch(rng.uniform(0, width - patchW + 1), rng.uniform(0, height - patchH + 1), patchW, patchH);
+
+    auto other = randomSource(rng);
+    coverBoxes(patch, config, boxes);
+    if (other->image.empty()) {
+        sample.image(patch).setTo(config.fill);
+    } else {
+        const cv::Mat& img = other->image;
+        cv::Rect crop(patch.x * img.cols / width, patch.y * img.rows / height,
+                      std::max(1, patch.width * img.cols / width), std::max(1, patch.height * img.rows / height));
+        crop &= fullRect(img);
+        drawRegion(*other, crop, sample.image, patch, config.fill);
+        placeBoxes(*other, crop, patch, config, boxes);
+    }
+    toLabels(boxes, config.outputSize, sample.labels);
+}
+
+void CompositeGenerator::copyPaste(cv::RNG& rng, CompositeSample& sample) {
+    std::vector<PixelBox> boxes;
+    drawBase(*randomSource(rng), sample, config, boxes);
+
+    int width = config.outputSize.width;
+    int height = config.outputSize.height;
+    for (int k = 0; k < config.copyPasteObjects; ++k) {
+        // A labeled object of another image, at its canvas scale +-25%
+        auto other = randomSource(rng);
+        if (other->image.empty() || other->labels.empty()) continue;
+        const cv::Mat& img = other->image;
+        const YoloLabel& object = other->labels[rng.uniform(0, (int)other->labels.size())];
+        cv::Rect crop(cvRound((object.x_center - object.width / 2) * img.cols),
+                      cvRound((object.y_center - object.height / 2) * img.rows),
+                      cvRound(object.width * img.cols), cvRound(object.height * img.rows));
+        crop &= fullRect(img);
+        if (crop.width < 2 || crop.height < 2) continue;
+
+        float jitter = rng.uniform(0.75f, 1.25f);
+        int pasteW = std::min(width, std::max(1, cvRound(crop.width * jitter * width / img.cols)));
+        int pasteH = std::min(height, std::max(1, cvRound(crop.height * jitter * height / img.rows)));
+        cv::Rect paste(rng.uniform(0, width - pasteW + 1), rng.uniform(0, height - pasteH + 1), pasteW, pasteH);
+
+        coverBoxes(paste, config, boxes);
+        drawRegion(*other, crop, sample.image, paste, config.fill);
+        placeBoxes(*other, crop, paste, config, boxes);
+    }
+    toLabels(boxes, config.outputSize, sample.labels);
+}
@@ -0,0 +1,107 @@
+#ifndef COMPOSITE_AUGMENTATION_H
+#define COMPOSITE_AUGMENTATION_H
+
+#include "thread_pool.h"
+#include "yolo_labels.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Multi-image augmentations that compose several labeled images into one
+// sample and carry the YOLO boxes along (see image_augmentation.h for the
+// per-image transforms).
+
+enum class CompositeKind {
+    Mosaic,       // Four images around a random center
+    CutMix,       // Rectangle of a second image pasted into the first
+    CopyPaste     // Labeled objects of other images pasted into the first
+};
+
+CompositeKind parseCompositeKind(const std::string& name);
+std::string compositeKindName(CompositeKind kind);
+
+struct LabeledImage {
+    cv::Mat image;
+    std::vector<YoloLabel> labels;
+};
+
+// Decoded images with their labels, least recently used evicted beyond
+// capacityBytes. Thread-safe; decoding happens outside the lock.
+class SourceCache {
+public:
+    SourceCache(const std::vector<std::string>& imagePaths, size_t capacityBytes);
+
+    // Empty image if the file cannot be read
+    std::shared_ptr<const LabeledImage> get(size_t index);
+
+    size_t size() const { return paths.size(); }
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    struct Slot {
+        std::shared_ptr<const LabeledImage> source;
+        std::list<size_t>::iterator position;
+    };
+
+    std::vector<std::string> paths;
+    size_t capacityBytes;
+    size_t usedBytes = 0;
+    std::list<size_t> recency;                  // Most recent first
+    std::unordered_map<size_t, Slot> slots;
+    std::mutex mutex;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+};
+
+struct CompositeConfig {
+    std::vector<CompositeKind> kinds = {CompositeKind::Mosaic};     // Picked at random per sample
+    cv::Size outputSize = cv::Size(640, 640);
+    float mosaicCenterRange = 0.25f;    // Center within 0.5 +- range of the canvas
+    float cutMixMinArea = 0.1f;         // Pasted rectangle, fraction of the canvas
+    float cutMixMaxArea = 0.5f;
+    int copyPasteObjects = 3;
+    float minVisibility = 0.3f;         // Boxes clipped or covered below this fraction are dropped
+    float minBoxPixels = 2.0f;
+    cv::Scalar fill = cv::Scalar(114, 114, 114);
+};
+
+struct CompositeSample {
+    cv::Mat image;                      // Reused when it already has the output size
+    std::vector<YoloLabel> labels;
+    CompositeKind kind = CompositeKind::Mosaic;
+};
+
+// Generates composed samples in memory, e.g. to feed a training loader.
+// Every sample is a deterministic function of (seed, sample index), and a
+// batch is split across a thread pool; samples are drawn into the caller's
+// canvases, resized straight from the cached sources into canvas regions.
+class CompositeGenerator {
+public:
+    CompositeGenerator(const std::vector<std::string>& imagePaths, const CompositeConfig& config,
+                       size_t cacheBytes = 512u << 20, size_t numThreads = 0, uint64_t seed = 0);
+
+    // batch[i] becomes sample firstIndex + i
+    void generate(std::vector<CompositeSample>& batch, uint64_t firstIndex);
+    void compose(uint64_t sampleIndex, CompositeSample& sample);
+
+    const SourceCache& sources() const { return cache; }
+
+private:
+    CompositeConfig config;
+    SourceCache cache;
+    ThreadPool pool;
+    uint64_t seed;
+
+    void mosaic(cv::RNG& rng, CompositeSample& sample);
+    void cutMix(cv::RNG& rng, CompositeSample& sample);
+    void copyPaste(cv::RNG& rng, CompositeSample& sample);
+    std::shared_ptr<const LabeledImage> randomSource(cv::RNG& rng);
+};
+
+#endif // COMPOSITE_AUGMENTATION_H
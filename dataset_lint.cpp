@@ -0,0 +1,234 @@
+#include "dataset_lint.h"
+#include "image_header.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <map>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Slack for coordinates that were rounded when the label was written
+const float kRangeTolerance = 1e-5f;
+
+// Relative path without extension, the key that pairs images and labels
+std::unordered_map<std::string, std::string> listByStem(const std::string& root, bool images) {
+    std::unordered_map<std::string, std::string> files;
+    if (!fs::is_directory(root)) {
+        return files;
+    }
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) continue;
+        const fs::path& path = entry.path();
+        if (images ? !isImageFile(path) : path.extension() != ".txt") continue;
+        fs::path key = fs::relative(path, root).replace_extension();
+        files.emplace(key.string(), path.string());
+    }
+    return files;
+}
+
+struct Corners {
+    float x0, y0, x1, y1;
+};
+
+Corners corners(const YoloLabel& label) {
+    return {label.x_center - label.width / 2, label.y_center - label.height / 2,
+            label.x_center + label.width / 2, label.y_center + label.height / 2};
+}
+
+float clamp01(float value) {
+    return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+struct ImageResult {
+    cv::Size size;
+    std::vector<LintFinding> findings;
+    size_t boxes = 0;
+    size_t removed = 0;
+    bool repaired = false;
+};
+
+} // namespace
+
+const char* lintIssueName(LintIssue issue) {
+    switch (issue) {
+        case LintIssue::MissingLabel: return "missing label";
+        case LintIssue::MissingImage: return "missing image";
+        case LintIssue::UnreadableImage: return "unreadable image";
+        case LintIssue::MalformedLabel: return "malformed label";
+        case LintIssue::SizeMismatch: return "image size mismatch";
+        case LintIssue::UnknownClass: return "unknown class";
+        case LintIssue::OutOfRange: return "box out of range";
+        case LintIssue::Degenerate: return "degenerate box";
+        case LintIssue::Duplicate: return "duplicate box";
+        case LintIssue::Count: break;
+    }
+    return "?";
+}
+
+std::vector<LintIssue> repairLabels(std::vector<YoloLabel>& labels, const cv::Size& frameSize,
+                                    const LintOptions& options) {
+    std::vector<LintIssue> issues;
+    std::vector<YoloLabel> kept;
+    std::vector<cv::Rect2f> keptBoxes;
+    kept.reserve(labels.size());
+
+    for (YoloLabel label : labels) {
+        if (options.numClasses > 0 && (label.class_id < 0 || label.class_id >= options.numClasses)) {
+            issues.push_back(LintIssue::UnknownClass);
+            continue;
+        }
+
+        // Clip to the image; in-range boxes keep their exact values
+        Corners box = corners(label);
+        if (box.x0 < -kRangeTolerance || box.y0 < -kRangeTolerance ||
+            box.x1 > 1 + kRangeTolerance || box.y1 > 1 + kRangeTolerance ||
+            label.width < 0 || label.height < 0 || !std::isfinite(box.x0 + box.y0 + box.x1 + box.y1)) {
+            issues.push_back(LintIssue::OutOfRange);
+            if (!std::isfinite(box.x0 + box.y0 + box.x1 + box.y1)) {
+                box = {0, 0, 0, 0};
+            }
+            box = {clamp01(std::min(box.x0, box.x1)), clamp01(std::min(box.y0, box.y1)),
+                   clamp01(std::max(box.x0, box.x1)), clamp01(std::max(box.y0, box.y1))};
+            label.x_center = (box.x0 + box.x1) / 2;
+            label.y_center = (box.y0 + box.y1) / 2;
+            label.width = box.x1 - box.x0;
+            label.height = box.y1 - box.y0;
+        }
+
+        if (label.width * frameSize.width < options.minBoxPixels ||
+            label.height * frameSize.height < options.minBoxPixels) {
+            issues.push_back(LintIssue::Degenerate);
+            continue;
+        }
+
+        bool duplicate = false;
+        for (size_t k = 0; k < kept.size() && !duplicate; ++k) {
+            duplicate = kept[k].class_id == label.class_id &&
+                        boxIoU(keptBoxes[k], labelRect(label)) >= options.duplicateIou;
+        }
+        if (duplicate) {
+            issues.push_back(LintIssue::Duplicate);
+            continue;
+        }
+
+        kept.push_back(label);
+        keptBoxes.push_back(labelRect(label));
+    }
+
+    labels.swap(kept);
+    return issues;
+}
+
+LintReport lintDataset(const std::string& imagesDir, const std::string& labelsDir,
+                       const LintOptions& options) {
+    auto images = listByStem(imagesDir, true);
+    auto labels = listByStem(labelsDir, false);
+
+    std::vector<std::pair<std::string, std::string>> pairs(images.begin(), images.end());
+    std::sort(pairs.begin(), pairs.end());
+
+    LintReport report;
+    report.images = pairs.size();
+    report.labelFiles = labels.size();
+
+    // Headers and labels of every image, in parallel; each image only
+    // touches its own result
+    std::vector<ImageResult> results(pairs.size());
+    cv::parallel_for_(cv::Range(0, (int)pairs.size()), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const std::string& imagePath = pairs[i].second;
+            ImageResult& result = results[i];
+
+            result.size = imageSize(imagePath);
+            if (result.size.area() <= 0) {
+                result.findings.push_back({LintIssue::UnreadableImage, imagePath, ""});
+                continue;
+            }
+
+            auto label = labels.find(pairs[i].first);
+            if (label == labels.end()) {
+                result.findings.push_back({LintIssue::MissingLabel, imagePath, ""});
+                continue;
+            }
+            const std::string& labelPath = label->second;
+
+            std::vector<YoloLabel> boxes;
+            try {
+                boxes = readYoloLabels(labelPath);
+            } catch (const std::runtime_error& e) {
+                result.findings.push_back({LintIssue::MalformedLabel, labelPath, e.what()});
+                continue;
+            }
+            result.boxes = boxes.size();
+
+            std::vector<LintIssue> issues = repairLabels(boxes, result.size, options);
+            if (issues.empty()) continue;
+
+            // One finding per issue kind and file
+            std::map<LintIssue, int> perKind;
+            for (LintIssue issue : issues) perKind[issue]++;
+            for (const auto& [issue, count] : perKind) {
+                result.findings.push_back({issue, labelPath, std::to_string(count) + " of " +
+                                           std::to_string(result.boxes) + " boxes", (size_t)count});
+            }
+            result.removed = result.boxes - boxes.size();
+
+            if (options.repair) {
+                std::string tmpPath = labelPath + ".tmp";
+                writeYoloLabels(tmpPath, boxes);
+                fs::rename(tmpPath, labelPath);
+                result.repaired = true;
+            }
+        }
+    });
+
+    // Expected size: given, or the most common one
+    report.expectedSize = options.expectedSize;
+    if (report.expectedSize.area() <= 0) {
+        std::map<std::pair<int, int>, size_t> histogram;
+        for (const auto& result : results) {
+            if (result.size.area() > 0) histogram[{result.size.width, result.size.height}]++;
+        }
+        size_t best = 0;
+        for (const auto& [size, count] : histogram) {
+            if (count > best) {
+                best = count;
+                report.expectedSize = cv::Size(size.first, size.second);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        ImageResult& result = results[i];
+        if (result.size.area() > 0 && result.size != report.expectedSize) {
+            result.findings.push_back({LintIssue::SizeMismatch, pairs[i].second,
+                                       std::to_string(result.size.width) + "x" +
+                                       std::to_string(result.size.height)});
+        }
+        for (auto& finding : result.findings) {
+            report.findings.push_back(std::move(finding));
+        }
+        report.boxes += result.boxes;
+        report.removedBoxes += result.removed;
+        report.repairedFiles += result.repaired ? 1 : 0;
+    }
+
+    // Labels whose image is gone
+    for (const auto& [key, labelPath] : labels) {
+        if (!images.count(key)) {
+            report.findings.push_back({LintIssue::MissingImage, labelPath, ""});
+        }
+    }
+
+    std::sort(report.findings.begin(), report.findings.end(),
+              [](const LintFinding& a, const LintFinding& b) {
+                  return a.path != b.path ? a.path < b.path : a.issue < b.issue;
+              });
+    for (const auto& finding : report.findings) {
+        report.counts[(size_t)finding.issue] += finding.count;
+    }
+    return report;
+}
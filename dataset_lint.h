@@ -0,0 +1,65 @@
+#ifndef DATASET_LINT_H
+#define DATASET_LINT_H
+
+#include "yolo_labels.h"
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+// Consistency checks for a Darknet/YOLO dataset (image + label file pairs)
+
+enum class LintIssue {
+    MissingLabel,       // Image without label file (reported only: may be a negative)
+    MissingImage,       // Label file without image
+    UnreadableImage,
+    MalformedLabel,     // Label file that does not parse (never rewritten)
+    SizeMismatch,       // Image size differs from the expected/majority size
+    UnknownClass,       // Class id outside the class list
+    OutOfRange,         // Box extends outside [0,1]
+    Degenerate,         // Box smaller than minBoxPixels after clipping
+    Duplicate,          // Same class, IoU >= duplicateIou with an earlier box
+    Count
+};
+
+const char* lintIssueName(LintIssue issue);
+
+struct LintOptions {
+    int numClasses = 0;             // 0 = class ids are not checked
+    cv::Size expectedSize;          // Empty = most common size in the dataset
+    float minBoxPixels = 2.0f;      // Minimum box width and height
+    float duplicateIou = 0.9f;
+    bool repair = false;            // Rewrite labels with the box issues fixed
+};
+
+struct LintFinding {
+    LintIssue issue;
+    std::string path;
+    std::string detail;
+    size_t count = 1;       // Affected boxes for box issues, else 1
+};
+
+struct LintReport {
+    size_t images = 0;
+    size_t labelFiles = 0;
+    size_t boxes = 0;
+    size_t repairedFiles = 0;
+    size_t removedBoxes = 0;
+    cv::Size expectedSize;
+    std::array<size_t, (size_t)LintIssue::Count> counts{};    // Boxes or files per issue
+    std::vector<LintFinding> findings;     // Sorted by path
+};
+
+// Box checks and repair for the labels of one image of frameSize: boxes are
+// clipped to the image, then degenerate, unknown-class and duplicate boxes
+// are dropped. Returns the issues found, one per affected box.
+std::vector<LintIssue> repairLabels(std::vector<YoloLabel>& labels, const cv::Size& frameSize,
+                                    const LintOptions& options);
+
+// Scans every image under imagesDir (recursive) and every label file under
+// labelsDir in parallel. Images are paired with labels by relative path;
+// image sizes come from the file headers, not from decoding.
+LintReport lintDataset(const std::string& imagesDir, const std::string& labelsDir,
+                       const LintOptions& options);
+
+#endif // DATASET_LINT_H
@@ -0,0 +1,190 @@
+#include "dataset_split.h"
+#include "image_header.h"
+#include "model_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Frame number of a numeric file stem, -1 otherwise
+long long frameNumber(const fs::path& path) {
+    std::string stem = path.stem().string();
+    if (stem.empty() || stem.size() > 18 ||
+        !std::all_of(stem.begin(), stem.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return -1;
+    }
+    return std::stoll(stem);
+}
+
+} // namespace
+
+DatasetSplitter::DatasetSplitter(const std::string& trainList, const std::string& validList,
+                                 const SplitConfig& config)
+    : config(config), listPaths{trainList, validList} {
+    if (config.validFraction < 0 || config.validFraction > 1) {
+        throw std::runtime_error("Valid fraction must be within [0,1]");
+    }
+    for (int s = 0; s < 2; ++s) {
+        lists[s].open(listPaths[s] + ".tmp");
+        if (!lists[s].good()) {
+            throw std::runtime_error("Cannot write image list: " + listPaths[s]);
+        }
+    }
+}
+
+DatasetSplitter::~DatasetSplitter() {
+    // Not finished (the split failed): discard the partial lists instead
+    // of publishing them
+    if (finished) return;
+    std::error_code ec;
+    for (int s = 0; s < 2; ++s) {
+        lists[s].close();
+        fs::remove(listPaths[s] + ".tmp", ec);
+    }
+}
+
+std::string DatasetSplitter::keyFor(const std::string& imagePath) {
+    fs::path path(imagePath);
+    switch (config.group) {
+        case SplitGroup::None:
+            return imagePath;
+        case SplitGroup::Directory:
+            return path.parent_path().string();
+        case SplitGroup::FrameWindow: {
+            long long frame = frameNumber(path);
+            if (frame < 0) return imagePath;
+            return path.parent_path().string() + "#" + std::to_string(frame / std::max(1, config.frameWindow));
+        }
+        case SplitGroup::TimeGap: {
+            std::error_code error;
+            auto mtime = fs::last_write_time(path, error);
+            double time = std::chrono::duration<double>(mtime.time_since_epoch()).count();
+            if (std::abs(time - lastTime) > config.timeGap) session++;
+            lastTime = time;
+            return "session#" + std::to_string(session);
+        }
+    }
+    return imagePath;
+}
+
+void DatasetSplitter::add(const std::string& imagePath, const std::vector<YoloLabel>& labels) {
+    std::string key = keyFor(imagePath);
+    if (key != groupKey) {
+        closeGroup();
+        groupKey = key;
+    }
+
+    PendingImage image;
+    image.path = fs::absolute(imagePath).string();
+    for (const auto& label : labels) {
+        if (std::find(image.classes.begin(), image.classes.end(), label.class_id) == image.classes.end()) {
+            image.classes.push_back(label.class_id);
+        }
+    }
+    group.push_back(std::move(image));
+}
+
+void DatasetSplitter::closeGroup() {
+    if (group.empty()) {
+        return;
+    }
+
+    // Stratum: the rarest class of the group so far, -1 for background
+    int stratum = -1;
+    size_t rarest = SIZE_MAX;
+    for (const auto& image : group) {
+        for (int c : image.classes) {
+            size_t seen = classSeen[c];
+            if (seen < rarest || (seen == rarest && c < stratum)) {
+                rarest = seen;
+                stratum = c;
+            }
+        }
+    }
+
+    // Valid when the stratum is short of its valid share by at least
+    // u * groupSize, u in [0,1) from the group hash: exact balance over
+    // time, no fixed pattern in which groups are picked
+    std::array<size_t, 2>& counts = strata[stratum];
+    double n = (double)group.size();
+    double deficit = config.validFraction * (counts[0] + counts[1] + n) - counts[1];
+    uint64_t hash = hashBytes(groupKey.data(), groupKey.size(), config.seed ^ 0x9E3779B97F4A7C15ull);
+    double u = (double)(hash >> 11) * (1.0 / 9007199254740992.0);
+    int subset = deficit >= u * n ? 1 : 0;
+
+    counts[subset] += group.size();
+    for (const auto& image : group) {
+        lists[subset] << image.path << "\n";
+        splitStats.images[subset]++;
+        for (int c : image.classes) {
+            classSeen[c]++;
+            splitStats.classImages[c][subset]++;
+        }
+        if (image.classes.empty()) {
+            splitStats.classImages[-1][subset]++;
+        }
+    }
+    splitStats.groups++;
+    group.clear();
+}
+
+void DatasetSplitter::finish() {
+    if (finished) return;
+
+    closeGroup();
+    for (int s = 0; s < 2; ++s) {
+        lists[s].close();
+        if (!lists[s]) {
+            throw std::runtime_error("Cannot write image list: " + listPaths[s]);
+        }
+        fs::rename(listPaths[s] + ".tmp", listPaths[s]);
+    }
+    finished = true;
+}
+
+std::vector<std::string> listImagesInFrameOrder(const std::string& dir) {
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file() && isImageFile(entry.path())) {
+            paths.push_back(entry.path());
+        }
+    }
+
+    // Directory, then frame number, then name
+    std::sort(paths.begin(), paths.end(), [](const fs::path& a, const fs::path& b) {
+        if (a.parent_path() != b.parent_path()) return a.parent_path() < b.parent_path();
+        long long fa = frameNumber(a), fb = frameNumber(b);
+        if (fa != fb) return fa < fb;
+        return a.filename() < b.filename();
+    });
+
+    std::vector<std::string> images;
+    images.reserve(paths.size());
+    for (const auto& path : paths) images.push_back(path.string());
+    return images;
+}
+
+std::vector<std::string> loadImageList(const std::string& input) {
+    if (fs::is_directory(input)) {
+        return listImagesInFrameOrder(input);
+    }
+    std::ifstream list(input);
+    if (!list.good()) {
+        throw std::runtime_error("Cannot open image list: " + input);
+    }
+    std::vector<std::string> images;
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) images.push_back(line);
+    }
+    return images;
+}
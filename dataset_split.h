@@ -0,0 +1,89 @@
+#ifndef DATASET_SPLIT_H
+#define DATASET_SPLIT_H
+
+#include "yolo_labels.h"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// How images are grouped so that a group lands in one subset only
+enum class SplitGroup {
+    None,           // Every image on its own
+    Directory,      // Images of one directory (e.g. one capture session)
+    FrameWindow,    // Numbered frames (0.jpg, 1.jpg, ...) in windows of frameWindow
+    TimeGap         // New group whenever the mtime jumps by more than timeGap seconds
+};
+
+struct SplitConfig {
+    double validFraction = 0.2;
+    uint64_t seed = 0;
+    SplitGroup group = SplitGroup::FrameWindow;
+    int frameWindow = 30;
+    double timeGap = 2.0;
+};
+
+struct SplitStats {
+    std::array<size_t, 2> images{};                     // Train, valid
+    size_t groups = 0;
+    std::map<int, std::array<size_t, 2>> classImages;   // Images containing the class, -1 = no boxes
+};
+
+// Streaming train/valid split. Images are added in order and assigned one
+// group at a time, so memory is bounded by the largest group, not by the
+// dataset; list entries are written as soon as their group closes.
+//
+// Each group is stratified by its rarest class (fewest images so far). Per
+// stratum the valid share is kept at validFraction: a group goes to valid
+// when the stratum's valid deficit covers a hash-derived share of the
+// group size. The result is deterministic for a given seed and order, and
+// appending images to the end never moves earlier ones.
+class DatasetSplitter {
+public:
+    DatasetSplitter(const std::string& trainList, const std::string& validList,
+                    const SplitConfig& config = SplitConfig());
+    ~DatasetSplitter();
+
+    DatasetSplitter(const DatasetSplitter&) = delete;
+    DatasetSplitter& operator=(const DatasetSplitter&) = delete;
+
+    void add(const std::string& imagePath, const std::vector<YoloLabel>& labels);
+    // Assigns the last group and moves the lists into place. A splitter
+    // destroyed without finish() deletes its partial lists.
+    void finish();
+
+    const SplitStats& stats() const { return splitStats; }
+
+private:
+    struct PendingImage {
+        std::string path;
+        std::vector<int> classes;       // Distinct class ids
+    };
+
+    SplitConfig config;
+    std::array<std::string, 2> listPaths;
+    std::array<std::ofstream, 2> lists;
+    std::vector<PendingImage> group;
+    std::string groupKey;
+    double lastTime = 0;
+    size_t session = 0;
+    std::unordered_map<int, size_t> classSeen;                  // Images per class so far
+    std::unordered_map<int, std::array<size_t, 2>> strata;      // Images per stratum and subset
+    SplitStats splitStats;
+    bool finished = false;
+
+    std::string keyFor(const std::string& imagePath);
+    void closeGroup();
+};
+
+// Images under dir (recursive), sorted so numbered frames are in capture
+// order (2.jpg before 10.jpg)
+std::vector<std::string> listImagesInFrameOrder(const std::string& dir);
+
+// Image directory (in frame order) or list file with one image path per line
+std::vector<std::string> loadImageList(const std::string& input);
+
+#endif // DATASET_SPLIT_H
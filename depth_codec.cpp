@@ -0,0 +1,374 @@
+#include "depth_codec.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+static const int kStripeRows = 16;
+static const int kBlockSize = 32;
+static const int kZeroBlock = 31;     // Block code for "all residuals are 0"
+static const int kUnaryLimit = 24;    // Longer quotients are escaped
+static const int kEscapeBits = 17;    // Zigzag residuals of 16-bit data
+static const uint32_t kRawStripe = 1u << 31;  // Size flag: stripe stored uncompressed
+
+// MSB-first bit packing into a buffer sized for the worst case
+class BitWriter {
+public:
+    explicit BitWriter(uchar* out) : begin(out), p(out) {}
+
+    // Up to 32 bits per call; pending bits stay below 32 between calls
+    void put(uint32_t value, int count) {
+        acc = (acc << count) | value;
+        bits += count;
+        if (bits >= 32) {
+            bits -= 32;
+            uint32_t word = (uint32_t)(acc >> bits);
+            p[0] = (uchar)(word >> 24);
+            p[1] = (uchar)(word >> 16);
+            p[2] = (uchar)(word >> 8);
+            p[3] = (uchar)word;
+            p += 4;
+        }
+    }
+
+    size_t finish() {
+        while (bits >= 8) {
+            bits -= 8;
+            *p++ = (uchar)(acc >> bits);
+        }
+        if (bits > 0) {
+            *p++ = (uchar)(acc << (8 - bits));
+            bits = 0;
+        }
+        return p - begin;
+    }
+
+private:
+    uchar* begin;
+    uchar* p;
+    uint64_t acc = 0;
+    int bits = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const uchar* data, size_t size) : p(data), end(data + size) { refill(); }
+
+    uint32_t get(int count) {
+        if (count == 0) return 0;
+        if (bits < 48) refill();
+        need(count);
+        uint32_t value = (uint32_t)(acc >> (64 - count));
+        skip(count);
+        return value;
+    }
+
+    // Rice code with parameter k: unary quotient, then k remainder bits,
+    // or the escape followed by the raw value
+    uint32_t rice(int k) {
+        if (bits < 48) refill();
+        int zeros = acc ? __builtin_clzll(acc) : 64;
+        if (zeros < kUnaryLimit) {
+            int count = zeros + 1 + k;
+            need(count);
+            uint32_t remainder = k ? (uint32_t)(acc >> (64 - count)) & ((1u << k) - 1) : 0;
+            skip(count);
+            return ((uint32_t)zeros << k) | remainder;
+        }
+        if (zeros > kUnaryLimit) {
+            throw std::runtime_error("Corrupt depth stream");
+        }
+        need(kUnaryLimit + 1 + kEscapeBits);
+        uint32_t value = (uint32_t)(acc >> (64 - kUnaryLimit - 1 - kEscapeBits)) & ((1u << kEscapeBits) - 1);
+        skip(kUnaryLimit + 1 + kEscapeBits);
+        return value;
+    }
+
+private:
+    const uchar* p;
+    const uchar* end;
+    uint64_t acc = 0;   // Valid bits are left aligned
+    int bits = 0;
+
+    void refill() {
+        while (bits <= 56 && p < end) {
+            acc |= (uint64_t)*p++ << (56 - bits);
+            bits += 8;
+        }
+    }
+    void need(int count) {
+        if (bits < count) {
+            throw std::runtime_error("Truncated depth stream");
+        }
+    }
+    void skip(int count) {
+        acc <<= count;
+        bits -= count;
+    }
+};
+
+// LOCO-I median edge detector, written as a clamp of the planar
+// prediction so it compiles to min/max instead of unpredictable branches
+static inline int predict(int left, int up, int upLeft) {
+    int lo = std::min(left, up);
+    int hi = std::max(left, up);
+    return std::min(hi, std::max(lo, left + up - upLeft));
+}
+
+static inline uint32_t zigzag(int r) {
+    return ((uint32_t)r << 1) ^ (uint32_t)(r >> 31);
+}
+
+static inline int unzigzag(uint32_t u) {
+    return (int)(u >> 1) ^ -(int)(u & 1);
+}
+
+// Residuals of rows [y0, y1); the first row of a stripe only looks left,
+// so stripes do not depend on each other
+static void predictStripe(const cv::Mat& depth, int y0, int y1, uint32_t* residuals) {
+    const int width = depth.cols;
+    for (int y = y0; y < y1; ++y, residuals += width) {
+        const ushort* row = depth.ptr<ushort>(y);
+        if (y == y0) {
+            int left = 0;
+            for (int x = 0; x < width; ++x) {
+                residuals[x] = zigzag(row[x] - left);
+                left = row[x];
+            }
+            continue;
+        }
+        const ushort* above = depth.ptr<ushort>(y - 1);
+        residuals[0] = zigzag(row[0] - above[0]);
+        for (int x = 1; x < width; ++x) {
+            residuals[x] = zigzag(row[x] - predict(row[x - 1], above[x], above[x - 1]));
+        }
+    }
+}
+
+// Inverse of predictStripe
+static void reconstructStripe(const uint32_t* residuals, int y0, int y1, cv::Mat& depth) {
+    const int width = depth.cols;
+    for (int y = y0; y < y1; ++y, residuals += width) {
+        ushort* row = depth.ptr<ushort>(y);
+        if (y == y0) {
+            int left = 0;
+            for (int x = 0; x < width; ++x) {
+                left = (ushort)(left + unzigzag(residuals[x]));
+                row[x] = (ushort)left;
+            }
+            continue;
+        }
+        const ushort* above = depth.ptr<ushort>(y - 1);
+        row[0] = (ushort)(above[0] + unzigzag(residuals[0]));
+        for (int x = 1; x < width; ++x) {
+            row[x] = (ushort)(predict(row[x - 1], above[x], above[x - 1]) + unzigzag(residuals[x]));
+        }
+    }
+}
+
+static void encodeStripe(const cv::Mat& depth, int y0, int y1, std::vector<uchar>& out) {
+    const int width = depth.cols;
+    const size_t count = (size_t)(y1 - y0) * width;
+    // Per-thread scratch, so steady-state encoding does not allocate
+    thread_local std::vector<uint32_t> residuals;
+    thread_local std::vector<uchar> bitstream;
+    residuals.resize(count);
+    predictStripe(depth, y0, y1, residuals.data());
+
+    // Worst case is an escape (42 bits) per sample plus 5 bits per block
+    bitstream.resize(count * 6 + 16);
+    BitWriter writer(bitstream.data());
+    for (size_t start = 0; start < count; start += kBlockSize) {
+        size_t stop = std::min(count, start + kBlockSize);
+        uint64_t sum = 0;
+        for (size_t j = start; j < stop; ++j) sum += residuals[j];
+        if (sum == 0) {
+            writer.put(kZeroBlock, 5);
+            continue;
+        }
+
+        // Rice parameter close to log2 of the mean residual
+        int k = 0;
+        while (k < 16 && ((uint64_t)(stop - start) << (k + 1)) <= sum) ++k;
+        writer.put(k, 5);
+        for (size_t j = start; j < stop; ++j) {
+            uint32_t u = residuals[j];
+            uint32_t q = u >> k;
+            if (q >= (uint32_t)kUnaryLimit) {
+                writer.put(1, kUnaryLimit + 1);
+                writer.put(u, kEscapeBits);
+            } else if (q + 1 + k <= 32) {
+                // q zeros, a one, then the k low bits in a single write
+                writer.put((1u << k) | (u & ((1u << k) - 1)), q + 1 + k);
+            } else {
+                writer.put(1, q + 1);
+                writer.put(u & ((1u << k) - 1), k);
+            }
+        }
+    }
+    size_t used = writer.finish();
+
+    // Noise-like stripes are cheaper stored as they are
+    if (used < count * 2) {
+        out.assign(bitstream.begin(), bitstream.begin() + used);
+    } else {
+        out.resize(count * 2);
+        uchar* p = out.data();
+        for (int y = y0; y < y1; ++y) {
+            const ushort* row = depth.ptr<ushort>(y);
+            for (int x = 0; x < width; ++x) {
+                *p++ = (uchar)row[x];
+                *p++ = (uchar)(row[x] >> 8);
+            }
+        }
+    }
+}
+
+static void decodeStripe(const uchar* data, size_t size, bool raw, cv::Mat& depth, int y0, int y1) {
+    const int width = depth.cols;
+    const size_t count = (size_t)(y1 - y0) * width;
+    if (raw) {
+        if (size != count * 2) {
+            throw std::runtime_error("Corrupt depth stream");
+        }
+        for (int y = y0; y < y1; ++y) {
+            ushort* row = depth.ptr<ushort>(y);
+            for (int x = 0; x < width; ++x, data += 2) {
+                row[x] = (ushort)(data[0] | (data[1] << 8));
+            }
+        }
+        return;
+    }
+
+    thread_local std::vector<uint32_t> residuals;
+    residuals.resize(count);
+    BitReader reader(data, size);
+    for (size_t start = 0; start < count; start += kBlockSize) {
+        size_t stop = std::min(count, start + kBlockSize);
+        int k = (int)reader.get(5);
+        if (k == kZeroBlock) {
+            std::fill(residuals.begin() + start, residuals.begin() + stop, 0u);
+        } else if (k > 16) {
+            throw std::runtime_error("Corrupt depth stream");
+        } else {
+            for (size_t j = start; j < stop; ++j) {
+                residuals[j] = reader.rice(k);
+            }
+        }
+    }
+    reconstructStripe(residuals.data(), y0, y1, depth);
+}
+
+static void putU32(uchar* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (uchar)(v >> (8 * i));
+}
+
+static uint32_t getU32(const uchar* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void encodeDepth(const cv::Mat& depth, std::vector<uchar>& out) {
+    if (depth.type() != CV_16U || depth.empty()) {
+        throw std::runtime_error("encodeDepth expects a non-empty CV_16U image");
+    }
+
+    const int numStripes = (depth.rows + kStripeRows - 1) / kStripeRows;
+    std::vector<std::vector<uchar>> stripes(numStripes);
+    cv::parallel_for_(cv::Range(0, numStripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            encodeStripe(depth, s * kStripeRows, std::min(depth.rows, (s + 1) * kStripeRows), stripes[s]);
+        }
+    });
+
+    const size_t headerSize = 20 + 4 * (size_t)numStripes;
+    size_t total = headerSize;
+    for (const auto& stripe : stripes) total += stripe.size();
+    out.resize(total);
+
+    uchar* p = out.data();
+    std::memcpy(p, "ZDP1", 4);
+    putU32(p + 4, depth.cols);
+    putU32(p + 8, depth.rows);
+    putU32(p + 12, kStripeRows);
+    putU32(p + 16, numStripes);
+    size_t offset = headerSize;
+    for (int s = 0; s < numStripes; ++s) {
+        size_t rawSize = (size_t)std::min(kStripeRows, depth.rows - s * kStripeRows) * depth.cols * 2;
+        uint32_t flag = stripes[s].size() == rawSize ? kRawStripe : 0;
+        putU32(p + 20 + 4 * s, (uint32_t)stripes[s].size() | flag);
+        std::memcpy(p + offset, stripes[s].data(), stripes[s].size());
+        offset += stripes[s].size();
+    }
+}
+
+void decodeDepth(const uchar* data, size_t size, cv::Mat& depth) {
+    if (size < 20 || std::memcmp(data, "ZDP1", 4) != 0) {
+        throw std::runtime_error("Not a depth stream");
+    }
+    const int width = (int)getU32(data + 4);
+    const int height = (int)getU32(data + 8);
+    const int stripeRows = (int)getU32(data + 12);
+    const int numStripes = (int)getU32(data + 16);
+    if (width <= 0 || height <= 0 || stripeRows <= 0 ||
+        numStripes != (height + stripeRows - 1) / stripeRows ||
+        size < 20 + 4 * (size_t)numStripes) {
+        throw std::runtime_error("Corrupt depth stream header");
+    }
+
+    std::vector<size_t> offsets(numStripes + 1, 20 + 4 * (size_t)numStripes);
+    std::vector<bool> raw(numStripes);
+    for (int s = 0; s < numStripes; ++s) {
+        uint32_t field = getU32(data + 20 + 4 * s);
+        raw[s] = (field & kRawStripe) != 0;
+        offsets[s + 1] = offsets[s] + (field & ~kRawStripe);
+    }
+    if (offsets[numStripes] > size) {
+        throw std::runtime_error("Truncated depth stream");
+    }
+
+    depth.create(height, width, CV_16U);
+    cv::parallel_for_(cv::Range(0, numStripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            decodeStripe(data + offsets[s], offsets[s + 1] - offsets[s], raw[s], depth,
+                         s * stripeRows, std::min(height, (s + 1) * stripeRows));
+        }
+    });
+}
+
+cv::Mat decodeDepth(const std::vector<uchar>& data) {
+    cv::Mat depth;
+    decodeDepth(data.data(), data.size(), depth);
+    return depth;
+}
+
+void writeDepthFile(const std::string& path, const cv::Mat& depth) {
+    std::vector<uchar> encoded;
+    encodeDepth(depth, encoded);
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size())) {
+        throw std::runtime_error("Cannot write depth file: " + path);
+    }
+}
+
+cv::Mat readDepthFile(const std::string& path) {
+    MappedFile file(path);
+    cv::Mat depth;
+    decodeDepth(reinterpret_cast<const uchar*>(file.data()), file.size(), depth);
+    return depth;
+}
+
+cv::Mat readDepthImage(const std::string& path) {
+    if (fs::path(path).extension() == kDepthFileExtension) {
+        return readDepthFile(path);
+    }
+    cv::Mat depth = cv::imread(path, cv::IMREAD_UNCHANGED);
+    if (depth.empty() || depth.type() != CV_16U) {
+        throw std::runtime_error("Not a 16-bit depth image: " + path);
+    }
+    return depth;
+}
@@ -0,0 +1,35 @@
+#ifndef DEPTH_CODEC_H
+#define DEPTH_CODEC_H
+
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Lossless codec for Z16 depth frames. Each pixel is predicted from its
+// left, upper and upper-left neighbors (LOCO-I median predictor) and the
+// residuals are Rice coded with a parameter chosen per block of 32
+// samples; blocks without residuals cost 5 bits. The frame is split into
+// stripes of rows that are coded independently, so encode and decode run
+// in parallel.
+//
+// Stream layout (little endian):
+//   "ZDP1", width, height, stripe rows, stripe count, stripe sizes[count]
+//   followed by the stripe bitstreams
+inline constexpr const char* kDepthFileExtension = ".zdepth";
+
+// depth must be CV_16U; out is resized to the encoded size
+void encodeDepth(const cv::Mat& depth, std::vector<uchar>& out);
+
+// Decodes into depth (CV_16U, reallocated only if the size changes)
+void decodeDepth(const uchar* data, size_t size, cv::Mat& depth);
+cv::Mat decodeDepth(const std::vector<uchar>& data);
+
+// .zdepth files
+void writeDepthFile(const std::string& path, const cv::Mat& depth);
+cv::Mat readDepthFile(const std::string& path);
+
+// Reads .zdepth or a 16-bit image (PNG/TIFF) as CV_16U
+cv::Mat readDepthImage(const std::string& path);
+
+#endif // DEPTH_CODEC_H
@@ -0,0 +1,252 @@
+#include "depth_filters.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+DepthFilterConfig loadDepthFilterConfig(const std::string& path) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot open depth filter config: " + path);
+    }
+
+    DepthFilterConfig config;
+    if (!fs["decimation"].empty()) config.decimation = std::max(1, (int)fs["decimation"]);
+    if (!fs["spatial"].empty()) config.spatial = (int)fs["spatial"] != 0;
+    if (!fs["spatial_alpha"].empty()) config.spatialAlpha = (float)fs["spatial_alpha"];
+    if (!fs["spatial_delta"].empty()) config.spatialDelta = (float)fs["spatial_delta"];
+    if (!fs["spatial_iterations"].empty()) config.spatialIterations = (int)fs["spatial_iterations"];
+    if (!fs["temporal"].empty()) config.temporal = (int)fs["temporal"] != 0;
+    if (!fs["temporal_alpha"].empty()) config.temporalAlpha = (float)fs["temporal_alpha"];
+    if (!fs["temporal_delta"].empty()) config.temporalDelta = (float)fs["temporal_delta"];
+    if (!fs["persistence"].empty()) config.persistence = (int)fs["persistence"];
+
+    if (!fs["hole_filling"].empty()) {
+        std::string mode = (std::string)fs["hole_filling"];
+        if (mode == "none") config.holeFilling = HoleFilling::None;
+        else if (mode == "fill_from_left") config.holeFilling = HoleFilling::FillFromLeft;
+        else if (mode == "farthest") config.holeFilling = HoleFilling::FarthestFromAround;
+        else if (mode == "nearest") config.holeFilling = HoleFilling::NearestFromAround;
+        else throw std::runtime_error("Unknown hole_filling mode: " + mode);
+    }
+    return config;
+}
+
+DepthFilterChain::DepthFilterChain(const DepthFilterConfig& config)
+    : config(config) {
+    this->config.decimation = std::max(1, config.decimation);
+    this->config.persistence = std::min(std::max(0, config.persistence), 255);
+}
+
+cv::Size DepthFilterChain::outputSize(const cv::Size& inputSize) const {
+    return cv::Size(inputSize.width / config.decimation, inputSize.height / config.decimation);
+}
+
+void DepthFilterChain::reset() {
+    hasHistory = false;
+}
+
+const cv::Mat& DepthFilterChain::process(const cv::Mat& depth) {
+    if (depth.type() != CV_16U) {
+        throw std::runtime_error("DepthFilterChain expects a CV_16U depth image");
+    }
+    cv::Size size = outputSize(depth.size());
+    if (size.area() == 0) {
+        throw std::runtime_error("Depth image is smaller than the decimation factor");
+    }
+
+    // Buffers only change with the frame size
+    if (work.size() != size) {
+        work.create(size, CV_32F);
+        history.create(size, CV_32F);
+        age.create(size, CV_8U);
+        output.create(size, CV_16U);
+        hasHistory = false;
+    }
+
+    const cv::Range rows(0, size.height);
+    cv::parallel_for_(rows, [this, &depth](const cv::Range& r) { decimateRows(depth, r); });
+
+    if (config.spatial) {
+        for (int i = 0; i < config.spatialIterations; ++i) {
+            // The first horizontal pass already ran inside decimateRows
+            if (i > 0) {
+                cv::parallel_for_(rows, [this](const cv::Range& r) { horizontalPass(r); });
+            }
+            cv::parallel_for_(cv::Range(0, size.width),
+                              [this](const cv::Range& r) { verticalPass(r); });
+        }
+    }
+
+    if (config.temporal) {
+        cv::parallel_for_(rows, [this](const cv::Range& r) { temporalRows(r); });
+        hasHistory = true;
+    }
+
+    cv::parallel_for_(rows, [this](const cv::Range& r) { fillRows(r); });
+    return output;
+}
+
+// Recursive edge-preserving smoothing of one line in both directions;
+// neighbors across a step larger than delta or a hole are left alone
+static void smoothLine(float* line, int length, int step, float alpha, float delta) {
+    float prev = line[0];
+    for (int i = 1; i < length; ++i) {
+        float& cur = line[i * step];
+        if (cur > 0 && prev > 0 && std::abs(cur - prev) < delta) {
+            cur = alpha * cur + (1.0f - alpha) * prev;
+        }
+        prev = cur;
+    }
+    prev = line[(length - 1) * step];
+    for (int i = length - 2; i >= 0; --i) {
+        float& cur = line[i * step];
+        if (cur > 0 && prev > 0 && std::abs(cur - prev) < delta) {
+            cur = alpha * cur + (1.0f - alpha) * prev;
+        }
+        prev = cur;
+    }
+}
+
+void DepthFilterChain::decimateRows(const cv::Mat& depth, const cv::Range& rows) {
+    const int f = config.decimation;
+    float block[64];
+    for (int y = rows.start; y < rows.end; ++y) {
+        float* out = work.ptr<float>(y);
+        if (f == 1) {
+            const ushort* in = depth.ptr<ushort>(y);
+            for (int x = 0; x < work.cols; ++x) {
+                out[x] = in[x];
+            }
+        } else {
+            // Median of the valid pixels of each f x f block for small
+            // factors, mean for larger ones; invalid only if all are holes
+            for (int x = 0; x < work.cols; ++x) {
+                int n = 0;
+                float sum = 0.0f;
+                for (int dy = 0; dy < f; ++dy) {
+                    const ushort* in = depth.ptr<ushort>(y * f + dy) + x * f;
+                    for (int dx = 0; dx < f; ++dx) {
+                        if (in[dx] == 0) continue;
+                        sum += in[dx];
+                        if (f <= 3) block[n] = in[dx];
+                        ++n;
+                    }
+                }
+                if (n == 0) {
+                    out[x] = 0.0f;
+                } else if (f <= 3) {
+                    std::nth_element(block, block + n / 2, block + n);
+                    out[x] = block[n / 2];
+                } else {
+                    out[x] = sum / n;
+                }
+            }
+        }
+
+        // Fused first horizontal spatial pass while the row is in cache
+        if (config.spatial && config.spatialIterations > 0) {
+            smoothLine(out, work.cols, 1, config.spatialAlpha, config.spatialDelta);
+        }
+    }
+}
+
+void DepthFilterChain::horizontalPass(const cv::Range& rows) {
+    for (int y = rows.start; y < rows.end; ++y) {
+        smoothLine(work.ptr<float>(y), work.cols, 1, config.spatialAlpha, config.spatialDelta);
+    }
+}
+
+void DepthFilterChain::verticalPass(const cv::Range& columns) {
+    // Walk the rows in order and update the whole column stripe per row,
+    // so memory is read row-contiguously instead of down single columns
+    const float alpha = config.spatialAlpha;
+    const float delta = config.spatialDelta;
+    for (int y = 1; y < work.rows; ++y) {
+        const float* prev = work.ptr<float>(y - 1);
+        float* cur = work.ptr<float>(y);
+        for (int x = columns.start; x < columns.end; ++x) {
+            if (cur[x] > 0 && prev[x] > 0 && std::abs(cur[x] - prev[x]) < delta) {
+                cur[x] = alpha * cur[x] + (1.0f - alpha) * prev[x];
+            }
+        }
+    }
+    for (int y = work.rows - 2; y >= 0; --y) {
+        const float* prev = work.ptr<float>(y + 1);
+        float* cur = work.ptr<float>(y);
+        for (int x = columns.start; x < columns.end; ++x) {
+            if (cur[x] > 0 && prev[x] > 0 && std::abs(cur[x] - prev[x]) < delta) {
+                cur[x] = alpha * cur[x] + (1.0f - alpha) * prev[x];
+            }
+        }
+    }
+}
+
+void DepthFilterChain::temporalRows(const cv::Range& rows) {
+    const float alpha = config.temporalAlpha;
+    const float delta = config.temporalDelta;
+    const uchar persistence = (uchar)config.persistence;
+    for (int y = rows.start; y < rows.end; ++y) {
+        float* cur = work.ptr<float>(y);
+        float* hist = history.ptr<float>(y);
+        uchar* missing = age.ptr<uchar>(y);
+        if (!hasHistory) {
+            for (int x = 0; x < work.cols; ++x) {
+                hist[x] = cur[x];
+                missing[x] = 0;
+            }
+            continue;
+        }
+        for (int x = 0; x < work.cols; ++x) {
+            if (cur[x] > 0) {
+                // Average only while the change is small, otherwise the
+                // scene moved and the new value replaces the history
+                if (hist[x] > 0 && std::abs(cur[x] - hist[x]) < delta) {
+                    cur[x] = alpha * cur[x] + (1.0f - alpha) * hist[x];
+                }
+                hist[x] = cur[x];
+                missing[x] = 0;
+            } else if (hist[x] > 0 && missing[x] < persistence) {
+                // Flickering pixel: hold the last value for a few frames
+                cur[x] = hist[x];
+                missing[x]++;
+            } else {
+                hist[x] = 0.0f;
+            }
+        }
+    }
+}
+
+void DepthFilterChain::fillRows(const cv::Range& rows) {
+    const HoleFilling mode = config.holeFilling;
+    const int cols = work.cols;
+    for (int y = rows.start; y < rows.end; ++y) {
+        const float* cur = work.ptr<float>(y);
+        const float* up = work.ptr<float>(std::max(0, y - 1));
+        const float* down = work.ptr<float>(std::min(work.rows - 1, y + 1));
+        ushort* out = output.ptr<ushort>(y);
+        float left = 0.0f;
+        for (int x = 0; x < cols; ++x) {
+            float value = cur[x];
+            if (value == 0.0f && mode != HoleFilling::None) {
+                if (mode == HoleFilling::FillFromLeft) {
+                    value = left;
+                } else {
+                    // Neighbors come from the unfilled frame, so the result
+                    // does not depend on the row split between threads
+                    float neighbors[4] = {x > 0 ? cur[x - 1] : 0.0f,
+                                          x + 1 < cols ? cur[x + 1] : 0.0f,
+                                          up[x], down[x]};
+                    for (float n : neighbors) {
+                        if (n == 0.0f) continue;
+                        if (value == 0.0f ||
+                            (mode == HoleFilling::FarthestFromAround ? n > value : n < value)) {
+                            value = n;
+                        }
+                    }
+                }
+            }
+            left = value;
+            out[x] = cv::saturate_cast<ushort>(value + 0.5f);
+        }
+    }
+}
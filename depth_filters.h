@@ -0,0 +1,69 @@
+#ifndef DEPTH_FILTERS_H
+#define DEPTH_FILTERS_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// How holes (depth 0) left after filtering are filled
+enum class HoleFilling {
+    None,
+    FillFromLeft,        // Last valid value to the left in the row
+    FarthestFromAround,  // Largest valid 4-neighbor (background-biased)
+    NearestFromAround    // Smallest valid 4-neighbor (foreground-biased)
+};
+
+// Parameters follow the RealSense post-processing filters; deltas are in
+// raw Z16 units (1 unit = 1 mm at the default depth scale)
+struct DepthFilterConfig {
+    int decimation = 2;              // Output is input / decimation, 1 = off
+    bool spatial = true;             // Edge-preserving recursive smoothing
+    float spatialAlpha = 0.5f;       // Weight of the current pixel
+    float spatialDelta = 20.0f;      // Steps larger than this are edges
+    int spatialIterations = 2;
+    bool temporal = true;            // Exponential smoothing over frames
+    float temporalAlpha = 0.4f;      // Weight of the current frame
+    float temporalDelta = 20.0f;     // Larger changes reset the average
+    int persistence = 3;             // Frames a value is held after it drops out
+    HoleFilling holeFilling = HoleFilling::FarthestFromAround;
+};
+
+// Keys: decimation, spatial, spatial_alpha, spatial_delta, spatial_iterations,
+// temporal, temporal_alpha, temporal_delta, persistence,
+// hole_filling (none, fill_from_left, farthest, nearest)
+DepthFilterConfig loadDepthFilterConfig(const std::string& path);
+
+// Decimation -> spatial -> temporal -> hole filling over CV_16U depth.
+// Decimation is fused with the first horizontal spatial pass and hole
+// filling with the conversion back to 16 bit, every pass runs row (or
+// column stripe) parallel, and all buffers are allocated once per frame
+// size, so steady-state processing does not allocate.
+class DepthFilterChain {
+public:
+    explicit DepthFilterChain(const DepthFilterConfig& config = DepthFilterConfig());
+
+    // Filter one frame. The result is owned by the chain and overwritten by
+    // the next call; it is smaller than the input when decimating.
+    const cv::Mat& process(const cv::Mat& depth);
+
+    // Forget the temporal history (e.g. after a camera move or seek)
+    void reset();
+
+    cv::Size outputSize(const cv::Size& inputSize) const;
+    const DepthFilterConfig& getConfig() const { return config; }
+
+private:
+    DepthFilterConfig config;
+    cv::Mat work;      // CV_32F working frame at output resolution
+    cv::Mat history;   // CV_32F temporal average
+    cv::Mat age;       // CV_8U frames since the pixel was last valid
+    cv::Mat output;    // CV_16U result
+    bool hasHistory = false;
+
+    void decimateRows(const cv::Mat& depth, const cv::Range& rows);
+    void horizontalPass(const cv::Range& rows);
+    void verticalPass(const cv::Range& columns);
+    void temporalRows(const cv::Range& rows);
+    void fillRows(const cv::Range& rows);
+};
+
+#endif // DEPTH_FILTERS_H
@@ -0,0 +1,78 @@
+#include "detection_cache.h"
+#include "mapped_file.h"
+#include "model_cache.h"
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+DetectionCache::DetectionCache(const std::string& cacheDir, uint64_t modelKey,
+                               const std::string& preprocessing)
+    : store((fs::path(cacheDir) / "detections.pack").string()),
+      resultKey(hashBytes(preprocessing.data(), preprocessing.size(), modelKey)),
+      indexPath((fs::path(cacheDir) / "content.index").string()) {
+    std::ifstream index(indexPath);
+    std::string line;
+    while (std::getline(index, line)) {
+        size_t tab = line.rfind('\t');
+        if (tab == std::string::npos) continue;
+        try {
+            contentIndex[line.substr(0, tab)] = std::stoull(line.substr(tab + 1), nullptr, 16);
+        } catch (const std::exception&) {
+            // Torn last line
+        }
+    }
+    indexOut.open(indexPath, std::ios::app);
+    if (!indexOut.good()) {
+        throw std::runtime_error("Cannot write detection cache index: " + indexPath);
+    }
+}
+
+std::string DetectionCache::entryName(uint64_t contentHash) const {
+    char name[40];
+    std::snprintf(name, sizeof(name), "%016llx:%016llx",
+                  (unsigned long long)contentHash, (unsigned long long)resultKey);
+    return name;
+}
+
+uint64_t DetectionCache::contentHash(const std::string& imagePath) {
+    std::ostringstream id;
+    id << fs::absolute(imagePath).string() << "\t" << fs::file_size(imagePath) << "\t"
+       << (long long)fs::last_write_time(imagePath).time_since_epoch().count();
+    std::string stamp = id.str();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = contentIndex.find(stamp);
+        if (it != contentIndex.end()) {
+            return it->second;
+        }
+    }
+
+    uint64_t hash;
+    {
+        MappedFile file(imagePath);
+        hash = hashBytes(file.data(), file.size());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (contentIndex.emplace(stamp, hash).second) {
+        indexOut << stamp << "\t" << std::hex << hash << std::dec << "\n";
+        indexOut.flush();
+    }
+    return hash;
+}
+
+bool DetectionCache::get(uint64_t contentHash, cv::Size& frameSize, std::vector<Detection>& candidates,
+                         const std::vector<std::string>& classNames) {
+    bool hit = store.get(entryName(contentHash), frameSize, candidates, classNames);
+    std::lock_guard<std::mutex> lock(mutex);
+    (hit ? hitCount : missCount)++;
+    return hit;
+}
+
+void DetectionCache::put(uint64_t contentHash, const cv::Size& frameSize,
+                         const std::vector<Detection>& candidates, float minConfidence) {
+    store.put(entryName(contentHash), frameSize, candidates, minConfidence);
+}
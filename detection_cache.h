@@ -0,0 +1,58 @@
+#ifndef DETECTION_CACHE_H
+#define DETECTION_CACHE_H
+
+#include "candidate_store.h"
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Content-addressed cache of detector results for batch annotation reruns.
+//
+// Entries are keyed by (image content hash, model hash, preprocessing) and
+// hold the pre-NMS candidates, so only new or changed images are inferred
+// and NMS settings can change without invalidating anything. A new model
+// (different cfg/weights bytes) or different preprocessing (input size,
+// precision, candidate floor) simply keys new entries. Renamed or copied
+// images still hit.
+//
+// Hashing every image on every run would cost a full read, so the content
+// hash of each (path, size, mtime) is remembered in <cacheDir>/content.index,
+// as ModelCache does for models: unchanged images cost one stat.
+class DetectionCache {
+public:
+    // modelKey: ModelCache::modelKey() of the model; preprocessing: any text
+    // that changes whenever the outputs would (e.g. "size=416 fp32 conf=0.5")
+    DetectionCache(const std::string& cacheDir, uint64_t modelKey, const std::string& preprocessing);
+
+    // Hash of the file bytes; thread-safe
+    uint64_t contentHash(const std::string& imagePath);
+
+    // Thread-safe
+    bool get(uint64_t contentHash, cv::Size& frameSize, std::vector<Detection>& candidates,
+             const std::vector<std::string>& classNames = {});
+    // minConfidence: threshold the candidates were decoded with
+    void put(uint64_t contentHash, const cv::Size& frameSize, const std::vector<Detection>& candidates,
+             float minConfidence);
+
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    CandidateStore store;
+    uint64_t resultKey;             // Model + preprocessing
+    std::string indexPath;
+    std::unordered_map<std::string, uint64_t> contentIndex;     // "path\tsize\tmtime" -> hash
+    std::ofstream indexOut;
+    std::mutex mutex;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+
+    std::string entryName(uint64_t contentHash) const;
+};
+
+#endif // DETECTION_CACHE_H
@@ -0,0 +1,212 @@
+#include "detection_eval.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+const int kRecallPoints = 101;
+
+float iouThreshold(int t) {
+    return 0.5f + 0.05f * t;
+}
+
+// Prediction after matching: bit t set = true positive at iouThreshold(t)
+struct Match {
+    float confidence;
+    uint16_t truePositive;
+};
+
+// 101-point interpolated AP; precisionAtRecall receives the envelope
+double sweepAP(const std::vector<Match>& matches, int t, size_t numTruth,
+               std::vector<double>* precisionAtRecall) {
+    std::vector<double> recall(matches.size()), precision(matches.size());
+    size_t tp = 0;
+    for (size_t i = 0; i < matches.size(); ++i) {
+        tp += (matches[i].truePositive >> t) & 1;
+        recall[i] = (double)tp / numTruth;
+        precision[i] = (double)tp / (i + 1);
+    }
+    // Precision envelope: best precision at this recall or higher
+    for (size_t i = precision.size(); i-- > 1;) {
+        precision[i - 1] = std::max(precision[i - 1], precision[i]);
+    }
+
+    std::vector<double> sampled(kRecallPoints, 0.0);
+    size_t i = 0;
+    for (int r = 0; r < kRecallPoints; ++r) {
+        double target = r / (double)(kRecallPoints - 1);
+        while (i < recall.size() && recall[i] < target) ++i;
+        if (i == recall.size()) break;
+        sampled[r] = precision[i];
+    }
+    if (precisionAtRecall) *precisionAtRecall = sampled;
+
+    double sum = 0;
+    for (double p : sampled) sum += p;
+    return sum / kRecallPoints;
+}
+
+} // namespace
+
+DetectionEvaluator::DetectionEvaluator(int numClasses, int maxDetections)
+    : numClasses(numClasses), maxDetections(maxDetections) {}
+
+void DetectionEvaluator::add(const std::vector<YoloLabel>& truth,
+                             const std::vector<ScoredLabel>& predictions) {
+    auto toBox = [](const YoloLabel& label, float confidence) {
+        return Box{label.class_id, confidence, labelRect(label)};
+    };
+
+    Image image;
+    image.truth.reserve(truth.size());
+    for (const auto& label : truth) {
+        if (label.class_id >= 0 && label.class_id < numClasses) {
+            image.truth.push_back(toBox(label, 1.0f));
+        }
+    }
+    image.predictions.reserve(predictions.size());
+    for (const auto& scored : predictions) {
+        if (scored.label.class_id >= 0 && scored.label.class_id < numClasses) {
+            image.predictions.push_back(toBox(scored.label, scored.confidence));
+        }
+    }
+    std::stable_sort(image.predictions.begin(), image.predictions.end(),
+                     [](const Box& a, const Box& b) { return a.confidence > b.confidence; });
+
+    // Keep the top maxDetections of each class, as COCO does per category
+    std::vector<int> kept(numClasses, 0);
+    size_t end = 0;
+    for (const Box& box : image.predictions) {
+        if (kept[box.classId]++ < maxDetections) {
+            image.predictions[end++] = box;
+        }
+    }
+    image.predictions.resize(end);
+    images.push_back(std::move(image));
+}
+
+EvaluationResult DetectionEvaluator::evaluate() const {
+    EvaluationResult result;
+    result.images = images.size();
+
+    // Match every image at all IoU thresholds; matches[i][p] belongs to
+    // images[i].predictions[p]
+    std::vector<std::vector<Match>> matches(images.size());
+    cv::parallel_for_(cv::Range(0, (int)images.size()), [&](const cv::Range& range) {
+        std::vector<uint16_t> taken;
+        for (int i = range.start; i < range.end; ++i) {
+            const Image& image = images[i];
+            matches[i].resize(image.predictions.size());
+            taken.assign(image.truth.size(), 0);
+
+            for (size_t p = 0; p < image.predictions.size(); ++p) {
+                const Box& pred = image.predictions[p];
+                Match& match = matches[i][p];
+                match.confidence = pred.confidence;
+                match.truePositive = 0;
+
+                for (int t = 0; t < kNumIouThresholds; ++t) {
+                    // Best unmatched ground truth of the class above the threshold
+                    int best = -1;
+                    float bestIou = iouThreshold(t) - 1e-6f;
+                    for (size_t g = 0; g < image.truth.size(); ++g) {
+                        const Box& truth = image.truth[g];
+                        if (truth.classId != pred.classId || ((taken[g] >> t) & 1)) continue;
+                        float iou = boxIoU(pred.box, truth.box);
+                        if (iou >= bestIou) {
+                            bestIou = iou;
+                            best = (int)g;
+                        }
+                    }
+                    if (best >= 0) {
+                        taken[best] |= (uint16_t)(1 << t);
+                        match.truePositive |= (uint16_t)(1 << t);
+                    }
+                }
+            }
+        }
+    });
+
+    // Gather per class, then one sorted sweep per class and threshold
+    std::vector<std::vector<Match>> perClass(numClasses);
+    result.classes.resize(numClasses);
+    for (size_t i = 0; i < images.size(); ++i) {
+        for (const auto& truth : images[i].truth) {
+            result.classes[truth.classId].numTruth++;
+        }
+        for (size_t p = 0; p < images[i].predictions.size(); ++p) {
+            perClass[images[i].predictions[p].classId].push_back(matches[i][p]);
+        }
+    }
+
+    cv::parallel_for_(cv::Range(0, numClasses), [&](const cv::Range& range) {
+        for (int c = range.start; c < range.end; ++c) {
+            ClassEvaluation& eval = result.classes[c];
+            std::vector<Match>& classMatches = perClass[c];
+            eval.classId = c;
+            eval.numPredictions = classMatches.size();
+            eval.ap.fill(-1.0);
+            if (eval.numTruth == 0) continue;
+
+            std::stable_sort(classMatches.begin(), classMatches.end(),
+                             [](const Match& a, const Match& b) { return a.confidence > b.confidence; });
+            double sum = 0;
+            for (int t = 0; t < kNumIouThresholds; ++t) {
+                eval.ap[t] = sweepAP(classMatches, t, eval.numTruth, t == 0 ? &eval.precisionAt50 : nullptr);
+                sum += eval.ap[t];
+            }
+            eval.apMean = sum / kNumIouThresholds;
+        }
+    });
+
+    int evaluated = 0;
+    for (const auto& eval : result.classes) {
+        result.truths += eval.numTruth;
+        result.predictions += eval.numPredictions;
+        if (eval.numTruth == 0) continue;
+        result.map += eval.apMean;
+        result.map50 += eval.ap[0];
+        result.map75 += eval.ap[5];
+        evaluated++;
+    }
+    if (evaluated > 0) {
+        result.map /= evaluated;
+        result.map50 /= evaluated;
+        result.map75 /= evaluated;
+    }
+    return result;
+}
+
+MatchCounts countMatches(const std::vector<YoloLabel>& truth, const std::vector<ScoredLabel>& predictions,
+                         float iouThreshold) {
+    std::vector<size_t> order(predictions.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return predictions[a].confidence > predictions[b].confidence;
+    });
+
+    MatchCounts counts;
+    std::vector<bool> taken(truth.size(), false);
+    for (size_t i : order) {
+        const YoloLabel& pred = predictions[i].label;
+        int best = -1;
+        float bestIou = iouThreshold - 1e-6f;
+        for (size_t g = 0; g < truth.size(); ++g) {
+            if (taken[g] || truth[g].class_id != pred.class_id) continue;
+            float iou = boxIoU(labelRect(pred), labelRect(truth[g]));
+            if (iou >= bestIou) {
+                bestIou = iou;
+                best = (int)g;
+            }
+        }
+        if (best >= 0) {
+            taken[best] = true;
+            counts.truePositives++;
+        } else {
+            counts.falsePositives++;
+        }
+    }
+    counts.falseNegatives = truth.size() - counts.truePositives;
+    return counts;
+}
@@ -0,0 +1,72 @@
+#ifndef DETECTION_EVAL_H
+#define DETECTION_EVAL_H
+
+#include "yolo_labels.h"
+#include <array>
+#include <string>
+#include <vector>
+
+// COCO-style detection accuracy: AP averaged over IoU 0.50:0.05:0.95 with
+// 101-point interpolated precision, at most maxDetections per image and class.
+
+const int kNumIouThresholds = 10;
+
+struct ClassEvaluation {
+    int classId = 0;
+    size_t numTruth = 0;
+    size_t numPredictions = 0;
+    std::array<double, kNumIouThresholds> ap{};     // Per IoU threshold, -1 = no ground truth
+    double apMean = -1;                             // AP@[.5:.95]
+    std::vector<double> precisionAt50;              // PR curve at IoU 0.5, recall 0.00..1.00
+};
+
+struct EvaluationResult {
+    size_t images = 0;
+    size_t truths = 0;
+    size_t predictions = 0;
+    double map = 0;         // mAP@[.5:.95] over classes with ground truth
+    double map50 = 0;
+    double map75 = 0;
+    std::vector<ClassEvaluation> classes;
+};
+
+// Collects ground truth and predictions per image, then matches and sweeps
+// in parallel: images are matched independently (greedy by confidence, as
+// COCO), and each class is one sorted sweep over its matched predictions.
+// Boxes are compared in normalized coordinates, so image sizes are not needed.
+class DetectionEvaluator {
+public:
+    explicit DetectionEvaluator(int numClasses, int maxDetections = 100);
+
+    // Images must be added from one thread
+    void add(const std::vector<YoloLabel>& truth, const std::vector<ScoredLabel>& predictions);
+    EvaluationResult evaluate() const;
+
+private:
+    struct Box {
+        int classId;
+        float confidence;
+        cv::Rect2f box;
+    };
+    struct Image {
+        std::vector<Box> truth;
+        std::vector<Box> predictions;   // Confidence descending, maxDetections per class
+    };
+
+    int numClasses;
+    int maxDetections;
+    std::vector<Image> images;
+};
+
+// Detections at a fixed operating point: predictions are matched greedily
+// by confidence to unmatched ground truth of the same class
+struct MatchCounts {
+    size_t truePositives = 0;
+    size_t falsePositives = 0;
+    size_t falseNegatives = 0;
+};
+
+MatchCounts countMatches(const std::vector<YoloLabel>& truth, const std::vector<ScoredLabel>& predictions,
+                         float iouThreshold = 0.5f);
+
+#endif // DETECTION_EVAL_H
@@ -0,0 +1,179 @@
+#include "ensemble_detector.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+EnsembleDetector::EnsembleDetector(const std::vector<EnsembleMember>& specs,
+                                   float nmsThreshold,
+                                   float fusionIoU)
+    : nmsThreshold(nmsThreshold), fusionIoU(fusionIoU) {
+    if (specs.empty()) {
+        throw std::invalid_argument("Ensemble needs at least one model");
+    }
+
+    for (const auto& spec : specs) {
+        Member member;
+        member.spec = spec;
+        member.session = std::make_unique<ModelSession>(spec.configPath, spec.weightsPath,
+                                                        spec.inputSize, spec.backend);
+        member.classNames = loadClassNames(spec.classFile);
+
+        // Map member classes onto the union of class names
+        for (const auto& name : member.classNames) {
+            auto it = std::find(classNames.begin(), classNames.end(), name);
+            int id = (int)(it - classNames.begin());
+            if (it == classNames.end()) {
+                classNames.push_back(name);
+                classWeight.push_back(0.0f);
+            }
+            member.classRemap.push_back(id);
+            classWeight[id] += spec.weight;
+        }
+
+        // Members with the same input size share one preprocessed blob
+        auto size_it = std::find(blobSizes.begin(), blobSizes.end(), spec.inputSize);
+        member.blobIndex = (int)(size_it - blobSizes.begin());
+        if (size_it == blobSizes.end()) {
+            blobSizes.push_back(spec.inputSize);
+        }
+
+        members.push_back(std::move(member));
+    }
+    sharedBlobs.resize(blobSizes.size());
+
+    if (members.size() > 1) {
+        pool = std::make_unique<ThreadPool>(members.size());
+    }
+}
+
+std::vector<Detection> EnsembleDetector::runMember(Member& member,
+                                                   const cv::Size& frameSize,
+                                                   float minConfidence) {
+    const std::vector<cv::Mat>& outs = member.session->forward(sharedBlobs[member.blobIndex]);
+    std::vector<Detection> detections = decodeYoloOutputs(outs, frameSize, minConfidence,
+                                                          member.classNames);
+    for (auto& det : detections) {
+        det.class_id = member.classRemap[det.class_id];
+    }
+    return detections;
+}
+
+std::vector<Detection> EnsembleDetector::detect(const cv::Mat& frame, float minConfidence) {
+    // Preprocess once per distinct input size
+    {
+        ScopedTimer timer(Stage::Preprocess);
+        for (size_t i = 0; i < blobSizes.size(); ++i) {
+            cv::dnn::blobFromImage(frame, sharedBlobs[i], 1/255.0, blobSizes[i],
+                                  cv::Scalar(0,0,0), true, false, CV_32F);
+        }
+    }
+
+    if (members.size() == 1) {
+        return runMember(members[0], frame.size(), minConfidence);
+    }
+
+    // All sessions run concurrently, so wall time follows the slowest model
+    std::vector<std::future<std::vector<Detection>>> pending;
+    for (auto& member : members) {
+        Member* m = &member;
+        cv::Size frameSize = frame.size();
+        pending.push_back(pool->submit([this, m, frameSize, minConfidence] {
+            return suppressDetections(runMember(*m, frameSize, minConfidence),
+                                      minConfidence, nmsThreshold);
+        }));
+    }
+
+    std::vector<std::vector<Detection>> perModel;
+    std::vector<float> modelWeights;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        perModel.push_back(pending[i].get());
+        modelWeights.push_back(members[i].spec.weight);
+    }
+
+    std::vector<Detection> fused = weightedBoxFusion(perModel, modelWeights,
+                                                     classWeight, fusionIoU);
+    for (auto& det : fused) {
+        det.class_name = classNames[det.class_id];
+    }
+
+    // Fusion lowers the score of boxes only some models agreed on
+    fused.erase(std::remove_if(fused.begin(), fused.end(),
+                               [minConfidence](const Detection& d) {
+                                   return d.confidence <= minConfidence;
+                               }),
+                fused.end());
+    return fused;
+}
+
+std::vector<Detection> weightedBoxFusion(const std::vector<std::vector<Detection>>& perModel,
+                                         const std::vector<float>& modelWeights,
+                                         const std::vector<float>& classWeight,
+                                         float iouThreshold) {
+    ScopedTimer timer(Stage::Nms);
+    struct Candidate {
+        const Detection* det;
+        float score;    // Confidence scaled by the model weight
+    };
+    struct Cluster {
+        int classId;
+        float scoreSum;
+        float x1, y1, x2, y2;      // Score-weighted coordinate sums
+        float runnerUp;
+        cv::Rect fusedBox;
+    };
+
+    std::vector<Candidate> candidates;
+    for (size_t m = 0; m < perModel.size(); ++m) {
+        for (const auto& det : perModel[m]) {
+            candidates.push_back({&det, det.confidence * modelWeights[m]});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+    std::vector<Cluster> clusters;
+    for (const auto& cand : candidates) {
+        const cv::Rect& box = cand.det->box;
+
+        int best = -1;
+        float bestIoU = iouThreshold;
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            if (clusters[c].classId != cand.det->class_id) continue;
+            float overlap = boxIoU(clusters[c].fusedBox, box);
+            if (overlap > bestIoU) {
+                bestIoU = overlap;
+                best = (int)c;
+            }
+        }
+
+        if (best < 0) {
+            clusters.push_back({cand.det->class_id, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, box});
+            best = (int)clusters.size() - 1;
+        }
+
+        Cluster& cluster = clusters[best];
+        cluster.scoreSum += cand.score;
+        cluster.x1 += cand.score * box.x;
+        cluster.y1 += cand.score * box.y;
+        cluster.x2 += cand.score * (box.x + box.width);
+        cluster.y2 += cand.score * (box.y + box.height);
+        cluster.runnerUp = std::max(cluster.runnerUp, cand.det->runner_up);
+        cluster.fusedBox = cv::Rect(cv::Point(cvRound(cluster.x1 / cluster.scoreSum),
+                                              cvRound(cluster.y1 / cluster.scoreSum)),
+                                    cv::Point(cvRound(cluster.x2 / cluster.scoreSum),
+                                              cvRound(cluster.y2 / cluster.scoreSum)));
+    }
+
+    std::vector<Detection> fused;
+    fused.reserve(clusters.size());
+    for (const auto& cluster : clusters) {
+        Detection det;
+        det.box = cluster.fusedBox;
+        det.confidence = std::min(1.0f, cluster.scoreSum / classWeight[cluster.classId]);
+        det.runner_up = cluster.runnerUp;
+        det.class_id = cluster.classId;
+        fused.push_back(det);
+    }
+    return fused;
+}
@@ -0,0 +1,70 @@
+#ifndef ENSEMBLE_DETECTOR_H
+#define ENSEMBLE_DETECTOR_H
+
+#include "model_session.h"
+#include "thread_pool.h"
+#include "yolo_detection.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// One model taking part in the ensemble
+struct EnsembleMember {
+    std::string configPath;
+    std::string weightsPath;
+    std::string classFile;
+    float weight = 1.0f;                        // Vote weight in box fusion
+    cv::Size inputSize = cv::Size(416, 416);
+    BackendConfig backend;
+};
+
+// Runs N model sessions concurrently on a thread pool and fuses their
+// outputs with weighted box fusion. Members with the same input size share
+// one preprocessed blob. Class ids refer to the union of all members'
+// class names (first member's names first), see getClassNames().
+class EnsembleDetector {
+public:
+    // Constructors
+    EnsembleDetector(const std::vector<EnsembleMember>& members,
+                     float nmsThreshold = 0.4f,
+                     float fusionIoU = 0.55f);
+
+    // Detections above minConfidence. A single member is run inline and
+    // returned without NMS or fusion, exactly like a plain detector.
+    std::vector<Detection> detect(const cv::Mat& frame, float minConfidence);
+
+    const std::vector<std::string>& getClassNames() const { return classNames; }
+    size_t size() const { return members.size(); }
+
+private:
+    struct Member {
+        EnsembleMember spec;
+        std::unique_ptr<ModelSession> session;
+        std::vector<std::string> classNames;
+        std::vector<int> classRemap;     // Member class id -> ensemble class id
+        int blobIndex;                   // Index into sharedBlobs
+    };
+
+    std::vector<Member> members;
+    std::vector<std::string> classNames;
+    std::vector<float> classWeight;      // Sum of weights of members knowing the class
+    std::vector<cv::Size> blobSizes;
+    std::vector<cv::Mat> sharedBlobs;
+    std::unique_ptr<ThreadPool> pool;
+    float nmsThreshold;
+    float fusionIoU;
+
+    std::vector<Detection> runMember(Member& member, const cv::Size& frameSize,
+                                     float minConfidence);
+};
+
+// Weighted box fusion over per-model detections. Boxes of the same class
+// overlapping a fused box by more than iouThreshold are merged into it:
+// coordinates are averaged by score and the score is the summed member
+// score divided by classWeight[class_id].
+std::vector<Detection> weightedBoxFusion(const std::vector<std::vector<Detection>>& perModel,
+                                         const std::vector<float>& modelWeights,
+                                         const std::vector<float>& classWeight,
+                                         float iouThreshold);
+
+#endif // ENSEMBLE_DETECTOR_H
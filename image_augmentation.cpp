@@ -0,0 +1,71 @@
+#include "image_augmentation.h"
+
+cv::Mat augmentOriginal(const cv::Mat& img) {
+    return img;
+}
+
+cv::Mat augmentFlip(const cv::Mat& img) {
+    cv::Mat flipped;
+    cv::flip(img, flipped, 1);
+    return flipped;
+}
+
+cv::Mat augmentRotate(const cv::Mat& img) {
+    cv::Mat rotated;
+    cv::Point2f center(img.cols / 2.0, img.rows / 2.0);
+    cv::Mat rotMat = cv::getRotationMatrix2D(center, 30, 1.0);
+    cv::warpAffine(img, rotated, rotMat, img.size());
+    return rotated;
+}
+
+cv::Mat augmentBrightness(const cv::Mat& img) {
+    cv::Mat bright;
+    img.convertTo(bright, -1, 1, 50); // increase the brightness
+    return bright;
+}
+
+cv::Mat augmentBlur(const cv::Mat& img) {
+    cv::Mat blurred;
+    cv::GaussianBlur(img, blurred, cv::Size(5, 5), 0);
+    return blurred;
+}
+
+cv::Mat augmentScale(const cv::Mat& img) {
+    cv::Mat scaled;
+    cv::resize(img, scaled, cv::Size(), 0.5, 0.5);
+    return scaled;
+}
+
+cv::Mat augmentContrast(const cv::Mat& img) {
+    cv::Mat contrast;
+    img.convertTo(contrast, -1, 1.5, 0); // increase the contrast
+    return contrast;
+}
+
+cv::Mat augmentNoise(const cv::Mat& img) {
+    cv::Mat noise = cv::Mat(img.size(), img.type());
+    cv::randn(noise, 0, 25); // Gaussian noise
+    return img + noise;
+}
+
+const std::vector<AugmentationBranch>& augmentationBranches() {
+    static const std::vector<AugmentationBranch> branches = {
+        {"original", augmentOriginal},
+        {"flip", augmentFlip},
+        {"rotate", augmentRotate},
+        {"brightness", augmentBrightness},
+        {"blur", augmentBlur},
+        {"scale", augmentScale},
+        {"contrast", augmentContrast},
+        {"noise", augmentNoise},
+    };
+    return branches;
+}
+
+std::vector<cv::Mat> augmentImage(const cv::Mat& img) {
+    std::vector<cv::Mat> augmentedImages;
+    for (const auto& branch : augmentationBranches()) {
+        augmentedImages.push_back(branch.apply(img));
+    }
+    return augmentedImages;
+}
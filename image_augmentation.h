@@ -0,0 +1,29 @@
+#ifndef IMAGE_AUGMENTATION_H
+#define IMAGE_AUGMENTATION_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// One augmentation branch: output = apply(input)
+struct AugmentationBranch {
+    std::string name;
+    cv::Mat (*apply)(const cv::Mat& img);
+};
+
+// Individual branches, in the order augmentImage() emits them
+cv::Mat augmentOriginal(const cv::Mat& img);
+cv::Mat augmentFlip(const cv::Mat& img);          // Flip horizontally
+cv::Mat augmentRotate(const cv::Mat& img);        // Rotate by 30 degrees
+cv::Mat augmentBrightness(const cv::Mat& img);    // +50 brightness
+cv::Mat augmentBlur(const cv::Mat& img);          // 5x5 Gaussian blur
+cv::Mat augmentScale(const cv::Mat& img);         // Half size
+cv::Mat augmentContrast(const cv::Mat& img);      // x1.5 contrast
+cv::Mat augmentNoise(const cv::Mat& img);         // Gaussian noise, sigma 25 (cv::theRNG())
+
+const std::vector<AugmentationBranch>& augmentationBranches();
+
+// Apply every branch to the image
+std::vector<cv::Mat> augmentImage(const cv::Mat& img);
+
+#endif // IMAGE_AUGMENTATION_H
@@ -0,0 +1,83 @@
+#include "image_header.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+uint32_t bigEndian16(const unsigned char* p) { return (p[0] << 8) | p[1]; }
+uint32_t bigEndian32(const unsigned char* p) { return (bigEndian16(p) << 16) | bigEndian16(p + 2); }
+int32_t littleEndian32(const unsigned char* p) {
+    return (int32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+// Walks the marker segments up to the first start-of-frame; only segment
+// headers are read, EXIF and other payloads are skipped with seekg
+cv::Size jpegSize(std::ifstream& file) {
+    file.seekg(2);
+    unsigned char header[9];
+    while (file.read(reinterpret_cast<char*>(header), 2)) {
+        if (header[0] != 0xFF) return cv::Size();
+        unsigned char marker = header[1];
+        if (marker == 0xFF) {                   // Fill byte
+            file.seekg(-1, std::ios::cur);
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;    // No payload
+        if (marker == 0xD9 || marker == 0xDA) return cv::Size();               // EOI / scan before SOF
+
+        if (!file.read(reinterpret_cast<char*>(header + 2), 2)) return cv::Size();
+        uint32_t length = bigEndian16(header + 2);
+        if (length < 2) return cv::Size();
+
+        // SOF0..SOF15 except DHT (C4), JPG (C8) and DAC (CC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (!file.read(reinterpret_cast<char*>(header + 4), 5)) return cv::Size();
+            return cv::Size((int)bigEndian16(header + 7), (int)bigEndian16(header + 5));
+        }
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return cv::Size();
+}
+
+} // namespace
+
+cv::Size readImageSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char header[26];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return cv::Size();
+    }
+
+    if (header[0] == 0xFF && header[1] == 0xD8) {
+        return jpegSize(file);
+    }
+    static const unsigned char kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (std::memcmp(header, kPngSignature, sizeof(kPngSignature)) == 0 &&
+        std::memcmp(header + 12, "IHDR", 4) == 0) {
+        return cv::Size((int)bigEndian32(header + 16), (int)bigEndian32(header + 20));
+    }
+    if (header[0] == 'B' && header[1] == 'M') {
+        // BITMAPINFOHEADER; a negative height marks a top-down bitmap
+        return cv::Size(littleEndian32(header + 18), std::abs(littleEndian32(header + 22)));
+    }
+    return cv::Size();
+}
+
+cv::Size imageSize(const std::string& path) {
+    cv::Size size = readImageSize(path);
+    if (size.area() > 0) {
+        return size;
+    }
+    cv::Mat image = cv::imread(path);
+    return image.size();
+}
+
+bool isImageFile(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp";
+}
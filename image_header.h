@@ -0,0 +1,20 @@
+#ifndef IMAGE_HEADER_H
+#define IMAGE_HEADER_H
+
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <string>
+
+// Image dimensions from the file header alone (JPEG SOF marker, PNG IHDR,
+// BMP info header), without decoding any pixels. Reads a few hundred bytes
+// for a typical JPEG instead of the whole file. Returns an empty size for
+// unreadable files and other formats; callers fall back to cv::imread.
+cv::Size readImageSize(const std::string& path);
+
+// Header read with a full decode as fallback; empty if unreadable
+cv::Size imageSize(const std::string& path);
+
+// Image extension the dataset tools pick up (.jpg, .jpeg, .png, .bmp, any case)
+bool isImageFile(const std::filesystem::path& path);
+
+#endif // IMAGE_HEADER_H
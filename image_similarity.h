@@ -0,0 +1,10 @@
+#ifndef IMAGE_SIMILARITY_H
+#define IMAGE_SIMILARITY_H
+
+#include <opencv2/opencv.hpp>
+
+// Mean structural similarity (SSIM) of two BGR or grayscale images of the
+// same size, on grayscale with an 11x11 Gaussian window (sigma 1.5)
+double computeSSIM(const cv::Mat& img1, const cv::Mat& img2);
+
+#endif // IMAGE_SIMILARITY_H
@@ -0,0 +1,287 @@
+#include "inference_backend.h"
+#include "model_cache.h"
+#include "model_quantization.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool hasOpenCvBackend(int backend, int target) {
+    for (const auto& available : cv::dnn::getAvailableBackends()) {
+        if (available.first == backend && available.second == target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef HAVE_ONNXRUNTIME
+// ONNX Runtime CPU engine. Outputs are flattened to rows x last-dim Mats,
+// the same layout cv::dnn returns for YOLO heads.
+class OnnxRuntimeEngine : public InferenceEngine {
+public:
+    OnnxRuntimeEngine(const std::string& modelPath, int numThreads)
+        : env(ORT_LOGGING_LEVEL_WARNING, "annotator"),
+          session(nullptr),
+          memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
+        Ort::SessionOptions options;
+        if (numThreads > 0) {
+            options.SetIntraOpNumThreads(numThreads);
+        }
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        session = Ort::Session(env, modelPath.c_str(), options);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        for (size_t i = 0; i < session.GetInputCount(); ++i) {
+            inputNames.push_back(session.GetInputNameAllocated(i, allocator).get());
+        }
+        for (size_t i = 0; i < session.GetOutputCount(); ++i) {
+            outputNames.push_back(session.GetOutputNameAllocated(i, allocator).get());
+        }
+        for (const auto& n : inputNames) inputNamePtrs.push_back(n.c_str());
+        for (const auto& n : outputNames) outputNamePtrs.push_back(n.c_str());
+    }
+
+    void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) override {
+        std::vector<int64_t> shape(blob.size.p, blob.size.p + blob.dims);
+        Ort::Value input = Ort::Value::CreateTensor<float>(
+            memoryInfo, (float*)blob.data, blob.total(), shape.data(), shape.size());
+
+        auto results = session.Run(Ort::RunOptions{nullptr},
+                                   inputNamePtrs.data(), &input, 1,
+                                   outputNamePtrs.data(), outputNamePtrs.size());
+
+        outputs.resize(results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto info = results[i].GetTensorTypeAndShapeInfo();
+            int cols = (int)info.GetShape().back();
+            int rows = (int)(info.GetElementCount() / cols);
+            // copyTo keeps outputs[i]'s buffer when the shape is unchanged
+            cv::Mat(rows, cols, CV_32F, results[i].GetTensorMutableData<float>()).copyTo(outputs[i]);
+        }
+    }
+
+    std::string name() const override { return "onnxruntime"; }
+
+private:
+    Ort::Env env;
+    Ort::Session session;
+    Ort::MemoryInfo memoryInfo;
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+    std::vector<const char*> inputNamePtrs;
+    std::vector<const char*> outputNamePtrs;
+};
+#endif
+
+} // namespace
+
+BackendKind parseBackendKind(const std::string& name) {
+    if (name == "opencv" || name == "cpu") return BackendKind::OpenCvCpu;
+    if (name == "openvino") return BackendKind::OpenCvOpenVino;
+    if (name == "cuda") return BackendKind::OpenCvCuda;
+    if (name == "onnxruntime" || name == "ort") return BackendKind::OnnxRuntimeCpu;
+    throw std::invalid_argument("Unknown inference backend: " + name);
+}
+
+std::string backendName(BackendKind kind) {
+    switch (kind) {
+        case BackendKind::OpenCvCpu: return "opencv";
+        case BackendKind::OpenCvOpenVino: return "openvino";
+        case BackendKind::OpenCvCuda: return "cuda";
+        case BackendKind::OnnxRuntimeCpu: return "onnxruntime";
+    }
+    return "unknown";
+}
+
+Precision parsePrecision(const std::string& name) {
+    if (name == "fp32") return Precision::Fp32;
+    if (name == "fp16") return Precision::Fp16;
+    if (name == "int8") return Precision::Int8;
+    throw std::invalid_argument("Unknown precision: " + name);
+}
+
+std::string precisionName(Precision precision) {
+    switch (precision) {
+        case Precision::Fp32: return "fp32";
+        case Precision::Fp16: return "fp16";
+        case Precision::Int8: return "int8";
+    }
+    return "unknown";
+}
+
+BackendConfig loadBackendConfig(const std::string& path) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot open backend config: " + path);
+    }
+
+    BackendConfig config;
+    if (!fs["backend"].empty()) {
+        config.kind = parseBackendKind((std::string)fs["backend"]);
+    }
+    if (!fs["threads"].empty()) {
+        config.numThreads = (int)fs["threads"];
+    }
+    if (!fs["precision"].empty()) {
+        config.precision = parsePrecision((std::string)fs["precision"]);
+    }
+    if (!fs["calibration"].empty()) {
+        config.calibrationFile = (std::string)fs["calibration"];
+    }
+    if (!fs["model_cache"].empty()) {
+        config.modelCacheDir = (std::string)fs["model_cache"];
+    }
+    return config;
+}
+
+BackendConfig resolveBackendConfig(const std::string& nameOrFile, int numThreads) {
+    BackendConfig config;
+    if (endsWith(nameOrFile, ".yml") || endsWith(nameOrFile, ".yaml") ||
+        endsWith(nameOrFile, ".json")) {
+        config = loadBackendConfig(nameOrFile);
+    } else {
+        config.kind = parseBackendKind(nameOrFile);
+    }
+    if (numThreads > 0) {
+        config.numThreads = numThreads;
+    }
+    return config;
+}
+
+bool isBackendAvailable(BackendKind kind) {
+    switch (kind) {
+        case BackendKind::OpenCvCpu:
+            return true;
+        case BackendKind::OpenCvOpenVino:
+            return hasOpenCvBackend(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE, cv::dnn::DNN_TARGET_CPU);
+        case BackendKind::OpenCvCuda:
+            return hasOpenCvBackend(cv::dnn::DNN_BACKEND_CUDA, cv::dnn::DNN_TARGET_CUDA);
+        case BackendKind::OnnxRuntimeCpu:
+#ifdef HAVE_ONNXRUNTIME
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+std::vector<BackendKind> availableBackends() {
+    std::vector<BackendKind> kinds;
+    for (BackendKind kind : {BackendKind::OpenCvCpu, BackendKind::OpenCvOpenVino,
+                             BackendKind::OpenCvCuda, BackendKind::OnnxRuntimeCpu}) {
+        if (isBackendAvailable(kind)) {
+            kinds.push_back(kind);
+        }
+    }
+    return kinds;
+}
+
+OpenCvEngine::OpenCvEngine(const std::string& configPath, const std::string& weightsPath,
+                           int backend, int target, const std::string& label,
+                           const std::string& cacheDir)
+    : label(label) {
+    if (configPath.empty() || endsWith(weightsPath, ".onnx")) {
+        net = cv::dnn::readNetFromONNX(weightsPath);
+    } else if (!cacheDir.empty()) {
+        net = ModelCache(cacheDir).loadDarknet(configPath, weightsPath);
+    } else {
+        net = cv::dnn::readNetFromDarknet(configPath, weightsPath);
+    }
+    if (net.empty()) {
+        throw std::runtime_error("Failed to create network");
+    }
+
+    net.setPreferableBackend(backend);
+    net.setPreferableTarget(target);
+
+    // Resolve output layer names once for the lifetime of the engine
+    outputNames = net.getUnconnectedOutLayersNames();
+}
+
+OpenCvEngine::OpenCvEngine(const cv::dnn::Net& net, const std::string& label)
+    : net(net), outputNames(net.getUnconnectedOutLayersNames()), label(label) {}
+
+void OpenCvEngine::forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) {
+    net.setInput(blob);
+    net.forward(outputs, outputNames);
+}
+
+std::unique_ptr<InferenceEngine> createInferenceEngine(const std::string& configPath,
+                                                       const std::string& weightsPath,
+                                                       const BackendConfig& config) {
+    if (!isBackendAvailable(config.kind)) {
+        throw std::runtime_error("Inference backend not available: " + backendName(config.kind));
+    }
+
+    if (config.kind == BackendKind::OnnxRuntimeCpu) {
+#ifdef HAVE_ONNXRUNTIME
+        if (!endsWith(weightsPath, ".onnx")) {
+            throw std::runtime_error("ONNX Runtime backend needs an .onnx model: " + weightsPath);
+        }
+        return std::make_unique<OnnxRuntimeEngine>(weightsPath, config.numThreads);
+#endif
+    }
+
+    // cv::dnn uses one process-wide thread pool
+    if (config.numThreads > 0) {
+        cv::setNumThreads(config.numThreads);
+    }
+
+    if (config.precision != Precision::Fp32 && config.kind != BackendKind::OpenCvCpu) {
+        throw std::runtime_error(precisionName(config.precision) +
+                                 " precision is only supported on the opencv backend");
+    }
+
+    try {
+        if (config.precision == Precision::Int8) {
+            // Quantize once at load using the offline calibration set
+            OpenCvEngine fp32(configPath, weightsPath, cv::dnn::DNN_BACKEND_OPENCV,
+                              cv::dnn::DNN_TARGET_CPU, "opencv", config.modelCacheDir);
+            cv::dnn::Net int8 = quantizeNet(fp32.getNet(),
+                                            loadCalibrationBlob(config.calibrationFile));
+            return std::make_unique<OpenCvEngine>(int8, "opencv-int8");
+        }
+        if (config.precision == Precision::Fp16) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+            return std::make_unique<OpenCvEngine>(configPath, weightsPath,
+                                                  cv::dnn::DNN_BACKEND_OPENCV,
+                                                  cv::dnn::DNN_TARGET_CPU_FP16, "opencv-fp16",
+                                                  config.modelCacheDir);
+#else
+            throw std::runtime_error("fp16 CPU inference needs OpenCV 4.9 or newer");
+#endif
+        }
+
+        switch (config.kind) {
+            case BackendKind::OpenCvOpenVino:
+                return std::make_unique<OpenCvEngine>(configPath, weightsPath,
+                                                      cv::dnn::DNN_BACKEND_INFERENCE_ENGINE,
+                                                      cv::dnn::DNN_TARGET_CPU, "openvino",
+                                                      config.modelCacheDir);
+            case BackendKind::OpenCvCuda:
+                return std::make_unique<OpenCvEngine>(configPath, weightsPath,
+                                                      cv::dnn::DNN_BACKEND_CUDA,
+                                                      cv::dnn::DNN_TARGET_CUDA, "cuda",
+                                                      config.modelCacheDir);
+            default:
+                return std::make_unique<OpenCvEngine>(configPath, weightsPath,
+                                                      cv::dnn::DNN_BACKEND_OPENCV,
+                                                      cv::dnn::DNN_TARGET_CPU, "opencv",
+                                                      config.modelCacheDir);
+        }
+    }
+    catch (const cv::Exception& e) {
+        throw std::runtime_error("Failed to load the network: " + std::string(e.what()));
+    }
+}
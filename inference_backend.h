@@ -0,0 +1,92 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Inference backends a ModelSession can run on
+enum class BackendKind {
+    OpenCvCpu,        // cv::dnn default CPU implementation
+    OpenCvOpenVino,   // cv::dnn with the OpenVINO (Inference Engine) backend
+    OpenCvCuda,       // cv::dnn CUDA backend
+    OnnxRuntimeCpu    // ONNX Runtime CPU provider (.onnx models, HAVE_ONNXRUNTIME)
+};
+
+// Numeric precision of the network (cv::dnn CPU backend only)
+enum class Precision {
+    Fp32,
+    Fp16,     // FP16 weights/compute, DNN_TARGET_CPU_FP16 (OpenCV >= 4.9)
+    Int8      // Net::quantize() calibrated with calibrationFile
+};
+
+struct BackendConfig {
+    BackendKind kind = BackendKind::OpenCvCpu;
+    int numThreads = 0;             // 0 = library default
+    Precision precision = Precision::Fp32;
+    std::string calibrationFile;    // Needed for Precision::Int8
+    std::string modelCacheDir;      // Preprocessed Darknet model cache, empty = off
+};
+
+// Names used in config files and on the command line:
+// "opencv", "openvino", "cuda", "onnxruntime"
+BackendKind parseBackendKind(const std::string& name);
+std::string backendName(BackendKind kind);
+
+// "fp32", "fp16", "int8"
+Precision parsePrecision(const std::string& name);
+std::string precisionName(Precision precision);
+
+// Read a backend config from a YAML or JSON file, e.g.
+//   backend: "openvino"
+//   threads: 4
+//   precision: "int8"                 (optional)
+//   calibration: "calibration.yml"    (required for int8)
+//   model_cache: "model_cache"        (optional, see model_cache.h)
+BackendConfig loadBackendConfig(const std::string& path);
+
+// Accepts either a backend name or a .yml/.yaml/.json config file
+BackendConfig resolveBackendConfig(const std::string& nameOrFile, int numThreads = 0);
+
+// Backends usable in this build on this machine
+bool isBackendAvailable(BackendKind kind);
+std::vector<BackendKind> availableBackends();
+
+// Runs a network on a preprocessed NCHW float blob
+class InferenceEngine {
+public:
+    virtual ~InferenceEngine() = default;
+
+    // Outputs are written into the given vector so callers can reuse it
+    virtual void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) = 0;
+    virtual std::string name() const = 0;
+};
+
+// cv::dnn engine for Darknet (.cfg + .weights) or ONNX models
+class OpenCvEngine : public InferenceEngine {
+public:
+    OpenCvEngine(const std::string& configPath, const std::string& weightsPath,
+                 int backend, int target, const std::string& label,
+                 const std::string& cacheDir = "");
+    explicit OpenCvEngine(const cv::dnn::Net& net, const std::string& label = "opencv");
+
+    void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) override;
+    std::string name() const override { return label; }
+
+    cv::dnn::Net& getNet() { return net; }
+
+private:
+    cv::dnn::Net net;
+    std::vector<std::string> outputNames;
+    std::string label;
+};
+
+// Create the engine selected by config. Darknet models need configPath and
+// weightsPath; ONNX models are given as weightsPath with an empty configPath.
+std::unique_ptr<InferenceEngine> createInferenceEngine(const std::string& configPath,
+                                                       const std::string& weightsPath,
+                                                       const BackendConfig& config);
+
+#endif // INFERENCE_BACKEND_H
@@ -1,72 +1,48 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include "model_session.h"
+#include "instrumentation.h"
+#include "overlay_renderer.h"
+#include "ui_control.h"
 #include <librealsense2/rs.hpp>
 #include <iostream>
 #include <vector>
 #include <fstream>
+#include <memory>
 
 class YoloDetector {
 private:
-    cv::dnn::Net net;
+    std::unique_ptr<ModelSession> session;
+    OverlayRenderer renderer;
     float confThreshold;
     float nmsThreshold;
     
     void postprocess(cv::Mat& frame, const std::vector<cv::Mat>& outs);
-    std::vector<std::string> getOutputsNames();
 
 public:
     YoloDetector(const std::string& modelPath, 
                  const std::string& configPath,
                  float confidenceThreshold = 0.8,
                  float nmsThreshold = 0.4) {
-        // Check if files exist
-        std::ifstream modelFile(modelPath);
-        if (!modelFile.good()) {
-            throw std::runtime_error("Cannot open weights file: " + modelPath);
-        }
+        std::cout << "Loading YOLOv3 network...\n";
+        std::cout << "Config: " << configPath << "\n";
+        std::cout << "Weights: " << modelPath << "\n";
         
-        std::ifstream configFile(configPath);
-        if (!configFile.good()) {
-            throw std::runtime_error("Cannot open config file: " + configPath);
-        }
-
-        try {
-            std::cout << "Loading YOLOv3 network...\n";
-            std::cout << "Config: " << configPath << "\n";
-            std::cout << "Weights: " << modelPath << "\n";
-            
-            net = cv::dnn::readNetFromDarknet(configPath, modelPath);
-            if (net.empty()) {
-                throw std::runtime_error("Failed to create network");
-            }
-            
-            net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-            net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-            
-            this->confThreshold = confidenceThreshold;
-            this->nmsThreshold = nmsThreshold;
-            
-            std::cout << "Network loaded successfully\n";
-        }
-        catch (const cv::Exception& e) {
-            throw std::runtime_error("Failed to load the network: " + std::string(e.what()));
-        }
+        // The session checks the files, loads the net and resolves the
+        // output layers once; it throws std::runtime_error on failure
+        session = std::make_unique<ModelSession>(configPath, modelPath);
+        
+        this->confThreshold = confidenceThreshold;
+        this->nmsThreshold = nmsThreshold;
+        
+        std::cout << "Network loaded successfully\n";
     }
 
     cv::Mat detect(const cv::Mat& frame) {
-        cv::Mat blob;
         cv::Mat processedFrame = frame.clone();
         
         try {
-            cv::dnn::blobFromImage(frame, blob, 1/255.0, 
-                                  cv::Size(416, 416), 
-                                  cv::Scalar(0,0,0), 
-                                  true, false);
-            
-            net.setInput(blob);
-            
-            std::vector<cv::Mat> outs;
-            net.forward(outs, getOutputsNames());
+            const std::vector<cv::Mat>& outs = session->run(frame);
             
             postprocess(processedFrame, outs);
             
@@ -84,70 +60,72 @@ void YoloDetector::postprocess(cv::Mat& frame, const std::vector<cv::Mat>& outs)
     std::vector<float> confidences;
     std::vector<cv::Rect> boxes;
     
-    for (const auto& out : outs) {
-        float* data = (float*)out.data;
-        for (int j = 0; j < out.rows; ++j, data += out.cols) {
-            float confidence = data[4];
-            float classProb = data[5];
-            confidence *= classProb;
+    {
+        ScopedTimer timer(Stage::Decode);
+        for (const auto& out : outs) {
+            float* data = (float*)out.data;
+            for (int j = 0; j < out.rows; ++j, data += out.cols) {
+                float confidence = data[4];
+                float classProb = data[5];
+                confidence *= classProb;
             
-            if (confidence > confThreshold) {
-                int centerX = (int)(data[0] * frame.cols);
-                int centerY = (int)(data[1] * frame.rows);
-                int width = (int)(data[2] * frame.cols);
-                int height = (int)(data[3] * frame.rows);
-                int left = centerX - width / 2;
-                int top = centerY - height / 2;
+                if (confidence > confThreshold) {
+                    int centerX = (int)(data[0] * frame.cols);
+                    int centerY = (int)(data[1] * frame.rows);
+                    int width = (int)(data[2] * frame.cols);
+                    int height = (int)(data[3] * frame.rows);
+                    int left = centerX - width / 2;
+                    int top = centerY - height / 2;
                 
-                confidences.push_back(confidence);
-                boxes.push_back(cv::Rect(left, top, width, height));
+                    confidences.push_back(confidence);
+                    boxes.push_back(cv::Rect(left, top, width, height));
+                }
             }
         }
     }
     
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
+    {
+        ScopedTimer timer(Stage::Nms);
+        cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
+    }
     
+    ScopedTimer timer(Stage::Draw);
+    TextStyle style;
+    style.color = cv::Scalar(0, 0, 0);
+    style.background = cv::Scalar(255, 255, 255);
+    
+    renderer.begin(frame.size());
     for (size_t i = 0; i < indices.size(); ++i) {
         int idx = indices[i];
-        cv::Rect box = boxes[idx];
-        
-        cv::rectangle(frame, box, cv::Scalar(0, 255, 0), 3);
-        
-        std::string label = cv::format("Confidence: %.2f", confidences[idx]);
-        
-        int baseLine;
-        cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
-                                           0.5, 1, &baseLine);
-        cv::rectangle(frame, 
-                     cv::Point(box.x, box.y - labelSize.height),
-                     cv::Point(box.x + labelSize.width, box.y + baseLine),
-                     cv::Scalar(255, 255, 255), 
-                     cv::FILLED);
-        cv::putText(frame, label, 
-                   cv::Point(box.x, box.y),
-                   cv::FONT_HERSHEY_SIMPLEX, 
-                   0.5, cv::Scalar(0, 0, 0));
-    }
-}
-
-std::vector<std::string> YoloDetector::getOutputsNames() {
-    static std::vector<std::string> names;
-    if (names.empty()) {
-        std::vector<int> outLayers = net.getUnconnectedOutLayers();
-        std::vector<std::string> layersNames = net.getLayerNames();
-        names.resize(outLayers.size());
-        for (size_t i = 0; i < outLayers.size(); ++i) {
-            names[i] = layersNames[outLayers[i] - 1];
-        }
+        
+        // Box with "Confidence: 0.87" on top; label bitmaps are cached
+        renderer.addLabeledBox(boxes[idx], "Confidence: " + confidenceText(confidences[idx]),
+                               cv::Scalar(0, 255, 0), style, 3);
     }
-    return names;
+    renderer.compose(frame);
 }
 
 int main(int argc, char** argv) {
     try {
         std::cout << "Starting YOLOv3 detection program with RealSense...\n";
         
+        // PERF_STATS=<file> turns on stage timing and the latency overlay
+        auto latencyReporter = startInstrumentationFromEnv();
+        
+        // --headless runs without a window; quit with "q" on stdin or Ctrl-C
+        bool headless = !displayAvailable();
+        for (int i = 1; i < argc; ++i) {
+            if (std::string(argv[i]) == "--headless") headless = true;
+        }
+        ControlChannel control;
+        control.enableStdin();
+        control.enableSignals();
+        std::unique_ptr<DisplayThread> display;
+        if (!headless) {
+            display = std::make_unique<DisplayThread>("RealSense Object Detection", control);
+        }
+        
         // Model paths (update these to your actual paths)
         std::string modelPath = "/home/thornch/Documents/YOLOv3_custom_data_and_onnx/yolov3_darknet_kimbap/darknet/backup/yolov3-kimbap_3000.weights"; //
         std::string configPath = "/home/thornch/Documents/YOLOv3_custom_data_and_onnx/yolov3_darknet_kimbap/darknet/cfg/yolov3-kimbap.cfg";
@@ -169,7 +147,11 @@ int main(int argc, char** argv) {
         
         while (true) {
             // Wait for frames
-            rs2::frameset frames = pipe.wait_for_frames();
+            rs2::frameset frames;
+            {
+                ScopedTimer timer(Stage::CaptureWait);
+                frames = pipe.wait_for_frames();
+            }
             
             // Get color frame
             rs2::frame color_frame = frames.get_color_frame();
@@ -185,11 +167,14 @@ int main(int argc, char** argv) {
             // Perform detection
             cv::Mat result = detector.detect(frame);
             
-            // Show result
-            cv::imshow("RealSense Object Detection", result);
+            // Show result; the display thread drops frames it cannot keep up with
+            if (display) {
+                drawLatencyOverlay(result);
+                display->show(result);
+            }
             
             // Break loop with 'q'
-            char key = (char)cv::waitKey(1);
+            int key = control.poll();
             if (key == 'q' || key == 27) {
                 break;
             }
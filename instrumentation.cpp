@@ -0,0 +1,236 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+// HDR-style log-linear buckets over microseconds: values below 16 get one
+// bucket each, above that every power of two is split into 16 sub-buckets
+// (about 6% relative error) up to 2^40 us.
+const int kSubBuckets = 16;
+const int kMaxExponent = 39;
+const int kBuckets = (kMaxExponent - 2) * kSubBuckets;
+
+int bucketIndex(uint64_t micros) {
+    if (micros < (uint64_t)kSubBuckets) return (int)micros;
+    int exponent = 63 - __builtin_clzll(micros);
+    if (exponent > kMaxExponent) return kBuckets - 1;
+    return (exponent - 3) * kSubBuckets + (int)((micros >> (exponent - 4)) & (kSubBuckets - 1));
+}
+
+// Midpoint of the bucket range in microseconds
+double bucketValue(int index) {
+    if (index < kSubBuckets) return index;
+    int exponent = index / kSubBuckets + 3;
+    double width = (double)(1ull << (exponent - 4));
+    return (kSubBuckets + index % kSubBuckets) * width + width / 2;
+}
+
+using Counts = std::array<uint64_t, kBuckets>;
+
+struct StageHistogram {
+    Counts counts{};
+    uint64_t total = 0;
+    uint64_t sumMicros = 0;
+};
+
+// Written only by the owning thread, read by snapshots
+struct ThreadHistograms {
+    std::atomic<uint64_t> counts[kStageCount][kBuckets];
+    std::atomic<uint64_t> sumMicros[kStageCount];
+
+    ThreadHistograms() {
+        for (auto& stage : counts) {
+            for (auto& c : stage) c.store(0, std::memory_order_relaxed);
+        }
+        for (auto& s : sumMicros) s.store(0, std::memory_order_relaxed);
+    }
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadHistograms>> registry;   // Kept after threads exit
+
+ThreadHistograms& localHistograms() {
+    thread_local ThreadHistograms* local = nullptr;
+    if (!local) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadHistograms>());
+        local = registry.back().get();
+    }
+    return *local;
+}
+
+std::vector<StageHistogram> mergeHistograms() {
+    std::vector<StageHistogram> merged(kStageCount);
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& thread : registry) {
+        for (int s = 0; s < kStageCount; ++s) {
+            for (int b = 0; b < kBuckets; ++b) {
+                uint64_t c = thread->counts[s][b].load(std::memory_order_relaxed);
+                merged[s].counts[b] += c;
+                merged[s].total += c;
+            }
+            merged[s].sumMicros += thread->sumMicros[s].load(std::memory_order_relaxed);
+        }
+    }
+    return merged;
+}
+
+double percentileMs(const StageHistogram& histogram, double p) {
+    uint64_t rank = (uint64_t)(p * (histogram.total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += histogram.counts[b];
+        if (seen >= rank) return bucketValue(b) / 1000.0;
+    }
+    return bucketValue(kBuckets - 1) / 1000.0;
+}
+
+std::vector<StageLatency> summarize(const std::vector<StageHistogram>& histograms) {
+    std::vector<StageLatency> stats;
+    for (int s = 0; s < kStageCount; ++s) {
+        const StageHistogram& h = histograms[s];
+        if (h.total == 0) continue;
+        stats.push_back({(Stage)s, h.total, h.sumMicros / 1000.0 / h.total,
+                         percentileMs(h, 0.50), percentileMs(h, 0.95), percentileMs(h, 0.99)});
+    }
+    return stats;
+}
+
+void writeTable(std::ostream& out, const std::vector<StageLatency>& stats) {
+    out << std::left << std::setw(14) << "stage" << std::right << std::setw(10) << "count"
+        << std::setw(10) << "mean_ms" << std::setw(10) << "p50_ms"
+        << std::setw(10) << "p95_ms" << std::setw(10) << "p99_ms" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (const auto& s : stats) {
+        out << std::left << std::setw(14) << stageName(s.stage) << std::right
+            << std::setw(10) << s.count << std::setw(10) << s.meanMs
+            << std::setw(10) << s.p50Ms << std::setw(10) << s.p95Ms
+            << std::setw(10) << s.p99Ms << "\n";
+    }
+}
+
+} // namespace
+
+std::string stageName(Stage stage) {
+    switch (stage) {
+        case Stage::CaptureWait: return "capture_wait";
+        case Stage::Preprocess: return "preprocess";
+        case Stage::Forward: return "forward";
+        case Stage::Decode: return "decode";
+        case Stage::Nms: return "nms";
+        case Stage::Draw: return "draw";
+        case Stage::Encode: return "encode";
+        case Stage::DiskWrite: return "disk_write";
+    }
+    return "unknown";
+}
+
+void enableInstrumentation(bool enabled) {
+    instrumentationOn.store(enabled, std::memory_order_relaxed);
+}
+
+void recordLatency(Stage stage, uint64_t micros) {
+    ThreadHistograms& local = localHistograms();
+    int s = (int)stage;
+    // Single writer per thread, so a plain load + store is enough
+    auto& bucket = local.counts[s][bucketIndex(micros)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    local.sumMicros[s].store(local.sumMicros[s].load(std::memory_order_relaxed) + micros,
+                             std::memory_order_relaxed);
+}
+
+std::vector<StageLatency> latencySnapshot() {
+    return summarize(mergeHistograms());
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = (size_t)std::min<double>(sorted.size() - 1, p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+void drawLatencyOverlay(cv::Mat& frame) {
+    if (!instrumentationEnabled()) return;
+
+    std::vector<StageLatency> stats = latencySnapshot();
+    int y = 20;
+    for (const auto& s : stats) {
+        std::string line = cv::format("%-12s %6.1f %6.1f %6.1f ms", stageName(s.stage).c_str(),
+                                      s.p50Ms, s.p95Ms, s.p99Ms);
+        cv::putText(frame, line, cv::Point(frame.cols - 330, y),
+                    cv::FONT_HERSHEY_PLAIN, 1.0, cv::Scalar(0, 255, 255), 1);
+        y += 16;
+    }
+}
+
+LatencyReporter::LatencyReporter(const std::string& path, double intervalSec)
+    : path(path), intervalSec(intervalSec) {
+    worker = std::thread([this] { run(); });
+}
+
+LatencyReporter::~LatencyReporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void LatencyReporter::run() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<StageHistogram> previous(kStageCount);
+    bool last = false;
+
+    while (!last) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::duration<double>(intervalSec),
+                          [this] { return stopping; });
+            last = stopping;
+        }
+
+        // Report only what was recorded since the previous dump
+        std::vector<StageHistogram> current = mergeHistograms();
+        std::vector<StageHistogram> window(kStageCount);
+        for (int s = 0; s < kStageCount; ++s) {
+            for (int b = 0; b < kBuckets; ++b) {
+                window[s].counts[b] = current[s].counts[b] - previous[s].counts[b];
+            }
+            window[s].total = current[s].total - previous[s].total;
+            window[s].sumMicros = current[s].sumMicros - previous[s].sumMicros;
+        }
+        previous = current;
+
+        std::vector<StageLatency> stats = summarize(window);
+        if (stats.empty()) continue;
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::ofstream out(path, std::ios::app);
+        out << "[" << std::fixed << std::setprecision(1) << elapsed << " s]\n";
+        writeTable(out, stats);
+        out << "\n";
+    }
+}
+
+std::unique_ptr<LatencyReporter> startInstrumentationFromEnv() {
+    const char* path = std::getenv("PERF_STATS");
+    if (!path || !*path) {
+        return nullptr;
+    }
+    const char* interval = std::getenv("PERF_STATS_INTERVAL");
+    double seconds = interval ? std::atof(interval) : 5.0;
+
+    enableInstrumentation(true);
+    return std::make_unique<LatencyReporter>(path, seconds > 0 ? seconds : 5.0);
+}
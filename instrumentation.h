@@ -0,0 +1,106 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pipeline stages timed by ScopedTimer
+enum class Stage {
+    CaptureWait,    // Blocking on the camera for the next frame
+    Preprocess,     // blobFromImage(s)
+    Forward,        // Network forward pass
+    Decode,         // YOLO head rows -> candidate boxes
+    Nms,            // Non-maximum suppression / box fusion
+    Draw,           // Drawing boxes and overlays
+    Encode,         // Image encoding (JPEG/PNG)
+    DiskWrite       // Writing images and labels
+};
+const int kStageCount = 8;
+
+std::string stageName(Stage stage);
+
+// Off by default; a disabled ScopedTimer costs one relaxed atomic load
+inline std::atomic<bool> instrumentationOn{false};
+
+inline bool instrumentationEnabled() {
+    return instrumentationOn.load(std::memory_order_relaxed);
+}
+void enableInstrumentation(bool enabled = true);
+
+// Add one sample to the calling thread's histogram of the stage. Every
+// thread records into its own histograms, so recording never takes a lock.
+void recordLatency(Stage stage, uint64_t micros);
+
+// Times the enclosing scope into the stage histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Stage stage) : stage(stage), active(instrumentationEnabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (active) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            recordLatency(stage, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stage stage;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+struct StageLatency {
+    Stage stage;
+    uint64_t count;
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+};
+
+// Merged over all threads since instrumentation was enabled. Stages without
+// samples are left out.
+std::vector<StageLatency> latencySnapshot();
+
+// Exact statistics over raw samples, for the benchmark tools: percentile of
+// an ascending vector (nearest rank), median of an unsorted copy
+double percentile(const std::vector<double>& sorted, double p);
+double median(std::vector<double> values);
+
+// Draws the p50/p95/p99 table in the top-right corner when enabled
+void drawLatencyOverlay(cv::Mat& frame);
+
+// Appends a p50/p95/p99 table of the samples recorded in the last interval
+// to a text file, every intervalSec seconds and once more on destruction
+class LatencyReporter {
+public:
+    LatencyReporter(const std::string& path, double intervalSec = 5.0);
+    ~LatencyReporter();
+
+private:
+    std::string path;
+    double intervalSec;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void run();
+};
+
+// PERF_STATS=<file> enables instrumentation and periodic dumps to the file,
+// PERF_STATS_INTERVAL=<sec> sets the period. Returns nullptr when unset.
+std::unique_ptr<LatencyReporter> startInstrumentationFromEnv();
+
+#endif // INSTRUMENTATION_H
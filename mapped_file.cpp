@@ -0,0 +1,38 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    length = (size_t)st.st_size;
+
+    if (length > 0) {
+        address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            address = nullptr;
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        // Files are read front to back
+        ::madvise(address, length, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (address) {
+        ::munmap(address, length);
+    }
+}
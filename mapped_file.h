@@ -0,0 +1,24 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (POSIX mmap)
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(address); }
+    size_t size() const { return length; }
+
+private:
+    void* address = nullptr;
+    size_t length = 0;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,137 @@
+#include "micro_benchmark.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+BenchmarkRun measure(const std::string& name, const BenchmarkFn& fn, int64_t iterations,
+                     int repetition) {
+    BenchmarkState state(iterations);
+    fn(state);
+    BenchmarkRun run;
+    run.name = name;
+    run.runType = "iteration";
+    run.repetitionIndex = repetition;
+    run.iterations = iterations;
+    run.realTimeNs = state.realSeconds() * 1e9 / iterations;
+    run.cpuTimeNs = state.cpuSeconds() * 1e9 / iterations;
+    run.itemsPerSecond = state.items() > 0 && state.realSeconds() > 0 ?
+                         state.items() / state.realSeconds() : 0.0;
+    return run;
+}
+
+BenchmarkRun aggregateRun(const std::vector<BenchmarkRun>& reps, const std::string& kind) {
+    auto reduce = [&](double BenchmarkRun::*field) {
+        std::vector<double> values;
+        for (const auto& r : reps) values.push_back(r.*field);
+        double mean = 0.0;
+        for (double v : values) mean += v;
+        mean /= values.size();
+        if (kind == "mean") return mean;
+        if (kind == "median") {
+            std::sort(values.begin(), values.end());
+            size_t n = values.size();
+            return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+        }
+        double var = 0.0;
+        for (double v : values) var += (v - mean) * (v - mean);
+        return values.size() > 1 ? std::sqrt(var / (values.size() - 1)) : 0.0;
+    };
+
+    BenchmarkRun run = reps.front();
+    run.name = reps.front().name + "_" + kind;
+    run.runType = "aggregate";
+    run.aggregate = kind;
+    run.repetitionIndex = 0;
+    run.realTimeNs = reduce(&BenchmarkRun::realTimeNs);
+    run.cpuTimeNs = reduce(&BenchmarkRun::cpuTimeNs);
+    run.itemsPerSecond = reduce(&BenchmarkRun::itemsPerSecond);
+    return run;
+}
+
+} // namespace
+
+void BenchmarkSuite::add(const std::string& name, BenchmarkFn fn) {
+    benchmarks.emplace_back(name, std::move(fn));
+}
+
+void BenchmarkSuite::run(double minTime, int repetitions, const std::string& filter) {
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(14) << "Time(ns)" << std::setw(14) << "CPU(ns)"
+              << std::setw(12) << "Iterations" << "\n";
+    std::cout << std::string(80, '-') << "\n";
+
+    for (const auto& [name, fn] : benchmarks) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+        // Grow the iteration count until one repetition takes minTime
+        int64_t iterations = 1;
+        while (true) {
+            BenchmarkState probe(iterations);
+            fn(probe);
+            double elapsed = probe.realSeconds();
+            if (elapsed >= minTime || iterations >= 1000000000) break;
+            double factor = elapsed > 0 ? minTime * 1.4 / elapsed : 10.0;
+            iterations = std::max<int64_t>(iterations + 1,
+                                           (int64_t)(iterations * std::min(factor, 10.0)));
+        }
+
+        std::vector<BenchmarkRun> reps;
+        for (int r = 0; r < repetitions; ++r) {
+            reps.push_back(measure(name, fn, iterations, r));
+        }
+        runs.insert(runs.end(), reps.begin(), reps.end());
+        if (repetitions > 1) {
+            for (const char* kind : {"mean", "median", "stddev"}) {
+                runs.push_back(aggregateRun(reps, kind));
+            }
+        }
+
+        BenchmarkRun summary = repetitions > 1 ? aggregateRun(reps, "median") : reps.front();
+        std::cout << std::left << std::setw(40) << name << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(14) << summary.realTimeNs
+                  << std::setw(14) << summary.cpuTimeNs << std::setw(12) << iterations << "\n";
+    }
+}
+
+void BenchmarkSuite::writeJson(const std::string& path,
+                               const std::map<std::string, std::string>& context) const {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot write benchmark results: " + path);
+    }
+
+    fs << "context" << "{";
+    for (const auto& [key, value] : context) {
+        fs << key << value;
+    }
+    fs << "}";
+
+    fs << "benchmarks" << "[";
+    for (const auto& run : runs) {
+        fs << "{";
+        fs << "name" << run.name;
+        fs << "run_name" << (run.runType == "aggregate" ?
+                             run.name.substr(0, run.name.size() - run.aggregate.size() - 1) : run.name);
+        fs << "run_type" << run.runType;
+        if (run.runType == "aggregate") {
+            fs << "aggregate_name" << run.aggregate;
+        } else {
+            fs << "repetition_index" << run.repetitionIndex;
+        }
+        fs << "iterations" << (int)run.iterations;
+        fs << "real_time" << run.realTimeNs;
+        fs << "cpu_time" << run.cpuTimeNs;
+        fs << "time_unit" << "ns";
+        if (run.itemsPerSecond > 0) {
+            fs << "items_per_second" << run.itemsPerSecond;
+        }
+        fs << "}";
+    }
+    fs << "]";
+    fs.release();
+}
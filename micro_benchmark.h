@@ -0,0 +1,95 @@
+#ifndef MICRO_BENCHMARK_H
+#define MICRO_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Small Google Benchmark style runner. A benchmark body loops with
+//   while (state.keepRunning()) { ... }
+// and the runner picks the iteration count so one repetition lasts at
+// least minTime seconds, then repeats it and reports mean/median/stddev.
+class BenchmarkState {
+public:
+    explicit BenchmarkState(int64_t iterations) : total(iterations), remaining(iterations) {}
+
+    // The clock starts on the first call and stops after the last iteration
+    bool keepRunning() {
+        if (remaining == total) start();
+        if (remaining-- > 0) return true;
+        stop();
+        return false;
+    }
+
+    // Exclude per-iteration setup from the measurement
+    void pauseTiming() { stop(); }
+    void resumeTiming() { start(); }
+
+    void setItemsProcessed(int64_t items) { itemsProcessed = items; }
+
+    int64_t iterations() const { return total; }
+    int64_t items() const { return itemsProcessed; }
+    double realSeconds() const { return realTime; }
+    double cpuSeconds() const { return cpuTime; }
+
+private:
+    int64_t total;
+    int64_t remaining;
+    int64_t itemsProcessed = 0;
+    double realTime = 0.0;
+    double cpuTime = 0.0;
+    std::chrono::steady_clock::time_point realStart;
+    std::clock_t cpuStart = 0;
+
+    void start() {
+        realStart = std::chrono::steady_clock::now();
+        cpuStart = std::clock();
+    }
+    void stop() {
+        realTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+        cpuTime += (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    }
+};
+
+using BenchmarkFn = std::function<void(BenchmarkState&)>;
+
+// Keep the compiler from discarding a result computed only for timing
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct BenchmarkRun {
+    std::string name;
+    std::string runType;        // "iteration" or "aggregate"
+    std::string aggregate;      // "mean", "median", "stddev" for aggregates
+    int repetitionIndex;
+    int64_t iterations;
+    double realTimeNs;          // Per iteration
+    double cpuTimeNs;
+    double itemsPerSecond;
+};
+
+class BenchmarkSuite {
+public:
+    void add(const std::string& name, BenchmarkFn fn);
+
+    // Runs benchmarks whose name contains filter (all if empty)
+    void run(double minTime = 0.5, int repetitions = 5, const std::string& filter = "");
+
+    // Google Benchmark compatible JSON: {"context": {...}, "benchmarks": [...]}
+    void writeJson(const std::string& path,
+                   const std::map<std::string, std::string>& context) const;
+
+    const std::vector<BenchmarkRun>& results() const { return runs; }
+
+private:
+    std::vector<std::pair<std::string, BenchmarkFn>> benchmarks;
+    std::vector<BenchmarkRun> runs;
+};
+
+#endif // MICRO_BENCHMARK_H
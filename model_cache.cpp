@@ -0,0 +1,336 @@
+#include "model_cache.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kMagic[8] = {'D', 'N', 'C', 'A', 'C', 'H', 'E', '1'};
+const size_t kPageSize = 4096;
+
+struct CacheHeader {
+    char magic[8];
+    uint64_t key;
+    uint64_t cfgOffset;
+    uint64_t cfgSize;
+    uint64_t weightsOffset;
+    uint64_t weightsSize;
+};
+
+// One [section] of a Darknet cfg file
+struct CfgSection {
+    std::string type;
+    std::vector<std::string> lines;             // Original lines, header included
+    std::map<std::string, std::string> params;
+};
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::vector<CfgSection> parseCfg(const std::string& text) {
+    std::vector<CfgSection> sections;
+    std::istringstream in(text);
+    std::string raw;
+    while (std::getline(in, raw)) {
+        std::string line = trim(raw);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+
+        if (line[0] == '[') {
+            CfgSection section;
+            section.type = line.substr(1, line.find(']') - 1);
+            section.lines.push_back(line);
+            sections.push_back(section);
+        } else if (!sections.empty()) {
+            size_t eq = line.find('=');
+            if (eq != std::string::npos) {
+                sections.back().params[trim(line.substr(0, eq))] = trim(line.substr(eq + 1));
+            }
+            sections.back().lines.push_back(line);
+        }
+    }
+    return sections;
+}
+
+int paramInt(const CfgSection& section, const std::string& key, int fallback) {
+    auto it = section.params.find(key);
+    return it == section.params.end() ? fallback : std::stoi(it->second);
+}
+
+// Folds batch normalization into the conv layers of a Darknet model.
+// Returns false for layer types whose weights it does not know how to walk,
+// and when the walk does not consume the weights file exactly.
+bool foldBatchNorm(const std::string& cfgText, const char* weights, size_t weightsSize,
+                   std::string& foldedCfg, std::vector<char>& foldedWeights) {
+    std::vector<CfgSection> sections = parseCfg(cfgText);
+    if (sections.empty() || (sections[0].type != "net" && sections[0].type != "network")) {
+        return false;
+    }
+
+    // Weights header: major, minor, revision, then a 32 or 64 bit "seen"
+    if (weightsSize < 16) return false;
+    int32_t version[3];
+    std::memcpy(version, weights, sizeof(version));
+    size_t headerSize = 12 + ((version[0] * 10 + version[1]) >= 2 ? 8 : 4);
+    foldedWeights.assign(weights, weights + headerSize);
+
+    const float* src = reinterpret_cast<const float*>(weights + headerSize);
+    const float* srcEnd = reinterpret_cast<const float*>(weights + weightsSize);
+    auto append = [&foldedWeights](const float* data, size_t count) {
+        const char* bytes = reinterpret_cast<const char*>(data);
+        foldedWeights.insert(foldedWeights.end(), bytes, bytes + count * sizeof(float));
+    };
+
+    std::vector<int> channels;   // Output channels of every layer
+    int inputChannels = paramInt(sections[0], "channels", 3);
+
+    for (size_t s = 1; s < sections.size(); ++s) {
+        CfgSection& section = sections[s];
+        int layer = (int)s - 1;
+        int prev = layer > 0 ? channels[layer - 1] : inputChannels;
+        int out = prev;
+
+        if (section.type == "convolutional") {
+            int filters = paramInt(section, "filters", 1);
+            int size = paramInt(section, "size", 1);
+            int groups = paramInt(section, "groups", 1);
+            bool batchNorm = paramInt(section, "batch_normalize", 0) != 0;
+            size_t perFilter = (size_t)(prev / groups) * size * size;
+            size_t need = filters * ((batchNorm ? 4 : 1) + perFilter);
+            if ((size_t)(srcEnd - src) < need) return false;
+
+            if (batchNorm) {
+                const float* beta = src;
+                const float* scale = beta + filters;
+                const float* mean = scale + filters;
+                const float* variance = mean + filters;
+                const float* w = variance + filters;
+
+                // Same epsilon as OpenCV's Darknet importer
+                std::vector<float> bias(filters);
+                std::vector<float> folded(w, w + filters * perFilter);
+                for (int f = 0; f < filters; ++f) {
+                    float k = scale[f] / std::sqrt(variance[f] + 1e-6f);
+                    bias[f] = beta[f] - mean[f] * k;
+                    float* row = folded.data() + f * perFilter;
+                    for (size_t i = 0; i < perFilter; ++i) {
+                        row[i] *= k;
+                    }
+                }
+                append(bias.data(), bias.size());
+                append(folded.data(), folded.size());
+
+                for (auto& line : section.lines) {
+                    if (line.compare(0, 15, "batch_normalize") == 0) {
+                        line = "batch_normalize=0";
+                    }
+                }
+            } else {
+                append(src, need);
+            }
+            src += need;
+            out = filters;
+        } else if (section.type == "route") {
+            // Grouped routes (yolov4-tiny) take a slice of the channels
+            if (section.params.count("groups") || section.params.count("group_id")) return false;
+            std::stringstream layers(section.params["layers"]);
+            std::string item;
+            out = 0;
+            while (std::getline(layers, item, ',')) {
+                int idx = std::stoi(trim(item));
+                idx = idx < 0 ? layer + idx : idx;
+                if (idx < 0 || idx >= layer) return false;
+                out += channels[idx];
+            }
+        } else if (section.type == "reorg") {
+            int stride = paramInt(section, "stride", 2);
+            out = prev * stride * stride;
+        } else if (section.type == "shortcut" || section.type == "upsample" ||
+                   section.type == "maxpool" || section.type == "avgpool" ||
+                   section.type == "yolo" || section.type == "region" ||
+                   section.type == "dropout" || section.type == "softmax") {
+            out = prev;
+        } else {
+            return false;   // Weighted or unknown layer type
+        }
+        channels.push_back(out);
+    }
+    if (src != srcEnd) return false;   // Channel counts disagree with the weights
+
+    std::ostringstream cfg;
+    for (const auto& section : sections) {
+        for (const auto& line : section.lines) {
+            cfg << line << "\n";
+        }
+        cfg << "\n";
+    }
+    foldedCfg = cfg.str();
+    return true;
+}
+
+std::string readText(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+long long mtimeOf(const std::string& path) {
+    return (long long)fs::last_write_time(path).time_since_epoch().count();
+}
+
+} // namespace
+
+uint64_t hashBytes(const char* data, size_t size, uint64_t seed) {
+    // 64-bit multiply/rotate over 8-byte words, several GB/s
+    const uint64_t prime = 0x100000001B3ull * 0x9E3779B1ull;
+    uint64_t h = seed ^ (size * 0xC2B2AE3D27D4EB4Full);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h ^= word * 0x87C37B91114253D5ull;
+        h = ((h << 31) | (h >> 33)) * prime;
+    }
+    for (; i < size; ++i) {
+        h ^= (uint8_t)data[i];
+        h *= 0x100000001B3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h;
+}
+
+ModelCache::ModelCache(const std::string& cacheDir) : cacheDir(cacheDir) {
+    fs::create_directories(cacheDir);
+}
+
+std::string ModelCache::entryPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.dnnc", (unsigned long long)key);
+    return (fs::path(cacheDir) / name).string();
+}
+
+uint64_t ModelCache::modelKey(const std::string& cfgPath, const std::string& weightsPath) {
+    // An empty cfgPath keys a single-file (ONNX) model
+    std::ostringstream id;
+    if (!cfgPath.empty()) {
+        id << fs::absolute(cfgPath).string() << "\t" << fs::file_size(cfgPath) << "\t" << mtimeOf(cfgPath)
+           << "\t";
+    }
+    id << fs::absolute(weightsPath).string() << "\t" << fs::file_size(weightsPath)
+       << "\t" << mtimeOf(weightsPath);
+    std::string stamp = id.str();
+
+    // Known (path, size, mtime) pair -> reuse its hash
+    std::string indexPath = (fs::path(cacheDir) / "index").string();
+    std::ifstream index(indexPath);
+    std::string line;
+    while (std::getline(index, line)) {
+        size_t tab = line.rfind('\t');
+        if (tab != std::string::npos && line.compare(0, tab, stamp) == 0 && tab == stamp.size()) {
+            return std::stoull(line.substr(tab + 1), nullptr, 16);
+        }
+    }
+
+    uint64_t seed = hashBytes(nullptr, 0);
+    if (!cfgPath.empty()) {
+        MappedFile cfg(cfgPath);
+        seed = hashBytes(cfg.data(), cfg.size());
+    }
+    MappedFile weights(weightsPath);
+    uint64_t key = hashBytes(weights.data(), weights.size(), seed);
+
+    std::ofstream(indexPath, std::ios::app) << stamp << "\t" << std::hex << key << "\n";
+    return key;
+}
+
+bool ModelCache::buildEntry(const std::string& cfgPath, const std::string& weightsPath,
+                            uint64_t key, const std::string& path) {
+    std::string cfgText = readText(cfgPath);
+    MappedFile weights(weightsPath);
+
+    std::string foldedCfg;
+    std::vector<char> foldedWeights;
+    if (!foldBatchNorm(cfgText, weights.data(), weights.size(), foldedCfg, foldedWeights)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.key = key;
+    header.cfgOffset = sizeof(CacheHeader);
+    header.cfgSize = foldedCfg.size();
+    header.weightsOffset = (header.cfgOffset + header.cfgSize + kPageSize - 1) / kPageSize * kPageSize;
+    header.weightsSize = foldedWeights.size();
+
+    // Write to a per-process temporary file first so readers never see a partial
+    // entry and two processes filling the same cache do not share one
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(foldedCfg.data(), foldedCfg.size());
+        std::vector<char> padding(header.weightsOffset - header.cfgOffset - header.cfgSize, 0);
+        out.write(padding.data(), padding.size());
+        out.write(foldedWeights.data(), foldedWeights.size());
+        if (!out.good()) {
+            throw std::runtime_error("Cannot write model cache entry: " + tmp);
+        }
+    }
+    fs::rename(tmp, path);
+    return true;
+}
+
+cv::dnn::Net ModelCache::loadEntry(const std::string& path, uint64_t key) {
+    MappedFile entry(path);
+    if (entry.size() < sizeof(CacheHeader)) {
+        return cv::dnn::Net();
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, entry.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.key != key ||
+        header.weightsOffset + header.weightsSize > entry.size()) {
+        return cv::dnn::Net();
+    }
+
+    return cv::dnn::readNetFromDarknet(entry.data() + header.cfgOffset, header.cfgSize,
+                                       entry.data() + header.weightsOffset, header.weightsSize);
+}
+
+cv::dnn::Net ModelCache::loadDarknet(const std::string& cfgPath, const std::string& weightsPath) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t key = modelKey(cfgPath, weightsPath);
+    std::string path = entryPath(key);
+
+    cv::dnn::Net net;
+    lastHit = fs::exists(path);
+    if (lastHit) {
+        net = loadEntry(path, key);
+        lastHit = !net.empty();
+    }
+    if (!lastHit) {
+        net = buildEntry(cfgPath, weightsPath, key, path) ?
+              loadEntry(path, key) : cv::dnn::readNetFromDarknet(cfgPath, weightsPath);
+    }
+
+    lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return net;
+}
@@ -0,0 +1,50 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <cstdint>
+#include <string>
+
+// On-disk cache of preprocessed Darknet models.
+//
+// The first load of a cfg+weights pair writes one page-aligned cache file
+// keyed by a hash of both files. Before writing, batch normalization is
+// folded into the convolution weights and the cfg is rewritten with
+// batch_normalize=0, so the cached model has no BatchNorm layers to parse,
+// allocate or fuse. Later loads memory-map the cache file and hand it to
+// readNetFromDarknet() directly.
+//
+// Hashing a multi-hundred-MB weights file costs time too, so the hash of
+// each (path, size, mtime) pair is remembered in <cacheDir>/index and only
+// recomputed when the files change.
+class ModelCache {
+public:
+    explicit ModelCache(const std::string& cacheDir);
+
+    // Load through the cache. Models the folder does not understand
+    // (unknown weighted layer types) are loaded uncached.
+    cv::dnn::Net loadDarknet(const std::string& cfgPath, const std::string& weightsPath);
+
+    // Hash of cfg+weights used as the cache key (empty cfgPath: weights only)
+    uint64_t modelKey(const std::string& cfgPath, const std::string& weightsPath);
+
+    // Statistics of the last loadDarknet() call
+    bool lastLoadWasHit() const { return lastHit; }
+    double lastLoadMs() const { return lastMs; }
+
+private:
+    std::string cacheDir;
+    bool lastHit = false;
+    double lastMs = 0.0;
+
+    std::string entryPath(uint64_t key) const;
+    bool buildEntry(const std::string& cfgPath, const std::string& weightsPath,
+                    uint64_t key, const std::string& path);
+    cv::dnn::Net loadEntry(const std::string& path, uint64_t key);
+};
+
+// Fast 64-bit hash of a byte range (chained with seed)
+uint64_t hashBytes(const char* data, size_t size, uint64_t seed = 0x9E3779B97F4A7C15ull);
+
+#endif // MODEL_CACHE_H
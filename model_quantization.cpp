@@ -0,0 +1,87 @@
+#include "model_quantization.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+std::vector<std::string> selectCalibrationImages(const std::string& datasetDir, int count) {
+    std::vector<std::string> all;
+    for (const auto& entry : fs::recursive_directory_iterator(datasetDir)) {
+        std::string ext = entry.path().extension().string();
+        if (entry.is_regular_file() && (ext == ".jpg" || ext == ".jpeg" || ext == ".png")) {
+            all.push_back(fs::absolute(entry.path()).string());
+        }
+    }
+    std::sort(all.begin(), all.end());
+
+    if ((int)all.size() <= count) {
+        return all;
+    }
+
+    // Evenly spaced picks spread the sample over the whole capture session
+    std::vector<std::string> selected;
+    double step = (double)all.size() / count;
+    for (int i = 0; i < count; ++i) {
+        selected.push_back(all[(size_t)(i * step)]);
+    }
+    return selected;
+}
+
+void saveCalibrationSet(const std::string& path,
+                        const std::vector<std::string>& images,
+                        const cv::Size& inputSize) {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot write calibration file: " + path);
+    }
+    fs << "input_width" << inputSize.width;
+    fs << "input_height" << inputSize.height;
+    fs << "images" << "[";
+    for (const auto& image : images) {
+        fs << image;
+    }
+    fs << "]";
+}
+
+cv::Mat loadCalibrationBlob(const std::string& path, cv::Size* inputSize) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot open calibration file: " + path);
+    }
+
+    cv::Size size((int)fs["input_width"], (int)fs["input_height"]);
+    if (size.width <= 0 || size.height <= 0) {
+        size = cv::Size(416, 416);
+    }
+    if (inputSize) {
+        *inputSize = size;
+    }
+
+    std::vector<cv::Mat> images;
+    cv::FileNode list = fs["images"];
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        std::string imagePath = (std::string)*it;
+        cv::Mat img = cv::imread(imagePath);
+        if (img.empty()) {
+            std::cerr << "Skipping unreadable calibration image: " << imagePath << std::endl;
+            continue;
+        }
+        images.push_back(img);
+    }
+
+    if (images.empty()) {
+        throw std::runtime_error("Calibration file has no readable images: " + path);
+    }
+    // quantize() takes one blob per network input, so the images form one batch
+    return cv::dnn::blobFromImages(images, 1/255.0, size, cv::Scalar(0,0,0),
+                                   true, false, CV_32F);
+}
+
+cv::dnn::Net quantizeNet(cv::dnn::Net& net, const cv::Mat& calibrationBlob) {
+    cv::dnn::Net quantized = net.quantize(calibrationBlob, CV_32F, CV_32F);
+    quantized.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    quantized.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    return quantized;
+}
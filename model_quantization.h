@@ -0,0 +1,34 @@
+#ifndef MODEL_QUANTIZATION_H
+#define MODEL_QUANTIZATION_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <string>
+#include <vector>
+
+// INT8 calibration support for cv::dnn models.
+//
+// The offline step picks representative images from a captured dataset and
+// stores them in a calibration file (YAML):
+//   input_width: 416
+//   input_height: 416
+//   images: [ "/abs/path/0.jpg", ... ]
+// At runtime the images are turned into one input batch and Net::quantize()
+// derives the per-layer INT8 scales from them.
+
+// Evenly spaced sample of up to count images from a dataset directory
+// (searched recursively, sorted so the choice is reproducible)
+std::vector<std::string> selectCalibrationImages(const std::string& datasetDir, int count);
+
+void saveCalibrationSet(const std::string& path,
+                        const std::vector<std::string>& images,
+                        const cv::Size& inputSize);
+
+// Calibration images of a file preprocessed like ModelSession and stacked
+// into one NCHW blob
+cv::Mat loadCalibrationBlob(const std::string& path, cv::Size* inputSize = nullptr);
+
+// INT8 copy of net with FP32 inputs and outputs, so decoding is unchanged
+cv::dnn::Net quantizeNet(cv::dnn::Net& net, const cv::Mat& calibrationBlob);
+
+#endif // MODEL_QUANTIZATION_H
@@ -0,0 +1,65 @@
+#include "model_session.h"
+#include "instrumentation.h"
+#include <fstream>
+#include <stdexcept>
+
+ModelSession::ModelSession(const std::string& configPath,
+                           const std::string& weightsPath,
+                           const cv::Size& inputSize,
+                           const BackendConfig& backend)
+    : inputSize(inputSize) {
+    // Check if files exist
+    if (!configPath.empty() && !std::ifstream(configPath).good()) {
+        throw std::runtime_error("Cannot open config file: " + configPath);
+    }
+    if (!std::ifstream(weightsPath).good()) {
+        throw std::runtime_error("Cannot open weights file: " + weightsPath);
+    }
+
+    engine = createInferenceEngine(configPath, weightsPath, backend);
+
+    warmUp();
+}
+
+ModelSession::ModelSession(std::unique_ptr<InferenceEngine> engine,
+                           const cv::Size& inputSize)
+    : engine(std::move(engine)), inputSize(inputSize) {
+    warmUp();
+}
+
+void ModelSession::warmUp() {
+    // One pass on a blank frame allocates the input blob, the output Mats
+    // and the backend's internal buffers before the first real frame
+    cv::Mat blank = cv::Mat::zeros(inputSize, CV_8UC3);
+    run(blank);
+}
+
+const cv::Mat& ModelSession::preprocess(const cv::Mat& frame) {
+    ScopedTimer timer(Stage::Preprocess);
+    // blobFromImage reuses inputBlob's memory when the shape is unchanged
+    cv::dnn::blobFromImage(frame, inputBlob, 1/255.0, inputSize,
+                          cv::Scalar(0,0,0), true, false, CV_32F);
+    return inputBlob;
+}
+
+const cv::Mat& ModelSession::preprocessBatch(const std::vector<cv::Mat>& frames) {
+    ScopedTimer timer(Stage::Preprocess);
+    cv::dnn::blobFromImages(frames, inputBlob, 1/255.0, inputSize,
+                           cv::Scalar(0,0,0), true, false, CV_32F);
+    return inputBlob;
+}
+
+const std::vector<cv::Mat>& ModelSession::forward() {
+    return forward(inputBlob);
+}
+
+const std::vector<cv::Mat>& ModelSession::forward(const cv::Mat& blob) {
+    ScopedTimer timer(Stage::Forward);
+    engine->forward(blob, outputs);
+    return outputs;
+}
+
+const std::vector<cv::Mat>& ModelSession::run(const cv::Mat& frame) {
+    preprocess(frame);
+    return forward(inputBlob);
+}
@@ -0,0 +1,56 @@
+#ifndef MODEL_SESSION_H
+#define MODEL_SESSION_H
+
+#include "inference_backend.h"
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Owns one loaded network together with everything a forward pass needs:
+// the inference engine (net + resolved output names), the input blob and the
+// output Mats. Each instance is independent, so several models can live in
+// one process, and repeated calls reuse the same buffers instead of
+// allocating per frame.
+class ModelSession {
+public:
+    // Constructors (an empty configPath loads weightsPath as ONNX)
+    ModelSession(const std::string& configPath,
+                 const std::string& weightsPath,
+                 const cv::Size& inputSize = cv::Size(416, 416),
+                 const BackendConfig& backend = BackendConfig());
+
+    // Wrap an engine created elsewhere (e.g. a quantized net)
+    ModelSession(std::unique_ptr<InferenceEngine> engine,
+                 const cv::Size& inputSize = cv::Size(416, 416));
+
+    // Preprocess a frame into the session input blob
+    const cv::Mat& preprocess(const cv::Mat& frame);
+
+    // Preprocess several frames into one NCHW batch blob
+    const cv::Mat& preprocessBatch(const std::vector<cv::Mat>& frames);
+
+    // Run the network on the session blob, or on a blob prepared elsewhere
+    const std::vector<cv::Mat>& forward();
+    const std::vector<cv::Mat>& forward(const cv::Mat& blob);
+
+    // Preprocess + forward in one call
+    const std::vector<cv::Mat>& run(const cv::Mat& frame);
+
+    // Get session information
+    InferenceEngine& getEngine() { return *engine; }
+    std::string getBackendName() const { return engine->name(); }
+    cv::Size getInputSize() const { return inputSize; }
+    const cv::Mat& getInputBlob() const { return inputBlob; }
+    const std::vector<cv::Mat>& getOutputs() const { return outputs; }
+
+private:
+    std::unique_ptr<InferenceEngine> engine;
+    cv::Size inputSize;
+    cv::Mat inputBlob;
+    std::vector<cv::Mat> outputs;
+
+    void warmUp();
+};
+
+#endif // MODEL_SESSION_H
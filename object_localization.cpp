@@ -0,0 +1,234 @@
+#include "object_localization.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+CameraIntrinsics loadIntrinsics(const std::string& path) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot open intrinsics file: " + path);
+    }
+
+    CameraIntrinsics intrinsics;
+    intrinsics.width = (int)fs["width"];
+    intrinsics.height = (int)fs["height"];
+    intrinsics.fx = (float)fs["fx"];
+    intrinsics.fy = (float)fs["fy"];
+    intrinsics.ppx = (float)fs["ppx"];
+    intrinsics.ppy = (float)fs["ppy"];
+    if (intrinsics.fx <= 0 || intrinsics.fy <= 0) {
+        throw std::runtime_error("Invalid focal length in intrinsics file: " + path);
+    }
+    return intrinsics;
+}
+
+float loadDepthScale(const std::string& path) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot open intrinsics file: " + path);
+    }
+    // Z16 default of the RealSense D400 series
+    return fs["depth_scale"].empty() ? 0.001f : (float)fs["depth_scale"];
+}
+
+void saveIntrinsics(const std::string& path, const CameraIntrinsics& intrinsics,
+                    float depthScale) {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot write intrinsics file: " + path);
+    }
+    fs << "width" << intrinsics.width;
+    fs << "height" << intrinsics.height;
+    fs << "fx" << intrinsics.fx;
+    fs << "fy" << intrinsics.fy;
+    fs << "ppx" << intrinsics.ppx;
+    fs << "ppy" << intrinsics.ppy;
+    fs << "depth_scale" << depthScale;
+}
+
+ObjectLocalizer::ObjectLocalizer(const CameraIntrinsics& intrinsics, float depthScale,
+                                 const LocalizationConfig& config)
+    : intrinsics(intrinsics), depthScale(depthScale), config(config) {
+    if (intrinsics.fx <= 0 || intrinsics.fy <= 0 || depthScale <= 0) {
+        throw std::runtime_error("ObjectLocalizer needs positive focal lengths and depth scale");
+    }
+
+    // Deprojection is x = (u - ppx) / fx * z, so the division is done once
+    // per column/row here instead of once per pixel
+    columnFactors.resize(std::max(0, intrinsics.width));
+    for (int u = 0; u < intrinsics.width; ++u) {
+        columnFactors[u] = (u - intrinsics.ppx) / intrinsics.fx;
+    }
+    rowFactors.resize(std::max(0, intrinsics.height));
+    for (int v = 0; v < intrinsics.height; ++v) {
+        rowFactors[v] = (v - intrinsics.ppy) / intrinsics.fy;
+    }
+}
+
+std::vector<ObjectPosition> ObjectLocalizer::localize(const cv::Mat& depth,
+                                                      const std::vector<Detection>& detections) const {
+    std::vector<ObjectPosition> positions(detections.size());
+    if (detections.size() == 1) {
+        positions[0] = localizeBox(depth, detections[0].box);
+        return positions;
+    }
+
+    // Boxes are independent; each stripe writes only its own entries
+    cv::parallel_for_(cv::Range(0, (int)detections.size()), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            positions[i] = localizeBox(depth, detections[i].box);
+        }
+    });
+    return positions;
+}
+
+// p-th percentile; reorders values
+static float percentile(std::vector<float>& values, float p) {
+    size_t k = std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5f));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+ObjectPosition ObjectLocalizer::localizeBox(const cv::Mat& depth, const cv::Rect& box) const {
+    if (depth.type() != CV_16U) {
+        throw std::runtime_error("ObjectLocalizer expects a CV_16U depth image");
+    }
+    if (depth.cols != intrinsics.width || depth.rows != intrinsics.height) {
+        throw std::runtime_error("Depth image size does not match the intrinsics");
+    }
+
+    ObjectPosition position;
+
+    // Box edges are mostly background, only the inner part is sampled
+    int dx = (int)(box.width * config.borderShrink);
+    int dy = (int)(box.height * config.borderShrink);
+    cv::Rect inner(box.x + dx, box.y + dy, box.width - 2 * dx, box.height - 2 * dy);
+    inner &= cv::Rect(0, 0, depth.cols, depth.rows);
+    if (inner.area() <= 0) {
+        return position;
+    }
+
+    // Subsample large boxes so the cost per box is bounded
+    int stride = std::max(1, (int)std::ceil(std::sqrt((double)inner.area() / config.maxSamples)));
+
+    // Depth histogram in raw units, bin 0 starts at minDepth
+    const float minRaw = config.minDepth / depthScale;
+    const float maxRaw = config.maxDepth / depthScale;
+    const float invBinRaw = depthScale / config.binSize;
+    const int numBins = std::max(1, (int)std::ceil((config.maxDepth - config.minDepth) / config.binSize));
+    std::vector<int> histogram(numBins, 0);
+    int validSamples = 0;
+
+    for (int v = inner.y; v < inner.y + inner.height; v += stride) {
+        const ushort* row = depth.ptr<ushort>(v);
+        for (int u = inner.x; u < inner.x + inner.width; u += stride) {
+            float raw = row[u];
+            if (raw < minRaw || raw >= maxRaw) {
+                continue;
+            }
+            int bin = std::min(numBins - 1, (int)((raw - minRaw) * invBinRaw));
+            histogram[bin]++;
+            validSamples++;
+        }
+    }
+    if (validSamples < config.minPoints) {
+        return position;
+    }
+
+    // Clusters are runs of occupied bins with at most maxGapBins empty bins
+    // inside. The object is the most populated cluster, the nearer one on ties.
+    int bestFirst = 0, bestLast = -1, bestCount = 0;
+    int first = -1, last = -1, count = 0;
+    auto closeCluster = [&]() {
+        if (count > bestCount) {
+            bestFirst = first;
+            bestLast = last;
+            bestCount = count;
+        }
+        first = -1;
+        count = 0;
+    };
+    for (int b = 0; b < numBins; ++b) {
+        if (histogram[b] == 0) {
+            continue;
+        }
+        if (first >= 0 && b - last - 1 > config.maxGapBins) {
+            closeCluster();
+        }
+        if (first < 0) {
+            first = b;
+        }
+        last = b;
+        count += histogram[b];
+    }
+    if (first >= 0) {
+        closeCluster();
+    }
+    if (bestCount < config.minPoints) {
+        return position;
+    }
+
+    // Raw depth window of the object cluster
+    const float loRaw = minRaw + bestFirst / invBinRaw;
+    const float hiRaw = minRaw + (bestLast + 1) / invBinRaw;
+
+    std::vector<float> xs, ys, zs;
+    xs.reserve(bestCount);
+    ys.reserve(bestCount);
+    zs.reserve(bestCount);
+    for (int v = inner.y; v < inner.y + inner.height; v += stride) {
+        const ushort* row = depth.ptr<ushort>(v);
+        const float rowFactor = rowFactors[v];
+        for (int u = inner.x; u < inner.x + inner.width; u += stride) {
+            float raw = row[u];
+            if (raw < loRaw || raw >= hiRaw) {
+                continue;
+            }
+            float z = raw * depthScale;
+            xs.push_back(columnFactors[u] * z);
+            ys.push_back(rowFactor * z);
+            zs.push_back(z);
+        }
+    }
+    if ((int)zs.size() < config.minPoints) {
+        return position;
+    }
+
+    position.valid = true;
+    position.numPoints = (int)zs.size();
+    position.coverage = (float)zs.size() / validSamples;
+    position.centroid = cv::Point3f(percentile(xs, 0.5f), percentile(ys, 0.5f), percentile(zs, 0.5f));
+    position.minCorner = cv::Point3f(percentile(xs, config.lowPercentile),
+                                     percentile(ys, config.lowPercentile),
+                                     percentile(zs, config.lowPercentile));
+    position.maxCorner = cv::Point3f(percentile(xs, config.highPercentile),
+                                     percentile(ys, config.highPercentile),
+                                     percentile(zs, config.highPercentile));
+    return position;
+}
+
+void writeObjectPositions(const std::string& path,
+                          const std::vector<Detection>& detections,
+                          const std::vector<ObjectPosition>& positions) {
+    if (detections.size() != positions.size()) {
+        throw std::runtime_error("writeObjectPositions: detections and positions differ in size");
+    }
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot write object positions: " + path);
+    }
+
+    fs << "objects" << "[";
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const ObjectPosition& p = positions[i];
+        fs << "{";
+        fs << "class_id" << detections[i].class_id;
+        fs << "valid" << (int)p.valid;
+        fs << "centroid" << "[" << p.centroid.x << p.centroid.y << p.centroid.z << "]";
+        fs << "min" << "[" << p.minCorner.x << p.minCorner.y << p.minCorner.z << "]";
+        fs << "max" << "[" << p.maxCorner.x << p.maxCorner.y << p.maxCorner.z << "]";
+        fs << "points" << p.numPoints;
+        fs << "}";
+    }
+    fs << "]";
+}
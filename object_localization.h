@@ -0,0 +1,81 @@
+#ifndef OBJECT_LOCALIZATION_H
+#define OBJECT_LOCALIZATION_H
+
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Pinhole intrinsics of the stream the depth is aligned to (normally color).
+// Saved next to recorded depth so frames can be replayed without a camera.
+struct CameraIntrinsics {
+    int width = 0;
+    int height = 0;
+    float fx = 0.0f;
+    float fy = 0.0f;
+    float ppx = 0.0f;
+    float ppy = 0.0f;
+};
+
+CameraIntrinsics loadIntrinsics(const std::string& path);
+void saveIntrinsics(const std::string& path, const CameraIntrinsics& intrinsics,
+                    float depthScale);
+float loadDepthScale(const std::string& path);
+
+struct LocalizationConfig {
+    float minDepth = 0.1f;        // Meters, closer readings are noise
+    float maxDepth = 10.0f;       // Meters
+    float binSize = 0.02f;        // Depth histogram bin (meters)
+    int maxGapBins = 3;           // Empty bins allowed inside one cluster
+    float borderShrink = 0.1f;    // Ignore this fraction of the box per side
+    int maxSamples = 20000;       // Per box, larger boxes are subsampled
+    int minPoints = 30;           // Fewer cluster points -> invalid position
+    float lowPercentile = 0.05f;  // Extents are percentiles, not min/max
+    float highPercentile = 0.95f;
+};
+
+// 3D position of one detection in camera coordinates (meters,
+// x right, y down, z forward)
+struct ObjectPosition {
+    bool valid = false;
+    cv::Point3f centroid;     // Per-axis median of the object points
+    cv::Point3f minCorner;    // Percentile extents of the object points
+    cv::Point3f maxCorner;
+    int numPoints = 0;        // Points in the object cluster
+    float coverage = 0.0f;    // Cluster points / valid depth samples
+
+    cv::Point3f size() const { return maxCorner - minCorner; }
+};
+
+// Deprojects the depth pixels inside each detection box. Background and
+// foreground clutter are separated by clustering the box depths and keeping
+// the dominant cluster. Boxes are processed in parallel, and the per-pixel
+// work is a table lookup and two multiplies.
+class ObjectLocalizer {
+public:
+    // depthScale converts raw Z16 units to meters (usually 0.001)
+    ObjectLocalizer(const CameraIntrinsics& intrinsics, float depthScale,
+                    const LocalizationConfig& config = LocalizationConfig());
+
+    // depth: CV_16U aligned to the frame the detections come from
+    std::vector<ObjectPosition> localize(const cv::Mat& depth,
+                                         const std::vector<Detection>& detections) const;
+    ObjectPosition localizeBox(const cv::Mat& depth, const cv::Rect& box) const;
+
+    const CameraIntrinsics& getIntrinsics() const { return intrinsics; }
+
+private:
+    CameraIntrinsics intrinsics;
+    float depthScale;
+    LocalizationConfig config;
+    std::vector<float> columnFactors;   // (u - ppx) / fx
+    std::vector<float> rowFactors;      // (v - ppy) / fy
+};
+
+// Sidecar next to a label file: one entry per detection, same order
+//   objects: [ { class_id, valid, centroid: [x,y,z], min: [...], max: [...], points } ]
+void writeObjectPositions(const std::string& path,
+                          const std::vector<Detection>& detections,
+                          const std::vector<ObjectPosition>& positions);
+
+#endif // OBJECT_LOCALIZATION_H
@@ -0,0 +1,181 @@
+#include "overlay_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+const int kFont = cv::FONT_HERSHEY_SIMPLEX;
+const int kLabelPadding = 2;
+
+uint32_t packColor(const cv::Scalar& color) {
+    return ((uint32_t)color[0] & 0xFF) | (((uint32_t)color[1] & 0xFF) << 8) |
+           (((uint32_t)color[2] & 0xFF) << 16);
+}
+
+} // namespace
+
+cv::Scalar classColor(int classId) {
+    // Golden-ratio hue steps keep neighbouring ids far apart on the wheel
+    double hue = std::fmod(std::max(classId, 0) * 0.618033988749895, 1.0) * 6.0;
+    double s = 0.75, v = 1.0;
+    int sector = (int)hue;
+    double f = hue - sector;
+    double p = v * (1 - s), q = v * (1 - s * f), t = v * (1 - s * (1 - f));
+    double r, g, b;
+    switch (sector) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        default: r = v; g = p; b = q; break;
+    }
+    return cv::Scalar(std::round(b * 255), std::round(g * 255), std::round(r * 255));
+}
+
+const std::string& confidenceText(float confidence) {
+    static const std::vector<std::string> table = [] {
+        std::vector<std::string> texts;
+        for (int i = 0; i <= 100; ++i) {
+            texts.push_back(cv::format("%.2f", i / 100.0));
+        }
+        return texts;
+    }();
+    int index = (int)std::lround(std::min(std::max(confidence, 0.0f), 1.0f) * 100);
+    return table[index];
+}
+
+OverlayRenderer::OverlayRenderer(size_t maxCachedLabels) : maxCachedLabels(maxCachedLabels) {}
+
+void OverlayRenderer::begin(const cv::Size& frameSize) {
+    if (layer.size() != frameSize) {
+        layer = cv::Mat::zeros(frameSize, CV_8UC3);
+        mask = cv::Mat::zeros(frameSize, CV_8U);
+        lastDirty = cv::Rect();
+    } else if (!lastDirty.empty()) {
+        layer(lastDirty).setTo(cv::Scalar::all(0));
+        mask(lastDirty).setTo(cv::Scalar::all(0));
+    }
+    dirty = cv::Rect();
+    boxes.clear();
+    labels.clear();
+
+    // Labels of the previous frame are no longer referenced here
+    if (tiles.size() > maxCachedLabels) {
+        tiles.clear();
+    }
+}
+
+void OverlayRenderer::markDirty(const cv::Rect& area) {
+    cv::Rect clipped = area & cv::Rect(0, 0, layer.cols, layer.rows);
+    if (clipped.empty()) return;
+    dirty = dirty.empty() ? clipped : (dirty | clipped);
+}
+
+const OverlayRenderer::Tile& OverlayRenderer::tile(const std::string& text, const TextStyle& style) {
+    std::string key = text;
+    key += '\x1f';
+    key += std::to_string(packColor(style.color)) + ':' + std::to_string(packColor(style.background)) +
+           ':' + std::to_string(style.scale) + ':' + std::to_string(style.thickness) +
+           (style.filledBackground ? ":f" : ":t");
+
+    auto it = tiles.find(key);
+    if (it != tiles.end()) {
+        return it->second;
+    }
+
+    int baseLine = 0;
+    cv::Size textSize = cv::getTextSize(text, kFont, style.scale, style.thickness, &baseLine);
+    int pad = style.filledBackground ? kLabelPadding : 0;
+
+    Tile t;
+    t.origin = cv::Point(pad, pad + textSize.height);
+    cv::Size size(textSize.width + 2 * pad, textSize.height + baseLine + 2 * pad);
+    if (style.filledBackground) {
+        t.pixels = cv::Mat(size, CV_8UC3, style.background);
+        cv::putText(t.pixels, text, t.origin, kFont, style.scale, style.color, style.thickness);
+        t.mask = cv::Mat(size, CV_8U, cv::Scalar(255));
+    } else {
+        t.pixels = cv::Mat(size, CV_8UC3, style.color);
+        t.mask = cv::Mat::zeros(size, CV_8U);
+        cv::putText(t.mask, text, t.origin, kFont, style.scale, cv::Scalar(255), style.thickness);
+    }
+    return tiles.emplace(key, t).first->second;
+}
+
+void OverlayRenderer::addBox(const cv::Rect& box, const cv::Scalar& color, int thickness) {
+    BoxBatch& batch = boxes[{packColor(color), thickness}];
+    batch.color = color;
+    batch.thickness = thickness;
+    batch.outlines.push_back({box.tl(), cv::Point(box.x + box.width - 1, box.y),
+                              cv::Point(box.x + box.width - 1, box.y + box.height - 1),
+                              cv::Point(box.x, box.y + box.height - 1)});
+    markDirty(cv::Rect(box.x - thickness, box.y - thickness,
+                       box.width + 2 * thickness, box.height + 2 * thickness));
+}
+
+void OverlayRenderer::addText(const std::string& text, const cv::Point& origin,
+                              const TextStyle& style, const cv::Rect& clip) {
+    const Tile& t = tile(text, style);
+    labels.push_back({&t, origin - t.origin, clip});
+    markDirty(cv::Rect(origin - t.origin, t.pixels.size()));
+}
+
+void OverlayRenderer::addLabeledBox(const cv::Rect& box, const std::string& label,
+                                    const cv::Scalar& boxColor, const TextStyle& style,
+                                    int thickness, const cv::Rect& clip) {
+    cv::Rect bounds = clip.empty() ? cv::Rect(0, 0, layer.cols, layer.rows) : clip;
+    cv::Rect visible = box & bounds;
+    if (visible.empty()) return;
+    addBox(visible, boxColor, thickness);
+
+    const Tile& t = tile(label, style);
+    cv::Point topLeft(visible.x, visible.y - t.pixels.rows);
+    if (topLeft.y < bounds.y) {
+        topLeft.y = visible.y;
+    }
+    topLeft.x = std::max(bounds.x, std::min(topLeft.x, bounds.x + bounds.width - t.pixels.cols));
+    labels.push_back({&t, topLeft, bounds});
+    markDirty(cv::Rect(topLeft, t.pixels.size()));
+}
+
+void OverlayRenderer::addDetection(const Detection& det, const cv::Rect& clip) {
+    cv::Scalar color = classColor(det.class_id);
+    TextStyle style;
+    style.background = color;
+    style.color = cv::Scalar(0, 0, 0);
+    addLabeledBox(det.box, det.class_name + " " + confidenceText(det.confidence),
+                  color, style, 2, clip);
+}
+
+void OverlayRenderer::compose(cv::Mat& frame) {
+    if (layer.size() != frame.size()) {
+        throw std::runtime_error("Overlay size does not match the frame, call begin() first");
+    }
+
+    // Boxes first, one call per color, then labels on top of them
+    for (const auto& entry : boxes) {
+        const BoxBatch& batch = entry.second;
+        cv::polylines(layer, batch.outlines, true, batch.color, batch.thickness);
+        cv::polylines(mask, batch.outlines, true, cv::Scalar(255), batch.thickness);
+    }
+
+    cv::Rect frameRect(0, 0, layer.cols, layer.rows);
+    for (const auto& label : labels) {
+        cv::Rect bounds = label.clip.empty() ? frameRect : (label.clip & frameRect);
+        cv::Rect target = cv::Rect(label.topLeft, label.tile->pixels.size()) & bounds;
+        if (target.empty()) continue;
+        cv::Rect source(target.tl() - label.topLeft, target.size());
+        label.tile->pixels(source).copyTo(layer(target), label.tile->mask(source));
+        cv::Mat coverage = mask(target);
+        cv::bitwise_or(coverage, label.tile->mask(source), coverage);
+    }
+
+    if (!dirty.empty()) {
+        layer(dirty).copyTo(frame(dirty), mask(dirty));
+    }
+    lastDirty = dirty;
+    boxes.clear();
+    labels.clear();
+}
@@ -0,0 +1,94 @@
+#ifndef OVERLAY_RENDERER_H
+#define OVERLAY_RENDERER_H
+
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Font and colors of one text label
+struct TextStyle {
+    double scale = 0.5;
+    int thickness = 1;
+    cv::Scalar color = cv::Scalar(255, 255, 255);
+    cv::Scalar background = cv::Scalar(0, 0, 0);
+    bool filledBackground = true;    // false = text only, frame shows through
+};
+
+// Stable, well separated BGR color for a class id (same on every frame)
+cv::Scalar classColor(int classId);
+
+// "0.87" for a confidence, from a precomputed table instead of format()
+const std::string& confidenceText(float confidence);
+
+// Draws boxes and labels onto an overlay layer that is composited onto the
+// frame once. Per frame:
+//   renderer.begin(frame.size());
+//   renderer.addDetection(det); ...
+//   renderer.compose(display);
+// Labels are rendered to bitmaps once and cached by text and style, so a
+// repeated label costs one masked copy instead of getTextSize + putText.
+// Boxes are collected and drawn with one polylines call per color.
+class OverlayRenderer {
+public:
+    explicit OverlayRenderer(size_t maxCachedLabels = 4096);
+
+    // Start a new overlay; clears only what the previous frame drew
+    void begin(const cv::Size& frameSize);
+
+    void addBox(const cv::Rect& box, const cv::Scalar& color, int thickness = 2);
+
+    // Text with its baseline-left at origin, like cv::putText. Kept inside
+    // clip when clip is not empty.
+    void addText(const std::string& text, const cv::Point& origin,
+                 const TextStyle& style = TextStyle(), const cv::Rect& clip = cv::Rect());
+
+    // Box plus label above it (inside the box top when there is no room),
+    // both kept inside clip when clip is not empty
+    void addLabeledBox(const cv::Rect& box, const std::string& label,
+                       const cv::Scalar& boxColor, const TextStyle& style,
+                       int thickness = 2, const cv::Rect& clip = cv::Rect());
+
+    // "<class_name> 0.87" in the class color
+    void addDetection(const Detection& det, const cv::Rect& clip = cv::Rect());
+
+    // Copy the overlay onto the frame
+    void compose(cv::Mat& frame);
+
+    // The layer and its coverage mask, e.g. for compositing elsewhere
+    const cv::Mat& getLayer() const { return layer; }
+    const cv::Mat& getMask() const { return mask; }
+
+private:
+    struct Tile {
+        cv::Mat pixels;     // CV_8UC3
+        cv::Mat mask;       // CV_8U, 255 where the tile covers the frame
+        cv::Point origin;   // Text baseline-left inside the tile
+    };
+    struct PendingLabel {
+        const Tile* tile;
+        cv::Point topLeft;
+        cv::Rect clip;
+    };
+    struct BoxBatch {
+        cv::Scalar color;
+        int thickness;
+        std::vector<std::vector<cv::Point>> outlines;
+    };
+
+    size_t maxCachedLabels;
+    std::unordered_map<std::string, Tile> tiles;
+    std::map<std::pair<uint32_t, int>, BoxBatch> boxes;    // (packed color, thickness)
+    std::vector<PendingLabel> labels;
+    cv::Mat layer;
+    cv::Mat mask;
+    cv::Rect dirty;         // Area drawn since begin()
+    cv::Rect lastDirty;     // Area drawn by the previous frame
+
+    const Tile& tile(const std::string& text, const TextStyle& style);
+    void markDirty(const cv::Rect& area);
+};
+
+#endif // OVERLAY_RENDERER_H
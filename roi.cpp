@@ -40,6 +40,25 @@ cv::Mat ROIBox::extractROI(const cv::Mat& frame) const {
     return frame(roi).clone();
 }
 
+cv::Rect ROIBox::clipToFrame(const cv::Size& frameSize) const {
+    return roi & cv::Rect(0, 0, frameSize.width, frameSize.height);
+}
+
+cv::Mat ROIBox::view(const cv::Mat& frame) const {
+    cv::Rect clipped = clipToFrame(frame.size());
+    return clipped.empty() ? cv::Mat() : frame(clipped);
+}
+
+void ROIBox::copyTo(const cv::Mat& frame, cv::Mat& dst) const {
+    cv::Rect clipped = clipToFrame(frame.size());
+    if (clipped.empty()) {
+        dst.release();
+        return;
+    }
+    // Mat::copyTo only reallocates when size or type differ
+    frame(clipped).copyTo(dst);
+}
+
 cv::Rect ROIBox::clipRectToROI(const cv::Rect& rect) const {
     // Convert rect to ROI coordinates
     cv::Rect localRect = rect;
@@ -56,9 +75,216 @@ cv::Rect ROIBox::clipRectToROI(const cv::Rect& rect) const {
     return clipped;
 }
 
-void ROIBox::draw(cv::Mat& frame, const cv::Scalar& color, int thickness) const {
-    if (!isWithinFrame(frame)) {
-        throw std::runtime_error("Cannot draw ROI: outside frame boundaries");
+void ROIBox::clipRectsToROI(const std::vector<cv::Rect>& rects, std::vector<cv::Rect>& out) const {
+    out.resize(rects.size());
+    for (size_t i = 0; i < rects.size(); ++i) {
+        out[i] = clipRectToROI(rects[i]);
     }
+}
+
+void ROIBox::draw(cv::Mat& frame, const cv::Scalar& color, int thickness) const {
+    // cv::rectangle clips to the frame, the part inside is still drawn
     cv::rectangle(frame, roi, color, thickness);
-}
\ No newline at end of file
+}
+
+void drawRects(cv::Mat& frame, const std::vector<cv::Rect>& rects,
+               const cv::Scalar& color, int thickness) {
+    std::vector<std::vector<cv::Point>> outlines;
+    outlines.reserve(rects.size());
+    for (const auto& r : rects) {
+        int right = r.x + r.width - 1;
+        int bottom = r.y + r.height - 1;
+        outlines.push_back({r.tl(), cv::Point(right, r.y), cv::Point(right, bottom),
+                            cv::Point(r.x, bottom)});
+    }
+    cv::polylines(frame, outlines, true, color, thickness);
+}
+
+void drawROIs(cv::Mat& frame, const std::vector<ROIBox>& rois,
+              const cv::Scalar& color, int thickness) {
+    std::vector<cv::Rect> rects;
+    rects.reserve(rois.size());
+    for (const auto& r : rois) {
+        rects.push_back(r.getROI());
+    }
+    drawRects(frame, rects, color, thickness);
+}
+
+ROISet::ROISet(const cv::Size& frameSize) : frameSize(frameSize) {}
+
+int ROISet::addRect(const cv::Rect& rect, const std::string& name) {
+    if (rect.width <= 0 || rect.height <= 0) {
+        throw std::invalid_argument("ROI dimensions must be positive");
+    }
+    // Corners are inclusive pixels, so the bounding rect equals rect
+    int right = rect.x + rect.width - 1;
+    int bottom = rect.y + rect.height - 1;
+    return addZone({rect.tl(), cv::Point(right, rect.y),
+                    cv::Point(right, bottom), cv::Point(rect.x, bottom)}, name);
+}
+
+int ROISet::addPolygon(const std::vector<cv::Point>& polygon, const std::string& name) {
+    if (polygon.size() < 3) {
+        throw std::invalid_argument("ROI polygon needs at least 3 points");
+    }
+    return addZone(polygon, name);
+}
+
+int ROISet::addROI(const ROIBox& box, const std::string& name) {
+    return addRect(box.getROI(), name);
+}
+
+int ROISet::addZone(const std::vector<cv::Point>& polygon, const std::string& name) {
+    if (zones.size() >= 254) {
+        throw std::runtime_error("Too many ROI zones (max 254)");
+    }
+    zones.push_back({name.empty() ? "zone" + std::to_string(zones.size()) : name,
+                     polygon, cv::boundingRect(polygon)});
+    built = false;
+    return (int)zones.size() - 1;
+}
+
+void ROISet::clear() {
+    zones.clear();
+    built = false;
+}
+
+void ROISet::setFrameSize(const cv::Size& size) {
+    if (size == frameSize) return;
+    frameSize = size;
+    built = false;
+}
+
+void ROISet::build() const {
+    if (built) return;
+    built = true;
+
+    zoneAreas.assign(zones.size(), cv::Rect());
+    zoneIntegrals.assign(zones.size(), cv::Mat());
+    if (frameSize.width <= 0 || frameSize.height <= 0) {
+        unionMask.release();
+        labelMap.release();
+        unionIntegral.release();
+        return;
+    }
+
+    unionMask = cv::Mat::zeros(frameSize, CV_8U);
+    labelMap = cv::Mat::zeros(frameSize, CV_8U);
+
+    // Each zone is rasterized over its bounding rect only: rect zones as
+    // a block, polygons as drawn
+    cv::Mat zoneMask;
+    for (int i = (int)zones.size() - 1; i >= 0; --i) {
+        const Zone& zone = zones[i];
+        cv::Rect area = zone.bounds & cv::Rect(0, 0, frameSize.width, frameSize.height);
+        zoneAreas[i] = area;
+        if (area.empty()) continue;
+
+        bool isRect = zone.polygon.size() == 4 &&
+                      zone.polygon[0] == zone.bounds.tl() &&
+                      zone.polygon[2] == zone.bounds.br() - cv::Point(1, 1);
+        if (isRect) {
+            zoneMask.create(area.size(), CV_8U);
+            zoneMask.setTo(cv::Scalar(1));
+        } else {
+            zoneMask = cv::Mat::zeros(area.size(), CV_8U);
+            cv::fillPoly(zoneMask, std::vector<std::vector<cv::Point>>{zone.polygon}, cv::Scalar(1),
+                         cv::LINE_8, 0, cv::Point(-area.x, -area.y));
+        }
+
+        // Lower indices are written last, so the first zone wins on overlap
+        labelMap(area).setTo(cv::Scalar(i + 1), zoneMask);
+        unionMask(area).setTo(cv::Scalar(255), zoneMask);
+        cv::integral(zoneMask, zoneIntegrals[i], CV_32S);
+    }
+
+    cv::Mat unionOnes;
+    unionMask.convertTo(unionOnes, CV_8U, 1.0 / 255);
+    cv::integral(unionOnes, unionIntegral, CV_32S);
+}
+
+bool ROISet::contains(const cv::Point& point) const {
+    return zoneAt(point) >= 0;
+}
+
+int ROISet::zoneAt(const cv::Point& point) const {
+    build();
+    if (labelMap.empty() || point.x < 0 || point.y < 0 ||
+        point.x >= labelMap.cols || point.y >= labelMap.rows) {
+        return -1;
+    }
+    return (int)labelMap.at<uchar>(point.y, point.x) - 1;
+}
+
+// integral covers area; the rest of the frame counts as outside
+double ROISet::integralFraction(const cv::Mat& integral, const cv::Rect& area,
+                                const cv::Rect& box) const {
+    if (integral.empty() || box.width <= 0 || box.height <= 0) return 0.0;
+    cv::Rect inside = box & area;
+    if (inside.empty()) return 0.0;
+
+    // Sum over the box from four integral image lookups
+    int x0 = inside.x - area.x, y0 = inside.y - area.y;
+    int x1 = x0 + inside.width, y1 = y0 + inside.height;
+    int covered = integral.at<int>(y1, x1) - integral.at<int>(y0, x1) -
+                  integral.at<int>(y1, x0) + integral.at<int>(y0, x0);
+    return (double)covered / ((double)box.width * box.height);
+}
+
+double ROISet::overlapFraction(const cv::Rect& box) const {
+    build();
+    return integralFraction(unionIntegral, cv::Rect(0, 0, frameSize.width, frameSize.height), box);
+}
+
+double ROISet::overlapFraction(const cv::Rect& box, int zone) const {
+    build();
+    if (zone < 0 || zone >= (int)zoneIntegrals.size()) return 0.0;
+    return integralFraction(zoneIntegrals[zone], zoneAreas[zone], box);
+}
+
+std::vector<int> ROISet::filterByCenter(const std::vector<cv::Rect>& boxes) const {
+    std::vector<int> kept;
+    kept.reserve(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const cv::Rect& box = boxes[i];
+        if (contains(cv::Point(box.x + box.width / 2, box.y + box.height / 2))) {
+            kept.push_back((int)i);
+        }
+    }
+    return kept;
+}
+
+std::vector<int> ROISet::filterByOverlap(const std::vector<cv::Rect>& boxes,
+                                         double minFraction) const {
+    std::vector<int> kept;
+    kept.reserve(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        double fraction = overlapFraction(boxes[i]);
+        if (fraction > 0.0 && fraction >= minFraction) {
+            kept.push_back((int)i);
+        }
+    }
+    return kept;
+}
+
+std::vector<Detection> ROISet::filterDetections(const std::vector<Detection>& detections,
+                                                double minFraction) const {
+    std::vector<Detection> kept;
+    kept.reserve(detections.size());
+    for (const auto& det : detections) {
+        const cv::Rect& box = det.box;
+        if (contains(cv::Point(box.x + box.width / 2, box.y + box.height / 2)) &&
+            (minFraction <= 0.0 || overlapFraction(box) >= minFraction)) {
+            kept.push_back(det);
+        }
+    }
+    return kept;
+}
+
+void ROISet::draw(cv::Mat& frame, const cv::Scalar& color, int thickness) const {
+    std::vector<std::vector<cv::Point>> outlines;
+    for (const auto& zone : zones) {
+        outlines.push_back(zone.polygon);
+    }
+    cv::polylines(frame, outlines, true, color, thickness);
+}
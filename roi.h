@@ -1,7 +1,10 @@
 #ifndef ROI_H
 #define ROI_H
 
+#include "yolo_detection.h"
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
 
 class ROIBox {
 public:
@@ -16,13 +19,27 @@ public:
 
     // Get ROI information
     cv::Rect getROI() const { return roi; }
+
+    // Owning copy; throws when the ROI is not fully inside the frame
     cv::Mat extractROI(const cv::Mat& frame) const;
 
+    // Non-owning view of the ROI clipped to the frame (empty if disjoint).
+    // Shares the frame's pixels: no copy, valid as long as the frame is.
+    cv::Mat view(const cv::Mat& frame) const;
+
+    // Copy the clipped ROI into dst, reusing dst's buffer when it already
+    // has the right size and type
+    void copyTo(const cv::Mat& frame, cv::Mat& dst) const;
+
     // Validation and clipping
     bool isWithinFrame(const cv::Mat& frame) const;
+    cv::Rect clipToFrame(const cv::Size& frameSize) const;
     cv::Rect clipRectToROI(const cv::Rect& rect) const;
 
-    // Draw ROI on frame
+    // Batch clip into ROI coordinates; out is resized and reused
+    void clipRectsToROI(const std::vector<cv::Rect>& rects, std::vector<cv::Rect>& out) const;
+
+    // Draw ROI on frame, clipped to the frame
     void draw(cv::Mat& frame, const cv::Scalar& color = cv::Scalar(255, 0, 0), 
              int thickness = 2) const;
 
@@ -31,4 +48,87 @@ private:
     void validateROI();
 };
 
+// Draw many ROIs / rects with one polylines call
+void drawROIs(cv::Mat& frame, const std::vector<ROIBox>& rois,
+              const cv::Scalar& color = cv::Scalar(255, 0, 0), int thickness = 2);
+void drawRects(cv::Mat& frame, const std::vector<cv::Rect>& rects,
+               const cv::Scalar& color = cv::Scalar(255, 0, 0), int thickness = 2);
+
+// Several zones (rectangles and polygons) over frames of one size. A mask
+// bitmap, a zone label map and integral images are built once, on the
+// first query after the zones or the frame size change, so per-detection
+// queries are O(1). Per-zone integrals cover only the zone's bounding
+// rect. Queries may run from several threads once the set is built; call
+// build() before sharing it.
+class ROISet {
+public:
+    // Constructors
+    ROISet() = default;
+    explicit ROISet(const cv::Size& frameSize);
+
+    // Add a zone; returns its index. At most 254 zones.
+    int addRect(const cv::Rect& rect, const std::string& name = "");
+    int addPolygon(const std::vector<cv::Point>& polygon, const std::string& name = "");
+    int addROI(const ROIBox& box, const std::string& name = "");
+    void clear();
+
+    // The masks are rebuilt for the new size on the next query
+    void setFrameSize(const cv::Size& size);
+    cv::Size getFrameSize() const { return frameSize; }
+
+    // Build the masks now instead of on the first query
+    void build() const;
+
+    size_t size() const { return zones.size(); }
+    const std::string& getName(int zone) const { return zones[zone].name; }
+    const std::vector<cv::Point>& getPolygon(int zone) const { return zones[zone].polygon; }
+
+    // O(1) point tests; points outside the frame are in no zone
+    bool contains(const cv::Point& point) const;
+    int zoneAt(const cv::Point& point) const;   // First zone containing point, -1 if none
+
+    // O(1) fraction of the box area inside any zone / inside one zone
+    double overlapFraction(const cv::Rect& box) const;
+    double overlapFraction(const cv::Rect& box, int zone) const;
+
+    // Batch filters over a whole detection array; return indices of kept boxes
+    std::vector<int> filterByCenter(const std::vector<cv::Rect>& boxes) const;
+    std::vector<int> filterByOverlap(const std::vector<cv::Rect>& boxes, double minFraction) const;
+
+    // Keep detections whose center is inside a zone and that have at least
+    // minFraction of their area inside the zones
+    std::vector<Detection> filterDetections(const std::vector<Detection>& detections,
+                                            double minFraction = 0.0) const;
+
+    // Union mask (255 inside any zone) and label map (zone index + 1, 0 = none)
+    const cv::Mat& getMask() const { build(); return unionMask; }
+    const cv::Mat& getLabelMap() const { build(); return labelMap; }
+
+    // Draw zone outlines
+    void draw(cv::Mat& frame, const cv::Scalar& color = cv::Scalar(255, 0, 0),
+              int thickness = 2) const;
+
+private:
+    struct Zone {
+        std::string name;
+        std::vector<cv::Point> polygon;
+        cv::Rect bounds;
+    };
+
+    std::vector<Zone> zones;
+    cv::Size frameSize;
+
+    // Built lazily by build()
+    mutable bool built = false;
+    mutable cv::Mat unionMask;                    // CV_8U
+    mutable cv::Mat labelMap;                     // CV_8U
+    mutable cv::Mat unionIntegral;                // CV_32S, (rows+1) x (cols+1)
+    mutable std::vector<cv::Rect> zoneAreas;      // Zone bounds clipped to the frame
+    mutable std::vector<cv::Mat> zoneIntegrals;   // CV_32S over zoneAreas, one per zone
+
+    int addZone(const std::vector<cv::Point>& polygon, const std::string& name);
+    double integralFraction(const cv::Mat& integral, const cv::Rect& area,
+                            const cv::Rect& box) const;
+};
+
 #endif // ROI_H
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "roi_config.h"
+#include <stdexcept>
+
+ROIBox ROIGridConfig::toROIBox() const {
+    if (!hasROI()) {
+        throw std::runtime_error("ROI config has no ROI");
+    }
+    return ROIBox(roi);
+}
+
+ROISet ROIGridConfig::toROISet(const cv::Size& frameSize) const {
+    ROISet zones(frameSize);
+    if (hasROI()) {
+        zones.addRect(roi, "roi");
+    }
+    for (size_t i = 0; i < zonePolygons.size(); ++i) {
+        zones.addPolygon(zonePolygons[i], i < zoneNames.size() ? zoneNames[i] : "");
+    }
+    return zones;
+}
+
+cv::Point ROIGridConfig::cellCenter(int row, int column) const {
+    int cellWidth = roi.width / std::max(1, gridColumns);
+    int cellHeight = roi.height / std::max(1, gridRows);
+    return cv::Point(roi.x + column * cellWidth + cellWidth / 2,
+                     roi.y + row * cellHeight + cellHeight / 2);
+}
+
+ROIGridConfig loadROIConfig(const std::string& path, const cv::Size& frameSize) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot open ROI config: " + path);
+    }
+
+    ROIGridConfig config;
+    cv::FileNode roi = fs["roi"];
+    if (roi.isSeq() && roi.size() == 4) {
+        config.roi = cv::Rect((int)roi[0], (int)roi[1], (int)roi[2], (int)roi[3]);
+        if (!frameSize.empty()) {
+            config.roi &= cv::Rect(cv::Point(0, 0), frameSize);
+        }
+    }
+    if (!fs["grid_rows"].empty()) {
+        config.gridRows = std::max(1, (int)fs["grid_rows"]);
+    }
+    if (!fs["grid_columns"].empty()) {
+        config.gridColumns = std::max(1, (int)fs["grid_columns"]);
+    }
+
+    cv::FileNode zones = fs["zones"];
+    for (auto it = zones.begin(); it != zones.end(); ++it) {
+        cv::FileNode zone = *it;
+        cv::FileNode points = zone["points"];
+        std::vector<cv::Point> polygon;
+        for (size_t i = 0; i + 1 < points.size(); i += 2) {
+            polygon.emplace_back((int)points[(int)i], (int)points[(int)i + 1]);
+        }
+        if (polygon.size() < 3) {
+            throw std::runtime_error("ROI config zone needs at least 3 points: " + path);
+        }
+        config.zoneNames.push_back(zone["name"].empty() ? "" : (std::string)zone["name"]);
+        config.zonePolygons.push_back(polygon);
+    }
+    return config;
+}
+
+void saveROIConfig(const std::string& path, const ROIGridConfig& config) {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        throw std::runtime_error("Cannot write ROI config: " + path);
+    }
+
+    fs << "roi" << "[" << config.roi.x << config.roi.y
+       << config.roi.width << config.roi.height << "]";
+    fs << "grid_rows" << config.gridRows;
+    fs << "grid_columns" << config.gridColumns;
+    fs << "zones" << "[";
+    for (size_t i = 0; i < config.zonePolygons.size(); ++i) {
+        fs << "{";
+        fs << "name" << (i < config.zoneNames.size() ? config.zoneNames[i] : std::string());
+        fs << "points" << "[";
+        for (const auto& p : config.zonePolygons[i]) {
+            fs << p.x << p.y;
+        }
+        fs << "]";
+        fs << "}";
+    }
+    fs << "]";
+}
+
+SharedROIConfig::SharedROIConfig(const ROIGridConfig& initial)
+    : current(std::make_shared<const ROIGridConfig>(initial)) {}
+
+std::shared_ptr<const ROIGridConfig> SharedROIConfig::snapshot() const {
+    return std::atomic_load(&current);
+}
+
+void SharedROIConfig::publish(const ROIGridConfig& config) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    store(config);
+}
+
+void SharedROIConfig::store(const ROIGridConfig& config) {
+    std::atomic_store(&current, std::shared_ptr<const ROIGridConfig>(
+        std::make_shared<const ROIGridConfig>(config)));
+    versionCounter.fetch_add(1);
+}
@@ -0,0 +1,74 @@
+#ifndef ROI_CONFIG_H
+#define ROI_CONFIG_H
+
+#include "roi.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ROI, depth grid and extra detection zones, as saved to YAML/JSON:
+//   roi: [ x, y, width, height ]
+//   grid_rows: 2
+//   grid_columns: 10
+//   zones:
+//     - { name: "belt", points: [ x0, y0, x1, y1, x2, y2 ] }
+struct ROIGridConfig {
+    cv::Rect roi;
+    int gridRows = 2;
+    int gridColumns = 10;
+    std::vector<std::string> zoneNames;
+    std::vector<std::vector<cv::Point>> zonePolygons;
+
+    bool hasROI() const { return roi.width > 0 && roi.height > 0; }
+
+    // For the detectors: the ROI as an ROIBox, or the ROI plus all zones
+    ROIBox toROIBox() const;
+    ROISet toROISet(const cv::Size& frameSize) const;
+
+    // Center of grid cell (row, column) in frame coordinates
+    cv::Point cellCenter(int row, int column) const;
+};
+
+// Format follows the extension (.yml/.yaml/.json). A non-empty frameSize
+// clips the loaded ROI to the frame.
+ROIGridConfig loadROIConfig(const std::string& path, const cv::Size& frameSize = cv::Size());
+void saveROIConfig(const std::string& path, const ROIGridConfig& config);
+
+// Configuration shared between a UI thread (mouse/keyboard edits) and
+// processing loops. Readers take an immutable snapshot with an atomic
+// shared_ptr load and never wait for writers; writers copy, modify and
+// publish a new snapshot.
+class SharedROIConfig {
+public:
+    explicit SharedROIConfig(const ROIGridConfig& initial = ROIGridConfig());
+
+    // Current config; stays valid and unchanged while the caller holds it
+    std::shared_ptr<const ROIGridConfig> snapshot() const;
+
+    // Replace the whole config
+    void publish(const ROIGridConfig& config);
+
+    // Copy-modify-publish; concurrent writers are serialized
+    template <typename Modify>
+    void update(Modify modify) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        ROIGridConfig next = *snapshot();
+        modify(next);
+        store(next);
+    }
+
+    // Incremented on every publish, cheap change detection for readers
+    uint64_t version() const { return versionCounter.load(); }
+
+private:
+    std::shared_ptr<const ROIGridConfig> current;
+    std::mutex writeMutex;
+    std::atomic<uint64_t> versionCounter{0};
+
+    void store(const ROIGridConfig& config);
+};
+
+#endif // ROI_CONFIG_H
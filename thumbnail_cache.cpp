@@ -0,0 +1,149 @@
+#include "thumbnail_cache.h"
+#include "model_cache.h"
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kMagic[4] = {'T', 'H', 'B', '1'};
+const size_t kAlignment = 16;
+
+// Fixed-size record header, followed by rows * cols * channels pixel bytes
+// and padding up to kAlignment
+struct EntryHeader {
+    char magic[4];
+    int32_t rows;
+    int32_t cols;
+    int32_t channels;
+    uint64_t key;
+};
+
+size_t paddedSize(size_t size) {
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+int readFlags(int factor, bool gray) {
+    switch (factor) {
+        case 1: return gray ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+        case 2: return gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+        case 4: return gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+        case 8: return gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+    }
+    throw std::runtime_error("Thumbnail factor must be 1, 2, 4 or 8");
+}
+
+// Source identity (absolute path, size, mtime) plus the requested level
+uint64_t entryKey(const std::string& imagePath, int factor, bool gray) {
+    std::error_code error;
+    std::ostringstream id;
+    id << fs::absolute(imagePath).string() << "\t" << fs::file_size(imagePath, error) << "\t"
+       << (long long)fs::last_write_time(imagePath, error).time_since_epoch().count()
+       << "\t" << factor << (gray ? "g" : "c");
+    std::string stamp = id.str();
+    return hashBytes(stamp.data(), stamp.size());
+}
+
+} // namespace
+
+ThumbnailCache::ThumbnailCache(const std::string& cacheDir)
+    : packPath((fs::path(cacheDir) / "thumbnails.pack").string()) {
+    fs::create_directories(cacheDir);
+    loadPack();
+    appender.open(packPath, std::ios::binary | std::ios::app);
+    if (!appender.good()) {
+        throw std::runtime_error("Cannot write thumbnail cache: " + packPath);
+    }
+}
+
+void ThumbnailCache::loadPack() {
+    if (!fs::exists(packPath) || fs::file_size(packPath) == 0) {
+        return;
+    }
+    pack = std::make_unique<MappedFile>(packPath);
+
+    // Index every complete record; a torn record at the end (crash while
+    // appending) ends the scan and is cut off so new records stay aligned
+    size_t offset = 0;
+    while (offset + sizeof(EntryHeader) <= pack->size()) {
+        EntryHeader header;
+        std::memcpy(&header, pack->data() + offset, sizeof(header));
+        size_t pixels = (size_t)header.rows * header.cols * header.channels;
+        size_t recordSize = paddedSize(sizeof(EntryHeader) + pixels);
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.rows <= 0 || header.cols <= 0 ||
+            (header.channels != 1 && header.channels != 3) ||
+            offset + recordSize > pack->size()) {
+            break;
+        }
+        uchar* data = reinterpret_cast<uchar*>(const_cast<char*>(pack->data() + offset + sizeof(EntryHeader)));
+        index[header.key] = cv::Mat(header.rows, header.cols, CV_8UC(header.channels), data);
+        offset += recordSize;
+    }
+    if (offset < pack->size()) {
+        fs::resize_file(packPath, offset);
+    }
+}
+
+void ThumbnailCache::append(uint64_t key, const cv::Mat& thumbnail) {
+    EntryHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.rows = thumbnail.rows;
+    header.cols = thumbnail.cols;
+    header.channels = thumbnail.channels();
+    header.key = key;
+
+    size_t rowBytes = thumbnail.cols * thumbnail.elemSize();
+    size_t size = sizeof(header) + rowBytes * thumbnail.rows;
+    appender.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (int y = 0; y < thumbnail.rows; ++y) {
+        appender.write(reinterpret_cast<const char*>(thumbnail.ptr(y)), rowBytes);
+    }
+    static const char padding[kAlignment] = {0};
+    appender.write(padding, paddedSize(size) - size);
+    appender.flush();
+}
+
+cv::Mat ThumbnailCache::get(const std::string& imagePath, int factor, bool gray) {
+    int flags = readFlags(factor, gray);
+    uint64_t key = entryKey(imagePath, factor, gray);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            hitCount++;
+            return it->second;
+        }
+    }
+
+    // Decode outside the lock so parallel scans only serialize on the index
+    cv::Mat thumbnail = cv::imread(imagePath, flags);
+    if (thumbnail.empty()) {
+        return thumbnail;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    missCount++;
+    if (index.emplace(key, thumbnail).second) {
+        append(key, thumbnail);
+    }
+    return thumbnail;
+}
+
+size_t ThumbnailCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+size_t ThumbnailCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+size_t ThumbnailCache::entries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size();
+}
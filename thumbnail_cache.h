@@ -0,0 +1,50 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include "mapped_file.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Persistent cache of reduced-resolution images for dataset-wide scans
+// (dedup, statistics, review) that never need the full frame.
+//
+// Misses are decoded with cv::IMREAD_REDUCED_* so JPEGs are scaled in the
+// DCT domain (1/2, 1/4 or 1/8, gray or color) instead of being decoded at
+// full size and resized. Every thumbnail is appended uncompressed to
+// <cacheDir>/thumbnails.pack, keyed by the source path, size and mtime; a
+// modified image simply gets a new entry. On the next run the pack is
+// memory-mapped and hits are returned as views into the mapping, so a
+// warm scan reads only the thumbnail bytes and decodes nothing.
+class ThumbnailCache {
+public:
+    explicit ThumbnailCache(const std::string& cacheDir);
+
+    // Thumbnail of imagePath at 1/factor (factor 1, 2, 4 or 8). Gray is
+    // CV_8UC1, color CV_8UC3. Cached results are read-only views; clone()
+    // before modifying. Empty if the image cannot be read.
+    cv::Mat get(const std::string& imagePath, int factor, bool gray);
+
+    // Statistics since construction
+    size_t hits() const;
+    size_t misses() const;
+    size_t entries() const;
+
+private:
+    std::string packPath;
+    std::unique_ptr<MappedFile> pack;                 // Entries of earlier runs
+    std::unordered_map<uint64_t, cv::Mat> index;      // Entry key -> pixels
+    std::ofstream appender;
+    mutable std::mutex mutex;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+
+    void loadPack();
+    void append(uint64_t key, const cv::Mat& thumbnail);
+};
+
+#endif // THUMBNAIL_CACHE_H
@@ -0,0 +1,180 @@
+#include "ui_control.h"
+#include <algorithm>
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+// Signal handlers may only touch lock-free atomics
+std::atomic<int> signalQuit{0};
+std::atomic<int> signalCapture{0};
+
+void handleSignal(int signal) {
+    if (signal == SIGUSR1) {
+        signalCapture.fetch_add(1);
+    } else {
+        signalQuit.store(1);
+    }
+}
+
+// Commands read from stdin wait here until a channel polls. The reader
+// thread is detached, so it and its queue live for the whole process
+// instead of inside a (function local) channel.
+struct StdinCommands {
+    std::mutex mutex;
+    std::deque<int> pending;
+    std::once_flag started;
+};
+
+StdinCommands& stdinCommands() {
+    static StdinCommands* commands = new StdinCommands();    // Never destroyed
+    return *commands;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+int parseCommand(const std::string& line) {
+    std::string cmd = trim(line);
+    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+    if (cmd == "s" || cmd == "save" || cmd == "space" || cmd == "capture") return ' ';
+    if (cmd == "r" || cmd == "retry") return 'r';
+    if (cmd == "q" || cmd == "quit" || cmd == "exit") return 'q';
+    if (cmd.size() == 1) return cmd[0];
+    return -1;
+}
+
+void ControlChannel::push(int key) {
+    if (key == 'q' || key == 27) {
+        quit.store(true);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(key);
+}
+
+int ControlChannel::poll() {
+    if (signalQuit.exchange(0)) {
+        push('q');
+    }
+    for (int n = signalCapture.exchange(0); n > 0; --n) {
+        push(' ');
+    }
+    if (stdinEnabled) {
+        StdinCommands& commands = stdinCommands();
+        std::deque<int> keys;
+        {
+            std::lock_guard<std::mutex> lock(commands.mutex);
+            keys.swap(commands.pending);
+        }
+        for (int key : keys) {
+            push(key);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.empty()) {
+        return -1;
+    }
+    int key = pending.front();
+    pending.pop_front();
+    return key;
+}
+
+void ControlChannel::enableStdin() {
+    stdinEnabled = true;
+
+    // One reader per process. Detached: a thread blocked in getline cannot
+    // be joined on exit.
+    StdinCommands& commands = stdinCommands();
+    std::call_once(commands.started, [&commands] {
+        std::thread([&commands] {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                int key = parseCommand(line);
+                if (key >= 0) {
+                    std::lock_guard<std::mutex> lock(commands.mutex);
+                    commands.pending.push_back(key);
+                } else {
+                    std::cerr << "Unknown command: " << line << " (use save, retry, quit)\n";
+                }
+            }
+        }).detach();
+    });
+}
+
+void ControlChannel::enableSignals() {
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::signal(SIGUSR1, handleSignal);
+}
+
+bool displayAvailable() {
+#ifdef __linux__
+    const char* x11 = std::getenv("DISPLAY");
+    const char* wayland = std::getenv("WAYLAND_DISPLAY");
+    return (x11 && *x11) || (wayland && *wayland);
+#else
+    return true;
+#endif
+}
+
+DisplayThread::DisplayThread(const std::string& windowName, ControlChannel& control, double fps)
+    : windowName(windowName), control(control), fps(fps) {
+    worker = std::thread([this] { run(); });
+}
+
+DisplayThread::~DisplayThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    worker.join();
+}
+
+void DisplayThread::show(const cv::Mat& frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frame.copyTo(latest);
+        fresh = true;
+    }
+    ready.notify_one();
+}
+
+void DisplayThread::run() {
+    // All HighGUI calls stay on this thread
+    cv::namedWindow(windowName, cv::WINDOW_AUTOSIZE);
+    int delayMs = std::max(1, (int)(1000.0 / fps));
+    cv::Mat shown;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait_for(lock, std::chrono::milliseconds(delayMs),
+                           [this] { return fresh || stopping; });
+            if (stopping) break;
+            if (fresh) {
+                std::swap(shown, latest);
+                fresh = false;
+            }
+        }
+
+        if (!shown.empty()) {
+            cv::imshow(windowName, shown);
+        }
+        int key = cv::waitKey(delayMs);
+        if (key >= 0) {
+            control.push(key & 0xFF);
+        }
+    }
+
+    cv::destroyWindow(windowName);
+}
@@ -0,0 +1,79 @@
+#ifndef UI_CONTROL_H
+#define UI_CONTROL_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// UI-agnostic command input for the capture/annotation loops. Commands are
+// the keys the tools already use (' ' save, 'r' retry, 'q' quit, 27 Esc)
+// and can come from:
+//   - the display window's keyboard (DisplayThread)
+//   - stdin lines: "s"/"save", "r"/"retry", "q"/"quit", or any single key
+//   - signals: SIGINT/SIGTERM -> 'q', SIGUSR1 -> ' '
+// Processing loops call poll() instead of cv::waitKey(), so they never
+// block on HighGUI and run the same with or without a display.
+class ControlChannel {
+public:
+    ControlChannel() = default;
+    ControlChannel(const ControlChannel&) = delete;
+    ControlChannel& operator=(const ControlChannel&) = delete;
+
+    // Queue a command
+    void push(int key);
+
+    // Next command, or -1 when none is pending (never blocks)
+    int poll();
+
+    // Take commands from stdin, read by one detached thread per process
+    void enableStdin();
+
+    // Route SIGINT/SIGTERM/SIGUSR1 to this channel (one channel per process)
+    void enableSignals();
+
+    // A quit command was seen (also stays true after poll() returned it)
+    bool quitRequested() const { return quit.load(); }
+
+private:
+    std::mutex mutex;
+    std::deque<int> pending;
+    std::atomic<bool> quit{false};
+    bool stdinEnabled = false;
+};
+
+// Parse one stdin line into a command key (-1 if not recognized)
+int parseCommand(const std::string& line);
+
+// True when a window can be opened (DISPLAY/WAYLAND_DISPLAY set on Linux)
+bool displayAvailable();
+
+// Shows the latest frame in a window from its own thread, at its own rate.
+// show() only swaps the frame into a slot, so the processing loop never
+// waits for imshow/waitKey; frames that arrive faster than the display
+// refreshes are dropped. Keys pressed in the window go to the channel.
+class DisplayThread {
+public:
+    DisplayThread(const std::string& windowName, ControlChannel& control, double fps = 30.0);
+    ~DisplayThread();
+
+    void show(const cv::Mat& frame);
+
+private:
+    std::string windowName;
+    ControlChannel& control;
+    double fps;
+    std::mutex mutex;
+    std::condition_variable ready;
+    cv::Mat latest;
+    bool fresh = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif // UI_CONTROL_H
@@ -0,0 +1,110 @@
+#include "yolo_detection.h"
+#include "instrumentation.h"
+#include <opencv2/dnn.hpp>
+#include <fstream>
+
+std::vector<std::string> loadClassNames(const std::string& filename) {
+    std::vector<std::string> classNames;
+    std::ifstream file(filename);
+    if (!file.good()) {
+        throw std::runtime_error("Cannot open class names file: " + filename);
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        classNames.push_back(line);
+    }
+    return classNames;
+}
+
+std::vector<Detection> decodeYoloOutputs(const std::vector<cv::Mat>& outs,
+                                         const cv::Size& frameSize,
+                                         float minConfidence,
+                                         const std::vector<std::string>& classNames) {
+    ScopedTimer timer(Stage::Decode);
+    std::vector<Detection> detections;
+
+    for (const auto& out : outs) {
+        for (int i = 0; i < out.rows; ++i) {
+            const float* data = out.ptr<float>(i);
+
+            // Best and second best class scores in one pass
+            const float* scores = data + 5;
+            int bestClass = 0;
+            float confidence = 0.0f;
+            float runnerUp = 0.0f;
+            for (int c = 0; c < out.cols - 5; ++c) {
+                if (scores[c] > confidence) {
+                    runnerUp = confidence;
+                    confidence = scores[c];
+                    bestClass = c;
+                } else if (scores[c] > runnerUp) {
+                    runnerUp = scores[c];
+                }
+            }
+
+            if (confidence > minConfidence) {
+                int centerX = (int)(data[0] * frameSize.width);
+                int centerY = (int)(data[1] * frameSize.height);
+                int width = (int)(data[2] * frameSize.width);
+                int height = (int)(data[3] * frameSize.height);
+
+                Detection det;
+                det.box = cv::Rect(centerX - width/2, centerY - height/2, width, height);
+                det.confidence = confidence;
+                det.runner_up = runnerUp;
+                det.class_id = bestClass;
+                det.class_name = bestClass < (int)classNames.size() ?
+                                 classNames[bestClass] : std::to_string(bestClass);
+                detections.push_back(det);
+            }
+        }
+    }
+
+    return detections;
+}
+
+std::vector<cv::Mat> sliceBatchOutputs(const std::vector<cv::Mat>& outs,
+                                       int index, int batchSize) {
+    std::vector<cv::Mat> slices;
+    slices.reserve(outs.size());
+    for (const auto& out : outs) {
+        if (out.dims == 3) {
+            slices.push_back(cv::Mat(out.size[1], out.size[2], CV_32F,
+                                     (void*)out.ptr<float>(index)));
+        } else {
+            int rows = out.rows / batchSize;
+            slices.push_back(out.rowRange(index * rows, (index + 1) * rows));
+        }
+    }
+    return slices;
+}
+
+std::vector<Detection> suppressDetections(const std::vector<Detection>& detections,
+                                          float confThreshold,
+                                          float nmsThreshold) {
+    ScopedTimer timer(Stage::Nms);
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+    std::vector<int> classIds;
+    boxes.reserve(detections.size());
+    confidences.reserve(detections.size());
+    classIds.reserve(detections.size());
+    for (const auto& det : detections) {
+        boxes.push_back(det.box);
+        confidences.push_back(det.confidence);
+        classIds.push_back(det.class_id);
+    }
+
+    std::vector<int> indices;
+    if (!boxes.empty()) {
+        cv::dnn::NMSBoxesBatched(boxes, confidences, classIds,
+                                 confThreshold, nmsThreshold, indices);
+    }
+
+    std::vector<Detection> kept;
+    kept.reserve(indices.size());
+    for (int idx : indices) {
+        kept.push_back(detections[idx]);
+    }
+    return kept;
+}
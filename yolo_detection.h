@@ -0,0 +1,47 @@
+#ifndef YOLO_DETECTION_H
+#define YOLO_DETECTION_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// One detected object in frame pixel coordinates
+struct Detection {
+    cv::Rect box;
+    float confidence;
+    float runner_up;    // Score of the second best class
+    int class_id;
+    std::string class_name;
+};
+
+// Load class names (one per line, e.g. coco.names / obj.names)
+std::vector<std::string> loadClassNames(const std::string& filename);
+
+// Decode raw YOLO output rows into detections for a frame of frameSize.
+// Keeps rows whose best class score is above minConfidence; no NMS.
+std::vector<Detection> decodeYoloOutputs(const std::vector<cv::Mat>& outs,
+                                         const cv::Size& frameSize,
+                                         float minConfidence,
+                                         const std::vector<std::string>& classNames);
+
+// Outputs of image `index` from a forward pass over a batch of batchSize.
+// Handles both 3D [batch, rows, cols] heads and 2D heads with the batch
+// stacked along the rows; the returned Mats are views, not copies.
+std::vector<cv::Mat> sliceBatchOutputs(const std::vector<cv::Mat>& outs,
+                                       int index, int batchSize);
+
+// Class-aware non maximum suppression
+std::vector<Detection> suppressDetections(const std::vector<Detection>& detections,
+                                          float confThreshold,
+                                          float nmsThreshold);
+
+// Intersection over union of two boxes, in pixels (cv::Rect) or in
+// normalized coordinates (cv::Rect2f)
+template <typename T>
+float boxIoU(const cv::Rect_<T>& a, const cv::Rect_<T>& b) {
+    float inter = (float)(a & b).area();
+    float uni = (float)a.area() + (float)b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+#endif // YOLO_DETECTION_H
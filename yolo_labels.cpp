@@ -0,0 +1,170 @@
+#include "yolo_labels.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+YoloLabel toYoloLabel(const Detection& det, const cv::Size& frameSize) {
+    // Detections may extend past the frame edges
+    cv::Rect box = det.box & cv::Rect(cv::Point(0, 0), frameSize);
+    YoloLabel label;
+    label.class_id = det.class_id;
+    label.x_center = (box.x + box.width/2.0f) / frameSize.width;
+    label.y_center = (box.y + box.height/2.0f) / frameSize.height;
+    label.width = (float)box.width / frameSize.width;
+    label.height = (float)box.height / frameSize.height;
+    return label;
+}
+
+cv::Rect2f labelRect(const YoloLabel& label) {
+    return cv::Rect2f(label.x_center - label.width / 2, label.y_center - label.height / 2,
+                      label.width, label.height);
+}
+
+void writeYoloLabels(const std::string& path,
+                     const std::vector<Detection>& detections,
+                     const cv::Size& frameSize) {
+    std::vector<YoloLabel> labels;
+    labels.reserve(detections.size());
+    for (const auto& det : detections) {
+        YoloLabel label = toYoloLabel(det, frameSize);
+        if (label.width > 0 && label.height > 0) {     // Entirely outside the frame
+            labels.push_back(label);
+        }
+    }
+    writeYoloLabels(path, labels);
+}
+
+void writeYoloLabels(const std::string& path, const std::vector<YoloLabel>& labels) {
+    std::string text;
+    text.reserve(labels.size() * 48);
+    for (const auto& label : labels) {
+        appendYoloLabel(text, label);
+    }
+
+    std::ofstream label_file(path, std::ios::binary);
+    if (!label_file.write(text.data(), text.size())) {
+        throw std::runtime_error("Cannot write label file: " + path);
+    }
+}
+
+void appendYoloLabel(std::string& out, const YoloLabel& label) {
+    char line[128];
+    char* p = line;
+    char* end = line + sizeof(line);
+    p = std::to_chars(p, end, label.class_id).ptr;
+    for (float value : {label.x_center, label.y_center, label.width, label.height}) {
+        *p++ = ' ';
+        p = std::to_chars(p, end, value).ptr;
+    }
+    *p++ = '\n';
+    out.append(line, p - line);
+}
+
+namespace {
+
+// Parses "class v0 v1 ... v(count-1)" lines; blank lines are skipped
+template <typename F>
+void parseLabelLines(const char* begin, const char* end, int count, F&& onLine) {
+    int lineNumber = 0;
+    const char* p = begin;
+    while (p < end) {
+        const char* lineEnd = std::find(p, end, '\n');
+        lineNumber++;
+
+        // Fields are separated by spaces/tabs; '\r' of CRLF files is trailing space
+        auto skipSpace = [&](const char* q) {
+            while (q < lineEnd && (*q == ' ' || *q == '\t' || *q == '\r')) ++q;
+            return q;
+        };
+        const char* q = skipSpace(p);
+        if (q < lineEnd) {
+            int classId = 0;
+            float values[8];
+            auto result = std::from_chars(q, lineEnd, classId);
+            bool ok = result.ec == std::errc();
+            q = result.ptr;
+            for (int i = 0; i < count && ok; ++i) {
+                q = skipSpace(q);
+                result = std::from_chars(q, lineEnd, values[i]);
+                ok = result.ec == std::errc();
+                q = result.ptr;
+            }
+            if (!ok || skipSpace(q) != lineEnd) {
+                throw std::runtime_error("Malformed YOLO label at line " + std::to_string(lineNumber));
+            }
+            onLine(classId, values);
+        }
+        p = lineEnd + 1;
+    }
+}
+
+template <typename T, typename Parse>
+std::vector<T> readLabelFile(const std::string& path, Parse&& parse) {
+    std::vector<T> labels;
+    if (!fs::exists(path)) {
+        return labels;
+    }
+    MappedFile file(path);
+    try {
+        parse(file.data(), file.data() + file.size(), labels);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    return labels;
+}
+
+} // namespace
+
+void parseYoloLabels(const char* begin, const char* end, std::vector<YoloLabel>& labels) {
+    parseLabelLines(begin, end, 4, [&](int classId, const float* v) {
+        labels.push_back({classId, v[0], v[1], v[2], v[3]});
+    });
+}
+
+std::vector<YoloLabel> readYoloLabels(const std::string& path) {
+    return readLabelFile<YoloLabel>(path, parseYoloLabels);
+}
+
+void writeScoredLabels(const std::string& path, const std::vector<ScoredLabel>& labels) {
+    std::string text;
+    text.reserve(labels.size() * 56);
+    for (const auto& scored : labels) {
+        appendYoloLabel(text, scored.label);
+        char confidence[32];
+        text.back() = ' ';      // Confidence goes before the line break
+        text.append(confidence, std::to_chars(confidence, confidence + sizeof(confidence),
+                                              scored.confidence).ptr);
+        text += '\n';
+    }
+
+    std::ofstream label_file(path, std::ios::binary);
+    if (!label_file.write(text.data(), text.size())) {
+        throw std::runtime_error("Cannot write label file: " + path);
+    }
+}
+
+void parseScoredLabels(const char* begin, const char* end, std::vector<ScoredLabel>& labels) {
+    parseLabelLines(begin, end, 5, [&](int classId, const float* v) {
+        labels.push_back({{classId, v[0], v[1], v[2], v[3]}, v[4]});
+    });
+}
+
+std::vector<ScoredLabel> readScoredLabels(const std::string& path) {
+    return readLabelFile<ScoredLabel>(path, parseScoredLabels);
+}
+
+std::string labelPathForImage(const std::string& imagePath) {
+    fs::path path(imagePath);
+    std::string dir = path.parent_path().string();
+
+    size_t pos = dir.rfind("/images");
+    if (pos != std::string::npos &&
+        (pos + 7 == dir.size() || dir[pos + 7] == '/')) {
+        dir.replace(pos, 7, "/labels");
+    }
+    return (fs::path(dir) / path.stem()).string() + ".txt";
+}
@@ -0,0 +1,56 @@
+#ifndef YOLO_LABELS_H
+#define YOLO_LABELS_H
+
+#include "yolo_detection.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// One line of a Darknet/YOLO label file, coordinates normalized to [0,1]
+struct YoloLabel {
+    int class_id;
+    float x_center;
+    float y_center;
+    float width;
+    float height;
+};
+
+// Box clipped to the frame, so coordinates stay within [0,1]
+YoloLabel toYoloLabel(const Detection& det, const cv::Size& frameSize);
+
+// Normalized box of a label (top-left corner, size)
+cv::Rect2f labelRect(const YoloLabel& label);
+
+// Write detections as a YOLO label file ("class x_center y_center w h");
+// boxes entirely outside the frame are skipped
+void writeYoloLabels(const std::string& path,
+                     const std::vector<Detection>& detections,
+                     const cv::Size& frameSize);
+void writeYoloLabels(const std::string& path, const std::vector<YoloLabel>& labels);
+
+// One label line; floats use the shortest text that reads back to the
+// same value (std::to_chars), not the 6 digit ostream default
+void appendYoloLabel(std::string& out, const YoloLabel& label);
+
+// Parse label lines with std::from_chars (no locale, no allocation per
+// value). Blank lines are skipped; malformed lines throw with the line
+// number. A missing file reads as no labels.
+void parseYoloLabels(const char* begin, const char* end, std::vector<YoloLabel>& labels);
+std::vector<YoloLabel> readYoloLabels(const std::string& path);
+
+// Detector output in label form, one "class x_center y_center w h confidence"
+// line per box (cached predictions for evaluation)
+struct ScoredLabel {
+    YoloLabel label;
+    float confidence;
+};
+
+void writeScoredLabels(const std::string& path, const std::vector<ScoredLabel>& labels);
+void parseScoredLabels(const char* begin, const char* end, std::vector<ScoredLabel>& labels);
+std::vector<ScoredLabel> readScoredLabels(const std::string& path);
+
+// Darknet convention: .../images/<subset>/name.jpg -> .../labels/<subset>/name.txt,
+// otherwise the label sits next to the image
+std::string labelPathForImage(const std::string& imagePath);
+
+#endif // YOLO_LABELS_H